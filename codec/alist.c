@@ -0,0 +1,704 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/alist.h"
+
+#include "codec/alist_kernels.h"
+#include "codec/dispatch.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// The command semantics follow the libultra audio microcode. Data memory holds
+// big-endian samples, like the RSP, so buffers can be copied to and from main
+// memory without conversion.
+
+enum {
+    // Offset of the audio buffers in data memory. Buffer addresses in
+    // commands are relative to this.
+    kAlistBufferBase = 0x5c0,
+
+    // Size of the state saved in main memory by each command, in bytes.
+    kAlistADPCMStateSize = 32,
+    kAlistResampleStateSize = 10,
+    kAlistEnvMixerStateSize = 80,
+    kAlistPoleFStateSize = 8,
+
+    // Number of ADPCM frames decoded at a time.
+    kAlistADPCMChunkFrames = 16,
+
+    // Largest scaling factor that the microcode decodes correctly. Larger
+    // factors give the same result as this one.
+    kAlistMaxScaling = 12,
+
+    // Number of samples mixed at a time by ENVMIXER.
+    kAlistEnvMixerChunk = 64,
+};
+
+const int16_t kVADPCMAlistResampleTable[kVADPCMAlistResampleTableSize] = {
+    0, 32767, 0, 0, -248, 32748, 272, -4,
+    -480, 32690, 574, -16, -698, 32593, 907, -34,
+    -900, 32460, 1268, -60, -1088, 32291, 1657, -92,
+    -1262, 32088, 2072, -130, -1421, 31852, 2512, -175,
+    -1568, 31584, 2976, -224, -1702, 31285, 3463, -278,
+    -1822, 30956, 3972, -338, -1931, 30598, 4502, -401,
+    -2028, 30212, 5052, -468, -2113, 29800, 5620, -539,
+    -2188, 29362, 6206, -612, -2251, 28901, 6807, -689,
+    -2304, 28416, 7424, -768, -2347, 27909, 8055, -849,
+    -2380, 27382, 8698, -932, -2405, 26834, 9354, -1015,
+    -2420, 26268, 10020, -1100, -2427, 25684, 10696, -1185,
+    -2426, 25084, 11380, -1270, -2416, 24469, 12071, -1356,
+    -2400, 23840, 12768, -1440, -2377, 23198, 13470, -1523,
+    -2346, 22544, 14176, -1606, -2310, 21879, 14885, -1686,
+    -2268, 21204, 15596, -1764, -2220, 20521, 16307, -1840,
+    -2168, 19830, 17018, -1912, -2110, 19134, 17726, -1982,
+    -2048, 18432, 18432, -2048, -1982, 17726, 19134, -2110,
+    -1912, 17018, 19830, -2168, -1840, 16307, 20521, -2220,
+    -1764, 15596, 21204, -2268, -1686, 14885, 21879, -2310,
+    -1606, 14176, 22544, -2346, -1523, 13470, 23198, -2377,
+    -1440, 12768, 23840, -2400, -1356, 12071, 24469, -2416,
+    -1270, 11380, 25084, -2426, -1185, 10696, 25684, -2427,
+    -1100, 10020, 26268, -2420, -1015, 9354, 26834, -2405,
+    -932, 8698, 27382, -2380, -849, 8055, 27909, -2347,
+    -768, 7424, 28416, -2304, -689, 6807, 28901, -2251,
+    -612, 6206, 29362, -2188, -539, 5620, 29800, -2113,
+    -468, 5052, 30212, -2028, -401, 4502, 30598, -1931,
+    -338, 3972, 30956, -1822, -278, 3463, 31285, -1702,
+    -224, 2976, 31584, -1568, -175, 2512, 31852, -1421,
+    -130, 2072, 32088, -1262, -92, 1657, 32291, -1088,
+    -60, 1268, 32460, -900, -34, 907, 32593, -698,
+    -16, 574, 32690, -480, -4, 272, 32748, -248,
+};
+
+static int alist_load16(const uint8_t *ptr) {
+    return (int16_t)(uint16_t)((ptr[0] << 8) | ptr[1]);
+}
+
+static void alist_store16(uint8_t *ptr, int value) {
+    ptr[0] = (uint8_t)(value >> 8);
+    ptr[1] = (uint8_t)value;
+}
+
+static int32_t alist_load32(const uint8_t *ptr) {
+    return (int32_t)(((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) |
+                     ((uint32_t)ptr[2] << 8) | ptr[3]);
+}
+
+static void alist_store32(uint8_t *ptr, int32_t value) {
+    uint32_t x = (uint32_t)value;
+    ptr[0] = (uint8_t)(x >> 24);
+    ptr[1] = (uint8_t)(x >> 16);
+    ptr[2] = (uint8_t)(x >> 8);
+    ptr[3] = (uint8_t)x;
+}
+
+static int alist_clamp16(int32_t x) {
+    return x < -0x8000 ? -0x8000 : x > 0x7fff ? 0x7fff : x;
+}
+
+// Multiply two signed 1.15 fixed-point numbers, with rounding.
+static int alist_mulf(int x, int y) {
+    return (x * y + 0x4000) >> 15;
+}
+
+// Add a value to a sample in memory, with saturation.
+static void alist_sadd(uint8_t *ptr, int value) {
+    alist_store16(ptr, alist_clamp16(alist_load16(ptr) + value));
+}
+
+void vadpcm_alist_mix_scalar(size_t count, uint8_t *out, const uint8_t *in,
+                             int gain) {
+    for (size_t i = 0; i < count; i++) {
+        alist_sadd(out + i * 2, alist_mulf(alist_load16(in + i * 2), gain));
+    }
+}
+
+void vadpcm_alist_mix_gains_scalar(size_t count, uint8_t *out,
+                                   const uint8_t *in,
+                                   const int16_t *restrict gains) {
+    for (size_t i = 0; i < count; i++) {
+        alist_sadd(out + i * 2,
+                   alist_mulf(alist_load16(in + i * 2), gains[i]));
+    }
+}
+
+void vadpcm_alist_interleave_scalar(size_t count, uint8_t *out,
+                                    const uint8_t *left, const uint8_t *right) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t frame[4] = {left[i * 2], left[i * 2 + 1], right[i * 2],
+                            right[i * 2 + 1]};
+        memcpy(out + i * 4, frame, sizeof(frame));
+    }
+}
+
+// Return true if two ranges of data memory overlap.
+static bool alist_overlap(const uint8_t *x, uint32_t x_size, const uint8_t *y,
+                          uint32_t y_size) {
+    return x < y + y_size && y < x + x_size;
+}
+
+static uint32_t alist_align(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Return the data memory address of a buffer in a command.
+static uint16_t alist_buffer(uint32_t offset) {
+    return (uint16_t)(offset + kAlistBufferBase);
+}
+
+// Return a pointer to data memory, or NULL if the range is out of bounds.
+static uint8_t *alist_dmem(struct vadpcm_alist *restrict alist,
+                           uint32_t address, uint32_t size) {
+    if (address > kVADPCMAlistDMEMSize ||
+        size > kVADPCMAlistDMEMSize - address) {
+        return NULL;
+    }
+    return alist->dmem + address;
+}
+
+// Resolve a segmented address to a physical address.
+static uint32_t alist_address(const struct vadpcm_alist *restrict alist,
+                              uint32_t address) {
+    uint32_t base =
+        alist->segments[(address >> 24) & (kVADPCMAlistSegmentCount - 1)];
+    return (base + (address & 0xffffff)) & 0xffffff;
+}
+
+// Return a pointer to main memory, or NULL if the range is out of bounds.
+static uint8_t *alist_rdram(struct vadpcm_alist *restrict alist,
+                            uint32_t address, size_t size) {
+    if (address > alist->rdram_size || size > alist->rdram_size - address) {
+        return NULL;
+    }
+    return alist->rdram + address;
+}
+
+static vadpcm_error alist_adpcm(struct vadpcm_alist *restrict alist,
+                                uint32_t w1, uint32_t w2) {
+    int flags = (w1 >> 16) & 0xff;
+    uint32_t count = alist_align(alist->count, 32);
+    size_t frame_count = count / 32;
+    uint8_t *state =
+        alist_rdram(alist, alist_address(alist, w2), kAlistADPCMStateSize);
+    const uint8_t *src = alist_dmem(
+        alist, alist->in, (uint32_t)frame_count * kVADPCMFrameByteSize);
+    uint8_t *dest = alist_dmem(alist, alist->out, kAlistADPCMStateSize + count);
+    if (state == NULL || src == NULL || dest == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+
+    // The output starts with the last frame of the previous output.
+    if ((flags & kVADPCMAlistInit) != 0) {
+        memset(dest, 0, kAlistADPCMStateSize);
+    } else {
+        const uint8_t *last = state;
+        if ((flags & kVADPCMAlistLoop) != 0) {
+            last = alist_rdram(alist, alist->loop, kAlistADPCMStateSize);
+            if (last == NULL) {
+                return kVADPCMErrInvalidData;
+            }
+        }
+        memcpy(dest, last, kAlistADPCMStateSize);
+    }
+    struct vadpcm_vector vstate;
+    for (int i = 0; i < kVADPCMVectorSampleCount; i++) {
+        vstate.v[i] = (int16_t)alist_load16(dest + 16 + 2 * i);
+    }
+
+    // The microcode always has room for every predictor. Predictors which
+    // were not loaded keep their old coefficients, or zero.
+    if (!alist->decoder_ready) {
+        vadpcm_decoder_prepare(&alist->decoder, kVADPCMAlistMaxPredictorCount,
+                               2, alist->codebook);
+        alist->decoder_ready = true;
+    }
+
+    // The input is copied, because the output may overwrite it.
+    uint8_t input[kAlistADPCMChunkFrames * kVADPCMFrameByteSize];
+    int16_t pcm[kAlistADPCMChunkFrames * kVADPCMFrameSampleCount];
+    uint8_t *out = dest + kAlistADPCMStateSize;
+    bool aligned = (alist->out & 1) == 0;
+    for (size_t pos = 0; pos < frame_count;) {
+        size_t n = frame_count - pos;
+        if (n > kAlistADPCMChunkFrames) {
+            n = kAlistADPCMChunkFrames;
+        }
+        memcpy(input, src + pos * kVADPCMFrameByteSize,
+               n * kVADPCMFrameByteSize);
+        for (size_t i = 0; i < n; i++) {
+            uint8_t *control = &input[i * kVADPCMFrameByteSize];
+            if ((*control >> 4) > kAlistMaxScaling) {
+                *control = (uint8_t)((kAlistMaxScaling << 4) | (*control & 15));
+            }
+        }
+        uint8_t *chunk = out + pos * kVADPCMFrameSampleCount * 2;
+        vadpcm_decoder_decode_be(&alist->decoder, &vstate, n,
+                                 aligned ? (void *)chunk : (void *)pcm, input);
+        if (!aligned) {
+            memcpy(chunk, pcm, n * kVADPCMFrameSampleCount * 2);
+        }
+        pos += n;
+    }
+
+    memcpy(state, dest + count, kAlistADPCMStateSize);
+    return kVADPCMErrNone;
+}
+
+static vadpcm_error alist_clearbuff(struct vadpcm_alist *restrict alist,
+                                    uint32_t w1, uint32_t w2) {
+    uint32_t count = w2 & 0xfff;
+    if (count == 0) {
+        return kVADPCMErrNone;
+    }
+    uint32_t size = alist_align(count, 16);
+    uint8_t *ptr = alist_dmem(alist, alist_buffer(w1 & 0xffff), size);
+    if (ptr == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    memset(ptr, 0, size);
+    return kVADPCMErrNone;
+}
+
+// A volume ramp, in signed 16.16 fixed-point.
+struct alist_ramp {
+    int32_t value;
+    int32_t target;
+    int32_t step;
+};
+
+// Advance a volume ramp by one sample and return the new volume.
+static int alist_ramp_step(struct alist_ramp *restrict ramp) {
+    ramp->value = (int32_t)((uint32_t)ramp->value + (uint32_t)ramp->step);
+    bool reached = ramp->step <= 0 ? ramp->value <= ramp->target
+                                   : ramp->value >= ramp->target;
+    if (reached) {
+        ramp->value = ramp->target;
+        ramp->step = 0;
+    }
+    return (int16_t)(ramp->value >> 16);
+}
+
+static vadpcm_error alist_envmixer(struct vadpcm_alist *restrict alist,
+                                   uint32_t w1, uint32_t w2) {
+    int flags = (w1 >> 16) & 0xff;
+    int buffer_count = (flags & kVADPCMAlistAux) != 0 ? 4 : 2;
+    uint32_t size = alist_align(alist->count, 16);
+    uint8_t *state =
+        alist_rdram(alist, alist_address(alist, w2), kAlistEnvMixerStateSize);
+    const uint8_t *in = alist_dmem(alist, alist->in, size);
+    const uint16_t addresses[4] = {
+        alist->out,
+        alist->dry_right,
+        alist->wet_left,
+        alist->wet_right,
+    };
+    uint8_t *buffers[4];
+    for (int i = 0; i < buffer_count; i++) {
+        buffers[i] = alist_dmem(alist, addresses[i], size);
+        if (buffers[i] == NULL) {
+            return kVADPCMErrInvalidData;
+        }
+    }
+    if (state == NULL || in == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+
+    int dry, wet;
+    struct alist_ramp ramp[2];
+    int32_t rate[2], sequence[2];
+    if ((flags & kVADPCMAlistInit) != 0) {
+        dry = alist->dry;
+        wet = alist->wet;
+        for (int i = 0; i < 2; i++) {
+            ramp[i].value = (int32_t)((uint32_t)alist->volume[i] << 16);
+            ramp[i].target = (int32_t)((uint32_t)alist->target[i] << 16);
+            rate[i] = alist->rate[i];
+            sequence[i] = (int32_t)((uint32_t)alist->volume[i] *
+                                    (uint32_t)alist->rate[i]);
+        }
+    } else {
+        wet = alist_load16(state);
+        dry = alist_load16(state + 4);
+        for (int i = 0; i < 2; i++) {
+            ramp[i].target = alist_load32(state + 8 + 4 * i);
+            rate[i] = alist_load32(state + 16 + 4 * i);
+            sequence[i] = alist_load32(state + 24 + 4 * i);
+            ramp[i].value = alist_load32(state + 32 + 4 * i);
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        ramp[i].step =
+            (int32_t)((uint32_t)ramp[i].target - (uint32_t)ramp[i].value);
+    }
+
+    // The gains are calculated for a chunk of samples, and then each buffer is
+    // mixed. The input is copied first, in case it is also an output. If the
+    // buffers partially overlap, the chunks are one sample long, so each
+    // sample is added to every buffer before the next sample is read.
+    uint32_t chunk = kAlistEnvMixerChunk;
+    for (int i = 0; i < buffer_count; i++) {
+        if (in != buffers[i] && alist_overlap(in, size, buffers[i], size)) {
+            chunk = 1;
+        }
+        for (int j = 0; j < i; j++) {
+            if (buffers[j] != buffers[i] &&
+                alist_overlap(buffers[j], size, buffers[i], size)) {
+                chunk = 1;
+            }
+        }
+    }
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    uint32_t count = size / 2;
+    for (uint32_t pos = 0; pos < count; pos += chunk) {
+        uint32_t n = count - pos < chunk ? count - pos : chunk;
+        int16_t gains[4][kAlistEnvMixerChunk];
+        uint8_t samples[kAlistEnvMixerChunk * 2];
+        for (uint32_t j = 0; j < n; j++) {
+            // The ramp is recalculated every 8 samples.
+            if ((pos + j) % 8 == 0) {
+                for (int i = 0; i < 2; i++) {
+                    if (ramp[i].step != 0) {
+                        sequence[i] = (int32_t)(
+                            ((int64_t)sequence[i] * rate[i]) >> 16);
+                        ramp[i].step = (int32_t)((uint32_t)sequence[i] -
+                                                 (uint32_t)ramp[i].value) >>
+                                       3;
+                    }
+                }
+            }
+            int left = alist_ramp_step(&ramp[0]);
+            int right = alist_ramp_step(&ramp[1]);
+            gains[0][j] = (int16_t)alist_clamp16((left * dry + 0x4000) >> 15);
+            gains[1][j] = (int16_t)alist_clamp16((right * dry + 0x4000) >> 15);
+            gains[2][j] = (int16_t)alist_clamp16((left * wet + 0x4000) >> 15);
+            gains[3][j] = (int16_t)alist_clamp16((right * wet + 0x4000) >> 15);
+        }
+        memcpy(samples, in + pos * 2, n * 2);
+        for (int i = 0; i < buffer_count; i++) {
+            kernels->alist_mix_gains(n, buffers[i] + pos * 2, samples,
+                                     gains[i]);
+        }
+    }
+
+    memset(state, 0, kAlistEnvMixerStateSize);
+    alist_store16(state, wet);
+    alist_store16(state + 4, dry);
+    for (int i = 0; i < 2; i++) {
+        alist_store32(state + 8 + 4 * i, ramp[i].target);
+        alist_store32(state + 16 + 4 * i, rate[i]);
+        alist_store32(state + 24 + 4 * i, sequence[i]);
+        alist_store32(state + 32 + 4 * i, ramp[i].value);
+    }
+    return kVADPCMErrNone;
+}
+
+// Copy between data memory and main memory.
+static vadpcm_error alist_transfer(struct vadpcm_alist *restrict alist,
+                                   uint32_t w2, uint16_t address, bool save) {
+    if (alist->count == 0) {
+        return kVADPCMErrNone;
+    }
+    uint32_t size = alist_align(alist->count, 8);
+    uint8_t *dmem = alist_dmem(alist, address & ~3u, size);
+    uint8_t *rdram = alist_rdram(alist, alist_address(alist, w2) & ~7u, size);
+    if (dmem == NULL || rdram == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    if (save) {
+        memcpy(rdram, dmem, size);
+    } else {
+        memcpy(dmem, rdram, size);
+    }
+    return kVADPCMErrNone;
+}
+
+static vadpcm_error alist_resample(struct vadpcm_alist *restrict alist,
+                                   uint32_t w1, uint32_t w2) {
+    int flags = (w1 >> 16) & 0xff;
+    uint32_t pitch = (w1 & 0xffff) << 1;
+    uint32_t count = alist_align(alist->count, 16) / 2;
+    uint8_t *state =
+        alist_rdram(alist, alist_address(alist, w2), kAlistResampleStateSize);
+    if (state == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    uint32_t accumulator =
+        (flags & kVADPCMAlistInit) != 0 ? 0 : (uint16_t)alist_load16(state + 8);
+
+    // The input is preceded by four samples of history. The number of input
+    // samples consumed is known in advance, so the whole input can be checked
+    // before any output is written.
+    uint32_t advance =
+        (uint32_t)(((uint64_t)pitch * count + accumulator) >> 16);
+    if (advance > kVADPCMAlistDMEMSize) {
+        return kVADPCMErrInvalidData;
+    }
+    uint8_t *in = alist_dmem(alist, (uint32_t)alist->in - 8, (advance + 4) * 2);
+    uint8_t *out = alist_dmem(alist, alist->out, count * 2);
+    if (in == NULL || out == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    if ((flags & kVADPCMAlistInit) != 0) {
+        memset(in, 0, 8);
+    } else {
+        memcpy(in, state, 8);
+    }
+
+    const int16_t *table = alist->resample_table;
+    const uint8_t *ptr = in;
+    for (uint32_t i = 0; i < count; i++) {
+        const int16_t *taps = table + ((accumulator >> 10) & 63) * 4;
+        // The products are summed at full precision, like the accumulator.
+        int64_t sum = 0;
+        for (int k = 0; k < 4; k++) {
+            sum += alist_load16(ptr + 2 * k) * taps[k];
+        }
+        alist_store16(out + 2 * i, alist_clamp16((int32_t)(sum >> 15)));
+        accumulator += pitch;
+        ptr += (accumulator >> 16) * 2;
+        accumulator &= 0xffff;
+    }
+
+    memcpy(state, ptr, 8);
+    alist_store16(state + 8, (int)accumulator);
+    return kVADPCMErrNone;
+}
+
+static void alist_setbuff(struct vadpcm_alist *restrict alist, uint32_t w1,
+                          uint32_t w2) {
+    int flags = (w1 >> 16) & 0xff;
+    if ((flags & kVADPCMAlistAux) != 0) {
+        alist->dry_right = alist_buffer(w1 & 0xffff);
+        alist->wet_left = alist_buffer(w2 >> 16);
+        alist->wet_right = alist_buffer(w2 & 0xffff);
+    } else {
+        alist->in = alist_buffer(w1 & 0xffff);
+        alist->out = alist_buffer(w2 >> 16);
+        alist->count = (uint16_t)w2;
+    }
+}
+
+static void alist_setvol(struct vadpcm_alist *restrict alist, uint32_t w1,
+                         uint32_t w2) {
+    int flags = (w1 >> 16) & 0xff;
+    if ((flags & kVADPCMAlistAux) != 0) {
+        alist->dry = (int16_t)w1;
+        alist->wet = (int16_t)w2;
+        return;
+    }
+    int channel = (flags & kVADPCMAlistLeft) != 0 ? 0 : 1;
+    if ((flags & kVADPCMAlistVol) != 0) {
+        alist->volume[channel] = (int16_t)w1;
+    } else {
+        alist->target[channel] = (int16_t)w1;
+        alist->rate[channel] = (int32_t)w2;
+    }
+}
+
+static vadpcm_error alist_dmemmove(struct vadpcm_alist *restrict alist,
+                                   uint32_t w1, uint32_t w2) {
+    uint32_t count = w2 & 0xffff;
+    if (count == 0) {
+        return kVADPCMErrNone;
+    }
+    uint32_t size = alist_align(count, 16);
+    const uint8_t *src = alist_dmem(alist, alist_buffer(w1 & 0xffff), size);
+    uint8_t *dest = alist_dmem(alist, alist_buffer(w2 >> 16), size);
+    if (src == NULL || dest == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    // Copied forwards, one byte at a time, like the microcode. Overlapping
+    // moves repeat the start of the source.
+    for (uint32_t i = 0; i < size; i++) {
+        dest[i] = src[i];
+    }
+    return kVADPCMErrNone;
+}
+
+static vadpcm_error alist_load_adpcm(struct vadpcm_alist *restrict alist,
+                                     uint32_t w1, uint32_t w2) {
+    uint32_t size = alist_align(w1 & 0xffff, 8);
+    if (size > sizeof(alist->codebook)) {
+        return kVADPCMErrInvalidData;
+    }
+    const uint8_t *src = alist_rdram(alist, alist_address(alist, w2), size);
+    if (src == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    for (uint32_t i = 0; i < size / 2; i++) {
+        int16_t value = (int16_t)alist_load16(src + 2 * i);
+        alist->codebook[i / kVADPCMVectorSampleCount]
+            .v[i % kVADPCMVectorSampleCount] = value;
+    }
+    alist->decoder_ready = false;
+    return kVADPCMErrNone;
+}
+
+static vadpcm_error alist_mixer(struct vadpcm_alist *restrict alist,
+                                uint32_t w1, uint32_t w2) {
+    if (alist->count == 0) {
+        return kVADPCMErrNone;
+    }
+    int gain = (int16_t)w1;
+    uint32_t size = alist_align(alist->count, 32);
+    const uint8_t *in = alist_dmem(alist, alist_buffer(w2 >> 16), size);
+    uint8_t *out = alist_dmem(alist, alist_buffer(w2 & 0xffff), size);
+    if (in == NULL || out == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    if (in != out && alist_overlap(in, size, out, size)) {
+        vadpcm_alist_mix_scalar(size / 2, out, in, gain);
+    } else {
+        vadpcm_get_kernels()->alist_mix(size / 2, out, in, gain);
+    }
+    return kVADPCMErrNone;
+}
+
+static vadpcm_error alist_interleave(struct vadpcm_alist *restrict alist,
+                                     uint32_t w2) {
+    if (alist->count == 0) {
+        return kVADPCMErrNone;
+    }
+    uint32_t size = alist_align(alist->count, 16);
+    const uint8_t *left = alist_dmem(alist, alist_buffer(w2 >> 16), size);
+    const uint8_t *right = alist_dmem(alist, alist_buffer(w2 & 0xffff), size);
+    uint8_t *out = alist_dmem(alist, alist->out, size * 2);
+    if (left == NULL || right == NULL || out == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+    if (alist_overlap(out, size * 2, left, size) ||
+        alist_overlap(out, size * 2, right, size)) {
+        vadpcm_alist_interleave_scalar(size / 2, out, left, right);
+    } else {
+        vadpcm_get_kernels()->alist_interleave(size / 2, out, left, right);
+    }
+    return kVADPCMErrNone;
+}
+
+static vadpcm_error alist_polef(struct vadpcm_alist *restrict alist,
+                                uint32_t w1, uint32_t w2) {
+    if (alist->count == 0) {
+        return kVADPCMErrNone;
+    }
+    int flags = (w1 >> 16) & 0xff;
+    int gain = (int)(w1 & 0xffff);
+    uint32_t size = alist_align(alist->count, 16);
+    uint8_t *state =
+        alist_rdram(alist, alist_address(alist, w2), kAlistPoleFStateSize);
+    const uint8_t *in = alist_dmem(alist, alist->in, size);
+    uint8_t *out = alist_dmem(alist, alist->out, size);
+    if (state == NULL || in == NULL || out == NULL) {
+        return kVADPCMErrInvalidData;
+    }
+
+    // The filter coefficients are the first two vectors of the ADPCM table.
+    const int16_t *h1 = alist->codebook[0].v;
+    const int16_t *h2 = alist->codebook[1].v;
+    int h2_gain[kVADPCMVectorSampleCount];
+    for (int i = 0; i < kVADPCMVectorSampleCount; i++) {
+        h2_gain[i] = (int16_t)((h2[i] * gain) >> 14);
+    }
+    int l1 = 0, l2 = 0;
+    if ((flags & kVADPCMAlistInit) == 0) {
+        l1 = alist_load16(state + 4);
+        l2 = alist_load16(state + 6);
+    }
+
+    for (uint32_t pos = 0; pos < size; pos += 16) {
+        int frame[kVADPCMVectorSampleCount];
+        int result[kVADPCMVectorSampleCount];
+        for (int i = 0; i < kVADPCMVectorSampleCount; i++) {
+            frame[i] = alist_load16(in + pos + 2 * i);
+        }
+        for (int i = 0; i < kVADPCMVectorSampleCount; i++) {
+            int64_t accumulator =
+                (int64_t)frame[i] * gain + h1[i] * l1 + h2[i] * l2;
+            for (int j = 0; j < i; j++) {
+                accumulator += h2_gain[j] * frame[i - 1 - j];
+            }
+            // The microcode accumulator wraps at 32 bits.
+            result[i] = alist_clamp16((int32_t)(uint32_t)accumulator >> 14);
+            alist_store16(out + pos + 2 * i, result[i]);
+        }
+        l1 = result[6];
+        l2 = result[7];
+    }
+
+    memcpy(state, out + size - kAlistPoleFStateSize, kAlistPoleFStateSize);
+    return kVADPCMErrNone;
+}
+
+void vadpcm_alist_init(struct vadpcm_alist *restrict alist, void *rdram,
+                       size_t rdram_size) {
+    memset(alist, 0, sizeof(*alist));
+    alist->rdram = rdram;
+    alist->rdram_size = rdram_size;
+    alist->resample_table = kVADPCMAlistResampleTable;
+}
+
+vadpcm_error vadpcm_alist_run(struct vadpcm_alist *restrict alist,
+                              size_t command_count,
+                              const uint32_t *restrict commands) {
+    for (size_t i = 0; i < command_count; i++) {
+        uint32_t w1 = commands[i * 2], w2 = commands[i * 2 + 1];
+        vadpcm_error err = kVADPCMErrNone;
+        switch (w1 >> 24) {
+        case kVADPCMAlistNoop:
+            break;
+        case kVADPCMAlistADPCM:
+            err = alist_adpcm(alist, w1, w2);
+            break;
+        case kVADPCMAlistClearBuff:
+            err = alist_clearbuff(alist, w1, w2);
+            break;
+        case kVADPCMAlistEnvMixer:
+            err = alist_envmixer(alist, w1, w2);
+            break;
+        case kVADPCMAlistLoadBuff:
+            err = alist_transfer(alist, w2, alist->in, false);
+            break;
+        case kVADPCMAlistResample:
+            err = alist_resample(alist, w1, w2);
+            break;
+        case kVADPCMAlistSaveBuff:
+            err = alist_transfer(alist, w2, alist->out, true);
+            break;
+        case kVADPCMAlistSegment:
+            alist->segments[(w2 >> 24) & (kVADPCMAlistSegmentCount - 1)] =
+                w2 & 0xffffff;
+            break;
+        case kVADPCMAlistSetBuff:
+            alist_setbuff(alist, w1, w2);
+            break;
+        case kVADPCMAlistSetVol:
+            alist_setvol(alist, w1, w2);
+            break;
+        case kVADPCMAlistDMEMMove:
+            err = alist_dmemmove(alist, w1, w2);
+            break;
+        case kVADPCMAlistLoadADPCM:
+            err = alist_load_adpcm(alist, w1, w2);
+            break;
+        case kVADPCMAlistMixer:
+            err = alist_mixer(alist, w1, w2);
+            break;
+        case kVADPCMAlistInterleave:
+            err = alist_interleave(alist, w2);
+            break;
+        case kVADPCMAlistPoleF:
+            err = alist_polef(alist, w1, w2);
+            break;
+        case kVADPCMAlistSetLoop:
+            alist->loop = alist_address(alist, w2);
+            break;
+        default:
+            err = kVADPCMErrInvalidData;
+            break;
+        }
+        if (err != kVADPCMErrNone) {
+            alist->error_command = i;
+            return err;
+        }
+    }
+    return kVADPCMErrNone;
+}
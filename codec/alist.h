@@ -0,0 +1,136 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+// High-level emulation of the libultra audio microcode (aspMain).
+//
+// This interprets audio command lists, as built by the libultra synthesizer,
+// on the host. The ADPCM stage uses the VADPCM decoder in this library. The
+// output is the same as the microcode's, except for resampling, which depends
+// on a coefficient table that is part of the microcode's data. Supply the
+// table from the game's microcode for exact resampling output.
+//
+// Each interpreter is independent, so different command lists can be rendered
+// on different threads at the same time, as long as they do not write to the
+// same memory.
+
+#include "codec/vadpcm.h"
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Audio command opcodes, in bits 24-31 of the first word of a command.
+typedef enum {
+    kVADPCMAlistNoop = 0,
+    kVADPCMAlistADPCM = 1,
+    kVADPCMAlistClearBuff = 2,
+    kVADPCMAlistEnvMixer = 3,
+    kVADPCMAlistLoadBuff = 4,
+    kVADPCMAlistResample = 5,
+    kVADPCMAlistSaveBuff = 6,
+    kVADPCMAlistSegment = 7,
+    kVADPCMAlistSetBuff = 8,
+    kVADPCMAlistSetVol = 9,
+    kVADPCMAlistDMEMMove = 10,
+    kVADPCMAlistLoadADPCM = 11,
+    kVADPCMAlistMixer = 12,
+    kVADPCMAlistInterleave = 13,
+    kVADPCMAlistPoleF = 14,
+    kVADPCMAlistSetLoop = 15,
+} vadpcm_alist_opcode;
+
+// Audio command flags, in bits 16-23 of the first word of a command. Some
+// flags have the same value, and their meaning depends on the command.
+enum {
+    // Start from a zero state, instead of loading the state from memory.
+    kVADPCMAlistInit = 0x01,
+    // ADPCM: Load the state from the loop address.
+    kVADPCMAlistLoop = 0x02,
+    // SETVOL: Set the left channel, instead of the right channel.
+    kVADPCMAlistLeft = 0x02,
+    // SETVOL: Set the starting volume, instead of the target and rate.
+    kVADPCMAlistVol = 0x04,
+    // SETBUFF, SETVOL, ENVMIXER: Auxiliary (wet) buffers and volume.
+    kVADPCMAlistAux = 0x08,
+};
+
+enum {
+    // Size of the emulated data memory, in bytes.
+    kVADPCMAlistDMEMSize = 0x1000,
+
+    // Number of segments for segmented addresses.
+    kVADPCMAlistSegmentCount = 16,
+
+    // Number of coefficients in the resampling table: four taps for each of
+    // 64 phases.
+    kVADPCMAlistResampleTableSize = 64 * 4,
+
+    // Maximum number of predictors in an ADPCM codebook. The microcode only
+    // supports predictor order 2.
+    kVADPCMAlistMaxPredictorCount = 16,
+};
+
+// An audio command list interpreter. Initialize with vadpcm_alist_init().
+// Fields other than rdram, rdram_size, and resample_table are private.
+struct vadpcm_alist {
+    // Emulated main memory, in big-endian byte order. Commands read and write
+    // audio data and state through this memory.
+    uint8_t *rdram;
+    size_t rdram_size;
+
+    // Resampling filter coefficients, in signed 1.15 fixed-point. For each
+    // phase, four coefficients are applied to four consecutive samples.
+    const int16_t *resample_table;
+
+    // Index of the command which failed, set by vadpcm_alist_run().
+    size_t error_command;
+
+    alignas(16) uint8_t dmem[kVADPCMAlistDMEMSize];
+    uint32_t segments[kVADPCMAlistSegmentCount];
+    uint32_t loop;
+    uint16_t in;
+    uint16_t out;
+    uint16_t count;
+    uint16_t dry_right;
+    uint16_t wet_left;
+    uint16_t wet_right;
+    int16_t dry;
+    int16_t wet;
+    int16_t volume[2];
+    int16_t target[2];
+    int32_t rate[2];
+    bool decoder_ready;
+    struct vadpcm_vector codebook[2 * kVADPCMAlistMaxPredictorCount];
+    struct vadpcm_decoder decoder;
+};
+
+// Default resampling table. This uses cubic interpolation, and does not give
+// the same output as the microcode.
+extern const int16_t kVADPCMAlistResampleTable[kVADPCMAlistResampleTableSize];
+
+// Initialize an interpreter, with the given emulated main memory. The
+// resampling table is set to the default table.
+void vadpcm_alist_init(struct vadpcm_alist *VADPCM_RESTRICT alist,
+                       void *rdram, size_t rdram_size);
+
+// Run a command list. Each command is two 32-bit words, in native byte order.
+// Commands are run in order, and the interpreter state carries over from one
+// command list to the next.
+//
+// Error codes:
+//   kVADPCMErrInvalidData: A command has an unknown opcode, or accesses memory
+//     outside the emulated data memory or main memory. The index of the
+//     command is stored in error_command. Commands before it have run.
+vadpcm_error vadpcm_alist_run(struct vadpcm_alist *VADPCM_RESTRICT alist,
+                              size_t command_count,
+                              const uint32_t *VADPCM_RESTRICT commands);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,44 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+// Audio list mixing kernels. Internal header.
+//
+// Samples are big-endian, like data memory. Gains are signed 1.15 fixed-point.
+// Each product is rounded, and added to the output with saturation, like the
+// microcode.
+//
+// The output may be the same as an input, but must not otherwise overlap it.
+// The interpreter uses the scalar kernels directly for buffers that partially
+// overlap, because the result then depends on the order the samples are
+// processed in.
+
+#include "codec/dispatch.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Add in * gain to out, for count samples.
+void vadpcm_alist_mix_scalar(size_t count, uint8_t *out, const uint8_t *in,
+                             int gain);
+
+// Add in * gains to out, for count samples, with a different gain for each
+// sample.
+void vadpcm_alist_mix_gains_scalar(size_t count, uint8_t *out,
+                                   const uint8_t *in,
+                                   const int16_t *restrict gains);
+
+// Interleave count samples from left and right into out.
+void vadpcm_alist_interleave_scalar(size_t count, uint8_t *out,
+                                    const uint8_t *left, const uint8_t *right);
+
+#if VADPCM_X86
+// SSE2 kernels. These process eight samples at a time.
+void vadpcm_alist_mix_sse2(size_t count, uint8_t *out, const uint8_t *in,
+                           int gain);
+void vadpcm_alist_mix_gains_sse2(size_t count, uint8_t *out, const uint8_t *in,
+                                 const int16_t *restrict gains);
+void vadpcm_alist_interleave_sse2(size_t count, uint8_t *out,
+                                  const uint8_t *left, const uint8_t *right);
+#endif
@@ -0,0 +1,75 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/alist_kernels.h"
+
+#if VADPCM_X86
+
+#include <emmintrin.h>
+
+// Swap the bytes in each 16-bit lane.
+VADPCM_TARGET("sse2")
+static inline __m128i vadpcm_alist_swap(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+// Mix eight big-endian samples. The products are rounded and added at 32 bits,
+// because a product can round to 0x8000, which does not fit in 16 bits.
+VADPCM_TARGET("sse2")
+static inline void vadpcm_alist_mix8(uint8_t *out, const uint8_t *in,
+                                     __m128i gain) {
+    const __m128i round = _mm_set1_epi32(0x4000);
+    __m128i x = vadpcm_alist_swap(_mm_loadu_si128((const __m128i *)in));
+    __m128i y = vadpcm_alist_swap(_mm_loadu_si128((const __m128i *)out));
+    __m128i lo = _mm_mullo_epi16(x, gain);
+    __m128i hi = _mm_mulhi_epi16(x, gain);
+    __m128i p0 = _mm_srai_epi32(
+        _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+    __m128i p1 = _mm_srai_epi32(
+        _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+    __m128i y0 = _mm_srai_epi32(_mm_unpacklo_epi16(y, y), 16);
+    __m128i y1 = _mm_srai_epi32(_mm_unpackhi_epi16(y, y), 16);
+    y = _mm_packs_epi32(_mm_add_epi32(y0, p0), _mm_add_epi32(y1, p1));
+    _mm_storeu_si128((__m128i *)out, vadpcm_alist_swap(y));
+}
+
+VADPCM_TARGET("sse2")
+void vadpcm_alist_mix_sse2(size_t count, uint8_t *out, const uint8_t *in,
+                           int gain) {
+    const __m128i gvec = _mm_set1_epi16((int16_t)gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vadpcm_alist_mix8(out + i * 2, in + i * 2, gvec);
+    }
+    vadpcm_alist_mix_scalar(count - i, out + i * 2, in + i * 2, gain);
+}
+
+VADPCM_TARGET("sse2")
+void vadpcm_alist_mix_gains_sse2(size_t count, uint8_t *out, const uint8_t *in,
+                                 const int16_t *restrict gains) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vadpcm_alist_mix8(out + i * 2, in + i * 2,
+                          _mm_loadu_si128((const __m128i *)(gains + i)));
+    }
+    vadpcm_alist_mix_gains_scalar(count - i, out + i * 2, in + i * 2,
+                                  gains + i);
+}
+
+VADPCM_TARGET("sse2")
+void vadpcm_alist_interleave_sse2(size_t count, uint8_t *out,
+                                  const uint8_t *left, const uint8_t *right) {
+    // Samples are moved whole, so the byte order does not matter.
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i l = _mm_loadu_si128((const __m128i *)(left + i * 2));
+        __m128i r = _mm_loadu_si128((const __m128i *)(right + i * 2));
+        _mm_storeu_si128((__m128i *)(out + i * 4), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i *)(out + i * 4 + 16),
+                         _mm_unpackhi_epi16(l, r));
+    }
+    vadpcm_alist_interleave_scalar(count - i, out + i * 4, left + i * 2,
+                                   right + i * 2);
+}
+
+#endif // VADPCM_X86
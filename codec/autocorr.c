@@ -3,15 +3,21 @@
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #include "codec/autocorr.h"
 
+#include "codec/dispatch.h"
 #include "codec/vadpcm.h"
 
-void vadpcm_autocorr(size_t frame_count, float (*restrict corr)[6],
-                     const int16_t *restrict src) {
+void vadpcm_autocorr_range(size_t first, size_t end,
+                           float (*restrict corr)[6],
+                           const int16_t *restrict src) {
     float x0 = 0.0f, x1 = 0.0f, x2 = 0.0f, m[6];
     size_t frame;
     int i;
 
-    for (frame = 0; frame < frame_count; frame++) {
+    if (first > 0) {
+        x1 = src[first * kVADPCMFrameSampleCount - 2] * (1.0f / 32768.0f);
+        x0 = src[first * kVADPCMFrameSampleCount - 1] * (1.0f / 32768.0f);
+    }
+    for (frame = first; frame < end; frame++) {
         for (i = 0; i < 6; i++) {
             m[i] = 0.0f;
         }
@@ -31,3 +37,13 @@ void vadpcm_autocorr(size_t frame_count, float (*restrict corr)[6],
         }
     }
 }
+
+void vadpcm_autocorr_scalar(size_t frame_count, float (*restrict corr)[6],
+                            const int16_t *restrict src) {
+    vadpcm_autocorr_range(0, frame_count, corr, src);
+}
+
+void vadpcm_autocorr(size_t frame_count, float (*restrict corr)[6],
+                     const int16_t *restrict src) {
+    vadpcm_get_kernels()->autocorr(frame_count, corr, src);
+}
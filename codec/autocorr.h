@@ -12,9 +12,32 @@
 // [_ 2 4]
 // [_ _ 5]
 
+#include "codec/dispatch.h"
+
 #include <stddef.h>
 #include <stdint.h>
 
 // Calculate the autocorrelation matrix for each frame.
 void vadpcm_autocorr(size_t frame_count, float (*restrict corr)[6],
                      const int16_t *restrict src);
+
+// Calculate the autocorrelation matrix for frames first..end-1. The previous
+// two samples are read from src, so the output is the same as if all frames
+// were processed at once.
+void vadpcm_autocorr_range(size_t first, size_t end,
+                           float (*restrict corr)[6],
+                           const int16_t *restrict src);
+
+// Portable implementation of vadpcm_autocorr.
+void vadpcm_autocorr_scalar(size_t frame_count, float (*restrict corr)[6],
+                            const int16_t *restrict src);
+
+#if VADPCM_X86
+// SSE2 implementation of vadpcm_autocorr. Processes four frames at a time.
+void vadpcm_autocorr_sse2(size_t frame_count, float (*restrict corr)[6],
+                          const int16_t *restrict src);
+
+// AVX2 implementation of vadpcm_autocorr. Processes eight frames at a time.
+void vadpcm_autocorr_avx2(size_t frame_count, float (*restrict corr)[6],
+                          const int16_t *restrict src);
+#endif
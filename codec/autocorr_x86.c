@@ -0,0 +1,190 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/autocorr.h"
+
+#include "codec/dispatch.h"
+#include "codec/vadpcm.h"
+
+#if VADPCM_X86
+
+#include <immintrin.h>
+
+// These kernels process several frames at once, one frame per lane. Each lane
+// performs exactly the same sequence of floating-point operations as the
+// scalar code, so the results are identical.
+
+// Running state for the SSE2 kernel.
+struct vadpcm_autocorr4 {
+    __m128 x0, x1, x2, m[6];
+};
+
+// Add one sample to the autocorrelation.
+VADPCM_TARGET("sse2")
+static inline void vadpcm_autocorr4_step(struct vadpcm_autocorr4 *restrict a,
+                                         __m128i samples) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    a->x2 = a->x1;
+    a->x1 = a->x0;
+    a->x0 = _mm_mul_ps(_mm_cvtepi32_ps(samples), scale);
+    a->m[0] = _mm_add_ps(a->m[0], _mm_mul_ps(a->x0, a->x0));
+    a->m[1] = _mm_add_ps(a->m[1], _mm_mul_ps(a->x1, a->x0));
+    a->m[2] = _mm_add_ps(a->m[2], _mm_mul_ps(a->x1, a->x1));
+    a->m[3] = _mm_add_ps(a->m[3], _mm_mul_ps(a->x2, a->x0));
+    a->m[4] = _mm_add_ps(a->m[4], _mm_mul_ps(a->x2, a->x1));
+    a->m[5] = _mm_add_ps(a->m[5], _mm_mul_ps(a->x2, a->x2));
+}
+
+// Add two samples to the autocorrelation. The input contains the first sample
+// for each frame in the low half, and the second sample in the high half.
+VADPCM_TARGET("sse2")
+static inline void vadpcm_autocorr4_step2(struct vadpcm_autocorr4 *restrict a,
+                                          __m128i samples) {
+    vadpcm_autocorr4_step(
+        a, _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+    vadpcm_autocorr4_step(
+        a, _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+}
+
+VADPCM_TARGET("sse2")
+void vadpcm_autocorr_sse2(size_t frame_count, float (*restrict corr)[6],
+                          const int16_t *restrict src) {
+    size_t group_end = frame_count & ~(size_t)3;
+    for (size_t frame = 0; frame < group_end; frame += 4) {
+        const int16_t *fptr = src + frame * kVADPCMFrameSampleCount;
+        struct vadpcm_autocorr4 a;
+        float prev[2][4];
+        for (int j = 0; j < 4; j++) {
+            if (frame + j == 0) {
+                prev[0][j] = 0.0f;
+                prev[1][j] = 0.0f;
+            } else {
+                const int16_t *p = fptr + kVADPCMFrameSampleCount * j;
+                prev[0][j] = p[-1] * (1.0f / 32768.0f);
+                prev[1][j] = p[-2] * (1.0f / 32768.0f);
+            }
+        }
+        a.x0 = _mm_loadu_ps(prev[0]);
+        a.x1 = _mm_loadu_ps(prev[1]);
+        for (int i = 0; i < 6; i++) {
+            a.m[i] = _mm_setzero_ps();
+        }
+        for (int half = 0; half < 2; half++) {
+            // Transpose so each vector has the same sample from each frame.
+            __m128i r[4];
+            for (int j = 0; j < 4; j++) {
+                r[j] = _mm_loadu_si128(
+                    (const __m128i *)(fptr + kVADPCMFrameSampleCount * j +
+                                      8 * half));
+            }
+            __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]);
+            __m128i t1 = _mm_unpacklo_epi16(r[2], r[3]);
+            __m128i t2 = _mm_unpackhi_epi16(r[0], r[1]);
+            __m128i t3 = _mm_unpackhi_epi16(r[2], r[3]);
+            vadpcm_autocorr4_step2(&a, _mm_unpacklo_epi32(t0, t1));
+            vadpcm_autocorr4_step2(&a, _mm_unpackhi_epi32(t0, t1));
+            vadpcm_autocorr4_step2(&a, _mm_unpacklo_epi32(t2, t3));
+            vadpcm_autocorr4_step2(&a, _mm_unpackhi_epi32(t2, t3));
+        }
+        float m[6][4];
+        for (int i = 0; i < 6; i++) {
+            _mm_storeu_ps(m[i], a.m[i]);
+        }
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 6; i++) {
+                corr[frame + j][i] = m[i][j];
+            }
+        }
+    }
+    vadpcm_autocorr_range(group_end, frame_count, corr, src);
+}
+
+// Running state for the AVX2 kernel.
+struct vadpcm_autocorr8 {
+    __m256 x0, x1, x2, m[6];
+};
+
+// Add one sample to the autocorrelation. The input contains one 16-bit sample
+// for each frame.
+VADPCM_TARGET("avx2")
+static inline void vadpcm_autocorr8_step(struct vadpcm_autocorr8 *restrict a,
+                                         __m128i samples) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    a->x2 = a->x1;
+    a->x1 = a->x0;
+    a->x0 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples)),
+                          scale);
+    a->m[0] = _mm256_add_ps(a->m[0], _mm256_mul_ps(a->x0, a->x0));
+    a->m[1] = _mm256_add_ps(a->m[1], _mm256_mul_ps(a->x1, a->x0));
+    a->m[2] = _mm256_add_ps(a->m[2], _mm256_mul_ps(a->x1, a->x1));
+    a->m[3] = _mm256_add_ps(a->m[3], _mm256_mul_ps(a->x2, a->x0));
+    a->m[4] = _mm256_add_ps(a->m[4], _mm256_mul_ps(a->x2, a->x1));
+    a->m[5] = _mm256_add_ps(a->m[5], _mm256_mul_ps(a->x2, a->x2));
+}
+
+VADPCM_TARGET("avx2")
+void vadpcm_autocorr_avx2(size_t frame_count, float (*restrict corr)[6],
+                          const int16_t *restrict src) {
+    size_t group_end = frame_count & ~(size_t)7;
+    for (size_t frame = 0; frame < group_end; frame += 8) {
+        const int16_t *fptr = src + frame * kVADPCMFrameSampleCount;
+        struct vadpcm_autocorr8 a;
+        float prev[2][8];
+        for (int j = 0; j < 8; j++) {
+            if (frame + j == 0) {
+                prev[0][j] = 0.0f;
+                prev[1][j] = 0.0f;
+            } else {
+                const int16_t *p = fptr + kVADPCMFrameSampleCount * j;
+                prev[0][j] = p[-1] * (1.0f / 32768.0f);
+                prev[1][j] = p[-2] * (1.0f / 32768.0f);
+            }
+        }
+        a.x0 = _mm256_loadu_ps(prev[0]);
+        a.x1 = _mm256_loadu_ps(prev[1]);
+        for (int i = 0; i < 6; i++) {
+            a.m[i] = _mm256_setzero_ps();
+        }
+        for (int half = 0; half < 2; half++) {
+            // Transpose 8x8, so each vector has the same sample from each
+            // frame.
+            __m128i r[8], t[8], u[8];
+            for (int j = 0; j < 8; j++) {
+                r[j] = _mm_loadu_si128(
+                    (const __m128i *)(fptr + kVADPCMFrameSampleCount * j +
+                                      8 * half));
+            }
+            for (int j = 0; j < 4; j++) {
+                t[j] = _mm_unpacklo_epi16(r[2 * j], r[2 * j + 1]);
+                t[j + 4] = _mm_unpackhi_epi16(r[2 * j], r[2 * j + 1]);
+            }
+            for (int j = 0; j < 2; j++) {
+                u[j * 4 + 0] = _mm_unpacklo_epi32(t[j * 4], t[j * 4 + 1]);
+                u[j * 4 + 1] = _mm_unpackhi_epi32(t[j * 4], t[j * 4 + 1]);
+                u[j * 4 + 2] = _mm_unpacklo_epi32(t[j * 4 + 2], t[j * 4 + 3]);
+                u[j * 4 + 3] = _mm_unpackhi_epi32(t[j * 4 + 2], t[j * 4 + 3]);
+            }
+            for (int j = 0; j < 2; j++) {
+                __m128i lo = u[j * 4], hi = u[j * 4 + 2];
+                vadpcm_autocorr8_step(&a, _mm_unpacklo_epi64(lo, hi));
+                vadpcm_autocorr8_step(&a, _mm_unpackhi_epi64(lo, hi));
+                lo = u[j * 4 + 1];
+                hi = u[j * 4 + 3];
+                vadpcm_autocorr8_step(&a, _mm_unpacklo_epi64(lo, hi));
+                vadpcm_autocorr8_step(&a, _mm_unpackhi_epi64(lo, hi));
+            }
+        }
+        float m[6][8];
+        for (int i = 0; i < 6; i++) {
+            _mm256_storeu_ps(m[i], a.m[i]);
+        }
+        for (int j = 0; j < 8; j++) {
+            for (int i = 0; i < 6; i++) {
+                corr[frame + j][i] = m[i][j];
+            }
+        }
+    }
+    vadpcm_autocorr_range(group_end, frame_count, corr, src);
+}
+
+#endif // VADPCM_X86
@@ -1,9 +1,15 @@
 // Copyright 2022 Dietrich Epp.
 // This file is part of VADPCM. VADPCM is licensed under the terms of the
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+
+#include "codec/dispatch.h"
 #include "codec/vadpcm.h"
 
 #include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
 
 // Extend the sign bit of a 4-bit integer.
 static int vadpcm_ext4(int x) {
@@ -18,25 +24,74 @@ static int vadpcm_clamp16(int x) {
     return x;
 }
 
-vadpcm_error vadpcm_decode(int predictor_count, int order,
-                           const struct vadpcm_vector *restrict codebook,
-                           struct vadpcm_vector *restrict state,
-                           size_t frame_count, int16_t *restrict dest,
-                           const void *restrict src) {
+// Extract the sixteen 4-bit residuals from a frame and sign-extend them. If
+// swar is true, this operates on all bytes at once in a 64-bit integer.
+static VADPCM_ALWAYS_INLINE void vadpcm_unpack(int *restrict residuals,
+                                               const uint8_t *restrict src,
+                                               bool swar) {
+    if (!swar) {
+        for (int i = 0; i < 8; i++) {
+            int byte = src[i];
+            residuals[2 * i] = vadpcm_ext4(byte >> 4);
+            residuals[2 * i + 1] = vadpcm_ext4(byte & 15);
+        }
+        return;
+    }
+    // Sign-extend each nibble to a byte. Setting bit 7 first means that the
+    // subtraction cannot borrow from the next byte:
+    //
+    //   ext4(x) = (((x ^ 8) | 0x80) - 8) ^ 0x80
+    //
+    // Each byte is handled separately, so the host byte order does not matter.
+    const uint64_t nibbles = UINT64_C(0x0f0f0f0f0f0f0f0f);
+    const uint64_t bias = UINT64_C(0x0808080808080808);
+    const uint64_t high = UINT64_C(0x8080808080808080);
+    uint64_t word;
+    memcpy(&word, src, sizeof(word));
+    uint64_t hi = (((((word >> 4) & nibbles) ^ bias) | high) - bias) ^ high;
+    uint64_t lo = ((((word & nibbles) ^ bias) | high) - bias) ^ high;
+    int8_t hi_bytes[8], lo_bytes[8];
+    memcpy(hi_bytes, &hi, sizeof(hi));
+    memcpy(lo_bytes, &lo, sizeof(lo));
+    for (int i = 0; i < 8; i++) {
+        residuals[2 * i] = hi_bytes[i];
+        residuals[2 * i + 1] = lo_bytes[i];
+    }
+}
+
+// Decode with the given predictor order. This is inlined into a separate
+// function for each order, so the loops over the order have a constant trip
+// count and can be fully unrolled.
+static VADPCM_ALWAYS_INLINE vadpcm_error vadpcm_decode_order(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src, bool swar,
+    bool trusted, struct vadpcm_telemetry *restrict telemetry) {
     const uint8_t *sptr = src;
     for (size_t frame = 0; frame < frame_count; frame++) {
         const uint8_t *fin = sptr + kVADPCMFrameByteSize * frame;
 
-        // Control byte: scaling & predictor index.
+        // Control byte: scaling & predictor index. Trusted input has already
+        // been checked by vadpcm_validate().
         int control = fin[0];
         int scaling = control >> 4;
         int predictor_index = control & 15;
-        if (predictor_index >= predictor_count) {
+        if (!trusted && predictor_index >= predictor_count) {
             return kVADPCMErrInvalidData;
         }
+        if (telemetry != NULL) {
+            telemetry->frame_count++;
+            telemetry->predictor_histogram[predictor_index]++;
+            telemetry->scaling_histogram[scaling]++;
+        }
         const struct vadpcm_vector *predictor =
             codebook + order * predictor_index;
 
+        // Decode the ADPCM residuals.
+        int residuals[16];
+        vadpcm_unpack(residuals, fin + 1, swar);
+
         // Decode each of the two vectors within the frame.
         for (int vector = 0; vector < 2; vector++) {
             int32_t accumulator[8];
@@ -52,18 +107,10 @@ vadpcm_error vadpcm_decode(int predictor_count, int order,
                 }
             }
 
-            // Decode the ADPCM residual.
-            int residuals[8];
-            for (int i = 0; i < 4; i++) {
-                int byte = fin[1 + 4 * vector + i];
-                residuals[2 * i] = vadpcm_ext4(byte >> 4);
-                residuals[2 * i + 1] = vadpcm_ext4(byte & 15);
-            }
-
             // Accumulate the residual and predicted values.
             const struct vadpcm_vector *v = &predictor[order - 1];
             for (int k = 0; k < 8; k++) {
-                int residual = residuals[k] * (1 << scaling);
+                int residual = residuals[8 * vector + k] * (1 << scaling);
                 accumulator[k] += residual * (1 << 11);
                 for (int i = 0; i < 7 - k; i++) {
                     accumulator[k + 1 + i] += residual * v->v[i];
@@ -72,7 +119,11 @@ vadpcm_error vadpcm_decode(int predictor_count, int order,
 
             // Discard fractional part and clamp to 16-bit range.
             for (int i = 0; i < 8; i++) {
-                int sample = vadpcm_clamp16(accumulator[i] >> 11);
+                int value = accumulator[i] >> 11;
+                int sample = vadpcm_clamp16(value);
+                if (telemetry != NULL && sample != value) {
+                    telemetry->clamp_count++;
+                }
                 dest[kVADPCMFrameSampleCount * frame + 8 * vector + i] = sample;
                 state->v[i] = sample;
             }
@@ -80,3 +131,575 @@ vadpcm_error vadpcm_decode(int predictor_count, int order,
     }
     return 0;
 }
+
+#define VADPCM_DECODE_ORDER(n)                                                \
+    static vadpcm_error vadpcm_decode_order##n(                               \
+        int predictor_count, const struct vadpcm_vector *restrict codebook,   \
+        struct vadpcm_vector *restrict state, size_t frame_count,             \
+        int16_t *restrict dest, const void *restrict src, bool swar,          \
+        bool trusted) {                                                       \
+        if (trusted) {                                                        \
+            if (swar) {                                                       \
+                return vadpcm_decode_order(predictor_count, n, codebook,      \
+                                           state, frame_count, dest, src,     \
+                                           true, true, NULL);                 \
+            }                                                                 \
+            return vadpcm_decode_order(predictor_count, n, codebook, state,   \
+                                       frame_count, dest, src, false, true,   \
+                                       NULL);                                 \
+        }                                                                     \
+        if (swar) {                                                           \
+            return vadpcm_decode_order(predictor_count, n, codebook, state,   \
+                                       frame_count, dest, src, true, false,   \
+                                       NULL);                                 \
+        }                                                                     \
+        return vadpcm_decode_order(predictor_count, n, codebook, state,       \
+                                   frame_count, dest, src, false, false,      \
+                                   NULL);                                     \
+    }
+
+VADPCM_DECODE_ORDER(1)
+VADPCM_DECODE_ORDER(2)
+VADPCM_DECODE_ORDER(3)
+VADPCM_DECODE_ORDER(4)
+VADPCM_DECODE_ORDER(5)
+VADPCM_DECODE_ORDER(6)
+VADPCM_DECODE_ORDER(7)
+VADPCM_DECODE_ORDER(8)
+
+#undef VADPCM_DECODE_ORDER
+
+// Generic version, for any order.
+static vadpcm_error vadpcm_decode_generic(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src, bool swar,
+    bool trusted) {
+    if (trusted) {
+        if (swar) {
+            return vadpcm_decode_order(predictor_count, order, codebook, state,
+                                       frame_count, dest, src, true, true,
+                                       NULL);
+        }
+        return vadpcm_decode_order(predictor_count, order, codebook, state,
+                                   frame_count, dest, src, false, true, NULL);
+    }
+    if (swar) {
+        return vadpcm_decode_order(predictor_count, order, codebook, state,
+                                   frame_count, dest, src, true, false, NULL);
+    }
+    return vadpcm_decode_order(predictor_count, order, codebook, state,
+                               frame_count, dest, src, false, false, NULL);
+}
+
+// Choose the decoder for the given order.
+static vadpcm_error vadpcm_decode_any(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src, bool swar,
+    bool trusted) {
+    switch (order) {
+    case 1:
+        return vadpcm_decode_order1(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 2:
+        return vadpcm_decode_order2(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 3:
+        return vadpcm_decode_order3(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 4:
+        return vadpcm_decode_order4(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 5:
+        return vadpcm_decode_order5(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 6:
+        return vadpcm_decode_order6(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 7:
+        return vadpcm_decode_order7(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    case 8:
+        return vadpcm_decode_order8(predictor_count, codebook, state,
+                                    frame_count, dest, src, swar, trusted);
+    default:
+        return vadpcm_decode_generic(predictor_count, order, codebook, state,
+                                     frame_count, dest, src, swar, trusted);
+    }
+}
+
+vadpcm_error vadpcm_decode_scalar(int predictor_count, int order,
+                                  const struct vadpcm_vector *restrict codebook,
+                                  struct vadpcm_vector *restrict state,
+                                  size_t frame_count, int16_t *restrict dest,
+                                  const void *restrict src) {
+    return vadpcm_decode_any(predictor_count, order, codebook, state,
+                             frame_count, dest, src, false, false);
+}
+
+vadpcm_error vadpcm_decode_swar(int predictor_count, int order,
+                                const struct vadpcm_vector *restrict codebook,
+                                struct vadpcm_vector *restrict state,
+                                size_t frame_count, int16_t *restrict dest,
+                                const void *restrict src) {
+    return vadpcm_decode_any(predictor_count, order, codebook, state,
+                             frame_count, dest, src, true, false);
+}
+
+void vadpcm_decode_trusted_scalar(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    vadpcm_decode_any(predictor_count, order, codebook, state, frame_count,
+                      dest, src, false, true);
+}
+
+void vadpcm_decode_trusted_swar(int predictor_count, int order,
+                                const struct vadpcm_vector *restrict codebook,
+                                struct vadpcm_vector *restrict state,
+                                size_t frame_count, int16_t *restrict dest,
+                                const void *restrict src) {
+    vadpcm_decode_any(predictor_count, order, codebook, state, frame_count,
+                      dest, src, true, true);
+}
+
+void vadpcm_predictor_matrix(struct vadpcm_vector *restrict matrix, int order,
+                             const struct vadpcm_vector *restrict predictor) {
+    // Columns of the matrix: previous output, then residuals.
+    struct vadpcm_vector col[16];
+    memset(col, 0, sizeof(col));
+    for (int k = 0; k < order; k++) {
+        col[8 - order + k] = predictor[k];
+    }
+    for (int j = 0; j < 8; j++) {
+        short *restrict v = col[8 + j].v;
+        v[j] = 1 << 11;
+        if (order > 0) {
+            for (int i = j + 1; i < 8; i++) {
+                v[i] = predictor[order - 1].v[i - j - 1];
+            }
+        }
+    }
+    // Interleave pairs of columns.
+    for (int p = 0; p < 8; p++) {
+        for (int h = 0; h < 2; h++) {
+            for (int i = 0; i < 4; i++) {
+                matrix[2 * p + h].v[2 * i] = col[2 * p].v[4 * h + i];
+                matrix[2 * p + h].v[2 * i + 1] = col[2 * p + 1].v[4 * h + i];
+            }
+        }
+    }
+}
+
+void vadpcm_decoder_init(struct vadpcm_decoder *restrict decoder,
+                         int predictor_count, int order,
+                         const struct vadpcm_vector *restrict codebook) {
+    if (predictor_count > kVADPCMMaxPredictorCount) {
+        predictor_count = kVADPCMMaxPredictorCount;
+    }
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->order = order;
+    decoder->valid_mask = ((uint32_t)1 << predictor_count) - 1;
+    for (int n = 0; n < predictor_count; n++) {
+        vadpcm_predictor_matrix(decoder->matrix[n], order,
+                                codebook + order * n);
+    }
+}
+
+vadpcm_error vadpcm_decoder_prepare(
+    struct vadpcm_decoder *restrict decoder, int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook) {
+    if (predictor_count < 0 || kVADPCMMaxPredictorCount < predictor_count ||
+        order < 0 || kVADPCMMaxOrder < order) {
+        return kVADPCMErrInvalidParams;
+    }
+    vadpcm_decoder_init(decoder, predictor_count, order, codebook);
+    return 0;
+}
+
+// Round a scaled sample to the nearest integer, for a 32-bit integer mix. The
+// value saturates like the SIMD kernels, since lrintf() is undefined out of
+// range.
+static uint32_t vadpcm_mix_round(float x) {
+    if (!(x >= VADPCM_MIX_S32_MIN)) {
+        x = VADPCM_MIX_S32_MIN;
+    } else if (x > VADPCM_MIX_S32_MAX) {
+        x = VADPCM_MIX_S32_MAX;
+    }
+    return (uint32_t)(int32_t)lrintf(x);
+}
+
+// Decode with a prepared codebook, writing samples in the given output format.
+// The state is always native 16-bit integers. The left and right gains are
+// only used when mixing.
+static VADPCM_ALWAYS_INLINE vadpcm_error vadpcm_decoder_decode_impl(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    void *restrict dest, const void *restrict src, bool swar,
+    vadpcm_output output, float left, float right) {
+    const uint8_t *sptr = src;
+    // The state columns before this pair are all zero.
+    int first_pair = (8 - decoder->order) >> 1;
+    uint32_t invalid = 0;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        const uint8_t *fin = sptr + kVADPCMFrameByteSize * frame;
+
+        // Control byte: scaling & predictor index. Invalid predictors have a
+        // zero matrix, so there is no need to stop early.
+        int control = fin[0];
+        int scaling = control >> 4;
+        int predictor_index = control & 15;
+        invalid |= ~decoder->valid_mask >> predictor_index;
+        const struct vadpcm_vector *restrict matrix =
+            decoder->matrix[predictor_index];
+        int frame_residuals[16];
+        vadpcm_unpack(frame_residuals, fin + 1, swar);
+
+        // Decode each of the two vectors within the frame.
+        for (int vector = 0; vector < 2; vector++) {
+            const int *restrict residuals = frame_residuals + 8 * vector;
+
+            // Contribution from the residuals, before scaling.
+            int32_t accumulator[8];
+            for (int i = 0; i < 8; i++) {
+                accumulator[i] = 0;
+            }
+            for (int p = 0; p < 4; p++) {
+                for (int h = 0; h < 2; h++) {
+                    const short *restrict m = matrix[8 + 2 * p + h].v;
+                    for (int i = 0; i < 4; i++) {
+                        accumulator[4 * h + i] +=
+                            m[2 * i] * residuals[2 * p] +
+                            m[2 * i + 1] * residuals[2 * p + 1];
+                    }
+                }
+            }
+            for (int i = 0; i < 8; i++) {
+                accumulator[i] = (int32_t)((uint32_t)accumulator[i] << scaling);
+            }
+
+            // Contribution from the previous vector.
+            for (int p = first_pair; p < 4; p++) {
+                for (int h = 0; h < 2; h++) {
+                    const short *restrict m = matrix[2 * p + h].v;
+                    for (int i = 0; i < 4; i++) {
+                        accumulator[4 * h + i] +=
+                            m[2 * i] * state->v[2 * p] +
+                            m[2 * i + 1] * state->v[2 * p + 1];
+                    }
+                }
+            }
+
+            // Discard fractional part and clamp to 16-bit range.
+            for (int i = 0; i < 8; i++) {
+                int sample = vadpcm_clamp16(accumulator[i] >> 11);
+                size_t index =
+                    kVADPCMFrameSampleCount * frame + 8 * vector + i;
+                switch (output) {
+                case kVADPCMOutputS16:
+                    ((int16_t *)dest)[index] = sample;
+                    break;
+                case kVADPCMOutputS16Swap:
+                    ((int16_t *)dest)[index] =
+                        (int16_t)(uint16_t)(((sample & 0xff) << 8) |
+                                            ((sample >> 8) & 0xff));
+                    break;
+                case kVADPCMOutputF32:
+                    ((float *)dest)[index] = (float)sample * (1.0f / 32768.0f);
+                    break;
+                case kVADPCMOutputMixF32: {
+                    float *restrict mix = (float *)dest + 2 * index;
+                    mix[0] += (float)sample * left;
+                    mix[1] += (float)sample * right;
+                } break;
+                case kVADPCMOutputMixS32: {
+                    // Wrap on overflow, like the SIMD kernels.
+                    int32_t *restrict mix = (int32_t *)dest + 2 * index;
+                    mix[0] = (int32_t)((uint32_t)mix[0] +
+                                       vadpcm_mix_round((float)sample * left));
+                    mix[1] = (int32_t)((uint32_t)mix[1] +
+                                       vadpcm_mix_round((float)sample * right));
+                } break;
+                }
+                state->v[i] = sample;
+            }
+        }
+    }
+    return (invalid & 1) != 0 ? kVADPCMErrInvalidData : 0;
+}
+
+vadpcm_error vadpcm_decoder_decode_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      false, kVADPCMOutputS16, 0.0f, 0.0f);
+}
+
+vadpcm_error vadpcm_decoder_decode_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      true, kVADPCMOutputS16, 0.0f, 0.0f);
+}
+
+vadpcm_error vadpcm_decoder_decode_swap_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      false, kVADPCMOutputS16Swap, 0.0f, 0.0f);
+}
+
+vadpcm_error vadpcm_decoder_decode_swap_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      true, kVADPCMOutputS16Swap, 0.0f, 0.0f);
+}
+
+vadpcm_error vadpcm_decoder_decode_f32_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      false, kVADPCMOutputF32, 0.0f, 0.0f);
+}
+
+vadpcm_error vadpcm_decoder_decode_f32_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      true, kVADPCMOutputF32, 0.0f, 0.0f);
+}
+
+vadpcm_error vadpcm_decoder_mix_f32_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      false, kVADPCMOutputMixF32, left, right);
+}
+
+vadpcm_error vadpcm_decoder_mix_s32_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      false, kVADPCMOutputMixS32, left, right);
+}
+
+vadpcm_error vadpcm_decoder_mix_f32_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      true, kVADPCMOutputMixF32, left, right);
+}
+
+vadpcm_error vadpcm_decoder_mix_s32_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right) {
+    return vadpcm_decoder_decode_impl(decoder, state, frame_count, dest, src,
+                                      true, kVADPCMOutputMixS32, left, right);
+}
+
+// Decode channels into an interleaved buffer. Each frame is decoded from every
+// channel before moving to the next frame, so the output is written in order.
+static VADPCM_ALWAYS_INLINE vadpcm_error vadpcm_decode_interleaved_impl(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest, bool swar) {
+    for (size_t c = 0; c < channel_count; c++) {
+        channels[c].error = 0;
+    }
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        int16_t *restrict fdest =
+            dest + stride * kVADPCMFrameSampleCount * frame;
+        for (size_t c = 0; c < channel_count; c++) {
+            struct vadpcm_channel *restrict channel = &channels[c];
+            const uint8_t *fin =
+                (const uint8_t *)channel->src + kVADPCMFrameByteSize * frame;
+            int16_t samples[kVADPCMFrameSampleCount];
+            vadpcm_error err = vadpcm_decoder_decode_impl(
+                channel->decoder, channel->state, 1, samples, fin, swar,
+                kVADPCMOutputS16, 0.0f, 0.0f);
+            if (err != 0) {
+                channel->error = err;
+            }
+            for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+                fdest[stride * i + c] = samples[i];
+            }
+        }
+    }
+    vadpcm_error result = 0;
+    for (size_t c = 0; c < channel_count; c++) {
+        if (channels[c].error != 0) {
+            result = channels[c].error;
+        }
+    }
+    return result;
+}
+
+vadpcm_error vadpcm_decode_interleaved_scalar(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest) {
+    return vadpcm_decode_interleaved_impl(channel_count, channels, frame_count,
+                                          stride, dest, false);
+}
+
+vadpcm_error vadpcm_decode_interleaved_swar(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest) {
+    return vadpcm_decode_interleaved_impl(channel_count, channels, frame_count,
+                                          stride, dest, true);
+}
+
+vadpcm_error vadpcm_decode(int predictor_count, int order,
+                           const struct vadpcm_vector *restrict codebook,
+                           struct vadpcm_vector *restrict state,
+                           size_t frame_count, int16_t *restrict dest,
+                           const void *restrict src) {
+    return vadpcm_get_kernels()->decode(predictor_count, order, codebook,
+                                        state, frame_count, dest, src);
+}
+
+vadpcm_error vadpcm_decode_telemetry(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src,
+    struct vadpcm_telemetry *restrict telemetry) {
+    return vadpcm_decode_order(predictor_count, order, codebook, state,
+                               frame_count, dest, src, false, false,
+                               telemetry);
+}
+
+void vadpcm_decode_trusted(int predictor_count, int order,
+                           const struct vadpcm_vector *restrict codebook,
+                           struct vadpcm_vector *restrict state,
+                           size_t frame_count, int16_t *restrict dest,
+                           const void *restrict src) {
+    vadpcm_get_kernels()->decode_trusted(predictor_count, order, codebook,
+                                         state, frame_count, dest, src);
+}
+
+vadpcm_error vadpcm_decoder_decode(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_get_kernels()->decoder_decode(decoder, state, frame_count,
+                                                dest, src);
+}
+
+enum {
+    // Number of frames to decode at a time when the output is discarded.
+    kVADPCMScratchFrames = 64,
+};
+
+vadpcm_error vadpcm_skip(const struct vadpcm_decoder *restrict decoder,
+                         struct vadpcm_vector *restrict state,
+                         size_t frame_count, const void *restrict src) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    const uint8_t *sptr = src;
+    int16_t scratch[kVADPCMScratchFrames * kVADPCMFrameSampleCount];
+    vadpcm_error result = 0;
+    while (frame_count > 0) {
+        size_t n = frame_count < kVADPCMScratchFrames ? frame_count
+                                                      : kVADPCMScratchFrames;
+        vadpcm_error err =
+            kernels->decoder_decode(decoder, state, n, scratch, sptr);
+        if (err != 0) {
+            result = err;
+        }
+        sptr += n * kVADPCMFrameByteSize;
+        frame_count -= n;
+    }
+    return result;
+}
+
+vadpcm_error vadpcm_decoder_decode_f32(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src) {
+    return vadpcm_get_kernels()->decoder_decode_f32(decoder, state,
+                                                    frame_count, dest, src);
+}
+
+vadpcm_error vadpcm_decode_f32(int predictor_count, int order,
+                               const struct vadpcm_vector *restrict codebook,
+                               struct vadpcm_vector *restrict state,
+                               size_t frame_count, float *restrict dest,
+                               const void *restrict src) {
+    struct vadpcm_decoder decoder;
+    vadpcm_error err =
+        vadpcm_decoder_prepare(&decoder, predictor_count, order, codebook);
+    if (err != 0) {
+        return err;
+    }
+    return vadpcm_decoder_decode_f32(&decoder, state, frame_count, dest, src);
+}
+
+vadpcm_error vadpcm_decoder_decode_be(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    void *restrict dest, const void *restrict src) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    return (VADPCM_BIG_ENDIAN ? kernels->decoder_decode
+                              : kernels->decoder_decode_swap)(
+        decoder, state, frame_count, dest, src);
+}
+
+vadpcm_error vadpcm_decoder_decode_le(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    void *restrict dest, const void *restrict src) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    return (VADPCM_BIG_ENDIAN ? kernels->decoder_decode_swap
+                              : kernels->decoder_decode)(
+        decoder, state, frame_count, dest, src);
+}
+
+vadpcm_error vadpcm_decode_multi(size_t job_count,
+                                 struct vadpcm_decode_job *restrict jobs) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    if (kernels->decode_multi != NULL) {
+        return kernels->decode_multi(job_count, jobs);
+    }
+    vadpcm_error result = 0;
+    for (size_t i = 0; i < job_count; i++) {
+        struct vadpcm_decode_job *job = &jobs[i];
+        job->error = kernels->decoder_decode(job->decoder, job->state,
+                                             job->frame_count, job->dest,
+                                             job->src);
+        if (job->error != 0) {
+            result = job->error;
+        }
+    }
+    return result;
+}
+
+vadpcm_error vadpcm_decode_interleaved(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest) {
+    if (stride < channel_count) {
+        return kVADPCMErrInvalidParams;
+    }
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    vadpcm_error result = kernels->decode_interleaved(
+        channel_count, channels, frame_count, stride, dest);
+    for (size_t c = 0; c < channel_count; c++) {
+        channels[c].src = (const uint8_t *)channels[c].src +
+                          frame_count * kVADPCMFrameByteSize;
+    }
+    return result;
+}
@@ -0,0 +1,270 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+// VADPCM decoder kernels. Internal header.
+//
+// The prepared decoder is written as a matrix multiplication. Each output
+// vector is the product of an 8x16 matrix and a 16-element input, which
+// consists of the previous output vector followed by the eight residuals. The
+// residual half of the product is shifted by the scaling factor separately.
+// This gives the same result as the recurrence in vadpcm_decode_scalar(),
+// modulo 2^32, because shifting distributes over the sum.
+//
+// The matrix is stored as pairs of columns, interleaved so that it can be
+// multiplied with a pairwise multiply-add instruction. Vector 2p+h contains
+// columns 2p and 2p+1, rows 4h through 4h+3:
+//
+//   matrix[2p+h].v[2i+c] = M[4h+i][2p+c]
+//
+// Columns 0-7 multiply the previous output and columns 8-15 multiply the
+// residuals. The first 8-order state columns are zero.
+
+#include "codec/dispatch.h"
+#include "codec/vadpcm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Output sample format for a prepared decoder kernel.
+typedef enum {
+    // Native 16-bit integers.
+    kVADPCMOutputS16,
+    // Byte-swapped 16-bit integers.
+    kVADPCMOutputS16Swap,
+    // 32-bit floating-point, where 1.0 is full scale.
+    kVADPCMOutputF32,
+    // Add to an interleaved stereo 32-bit floating-point buffer.
+    kVADPCMOutputMixF32,
+    // Add to an interleaved stereo 32-bit integer buffer.
+    kVADPCMOutputMixS32,
+} vadpcm_output;
+
+// Range of a scaled sample added to a 32-bit integer mix. Samples outside the
+// range saturate, so every kernel gives the same result. The maximum is the
+// largest float below 2^31.
+#define VADPCM_MIX_S32_MIN (-2147483648.0f)
+#define VADPCM_MIX_S32_MAX 2147483520.0f
+
+// Portable decoder. Same interface as vadpcm_decode().
+vadpcm_error vadpcm_decode_scalar(int predictor_count, int order,
+                                  const struct vadpcm_vector *restrict codebook,
+                                  struct vadpcm_vector *restrict state,
+                                  size_t frame_count, int16_t *restrict dest,
+                                  const void *restrict src);
+
+// Portable decoder which unpacks residuals with 64-bit integer operations
+// (SIMD within a register). Same interface as vadpcm_decode().
+vadpcm_error vadpcm_decode_swar(int predictor_count, int order,
+                                const struct vadpcm_vector *restrict codebook,
+                                struct vadpcm_vector *restrict state,
+                                size_t frame_count, int16_t *restrict dest,
+                                const void *restrict src);
+
+// Portable decoders for input which has been checked with vadpcm_validate().
+// Same interface as vadpcm_decode_trusted().
+void vadpcm_decode_trusted_scalar(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+void vadpcm_decode_trusted_swar(int predictor_count, int order,
+                                const struct vadpcm_vector *restrict codebook,
+                                struct vadpcm_vector *restrict state,
+                                size_t frame_count, int16_t *restrict dest,
+                                const void *restrict src);
+
+// Return the index of the first frame with a predictor index which is not
+// less than predictor_count, or frame_count if all frames are valid. The
+// predictor count must be 1..kVADPCMMaxPredictorCount. If validation is not
+// NULL, every frame is checked, and the histograms are incremented. The
+// invalid_frame field is not used.
+size_t vadpcm_validate_scalar(int predictor_count, size_t frame_count,
+                              const void *restrict src,
+                              struct vadpcm_validation *restrict validation);
+
+// Fill in the prediction matrix for one predictor, which is 16 vectors.
+void vadpcm_predictor_matrix(struct vadpcm_vector *restrict matrix, int order,
+                             const struct vadpcm_vector *restrict predictor);
+
+// Fill in a prepared codebook without checking the parameters. Predictor
+// counts above the maximum are truncated.
+void vadpcm_decoder_init(struct vadpcm_decoder *restrict decoder,
+                         int predictor_count, int order,
+                         const struct vadpcm_vector *restrict codebook);
+
+// Decode frames, discarding the output, to advance the decoder state. Frames
+// after an error are still decoded, and the last error is returned.
+vadpcm_error vadpcm_skip(const struct vadpcm_decoder *restrict decoder,
+                         struct vadpcm_vector *restrict state,
+                         size_t frame_count, const void *restrict src);
+
+// Portable decoder. Same interface as vadpcm_decoder_decode().
+vadpcm_error vadpcm_decoder_decode_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+
+// Portable SWAR decoder. Same interface as vadpcm_decoder_decode().
+vadpcm_error vadpcm_decoder_decode_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+
+// Portable decoders with byte-swapped output.
+vadpcm_error vadpcm_decoder_decode_swap_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+vadpcm_error vadpcm_decoder_decode_swap_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+
+// Portable decoders with floating-point output.
+vadpcm_error vadpcm_decoder_decode_f32_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src);
+vadpcm_error vadpcm_decoder_decode_f32_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src);
+
+// Portable mixing kernels. Each decoded sample is multiplied by the left and
+// right gains and added to an interleaved stereo buffer, which has
+// 2 * frame_count * kVADPCMFrameSampleCount elements. The integer kernel rounds
+// each product to the nearest integer before adding it.
+vadpcm_error vadpcm_decoder_mix_f32_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right);
+vadpcm_error vadpcm_decoder_mix_s32_scalar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right);
+vadpcm_error vadpcm_decoder_mix_f32_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right);
+vadpcm_error vadpcm_decoder_mix_s32_swar(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right);
+
+// Portable interleaved decoders. Same interface as the decode_interleaved
+// kernel.
+vadpcm_error vadpcm_decode_interleaved_scalar(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest);
+vadpcm_error vadpcm_decode_interleaved_swar(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest);
+
+#if VADPCM_X86
+// SSE2 decoder. Same interface as vadpcm_decode(). Uses SSSE3 to unpack the
+// residuals if it is enabled at compile time.
+vadpcm_error vadpcm_decode_sse2(int predictor_count, int order,
+                                const struct vadpcm_vector *restrict codebook,
+                                struct vadpcm_vector *restrict state,
+                                size_t frame_count, int16_t *restrict dest,
+                                const void *restrict src);
+
+// SSE2 decoder for trusted input. Same interface as vadpcm_decode_trusted().
+void vadpcm_decode_trusted_sse2(int predictor_count, int order,
+                                const struct vadpcm_vector *restrict codebook,
+                                struct vadpcm_vector *restrict state,
+                                size_t frame_count, int16_t *restrict dest,
+                                const void *restrict src);
+
+// SSE2 version of vadpcm_validate_scalar(). Checks 16 frames at a time.
+size_t vadpcm_validate_sse2(int predictor_count, size_t frame_count,
+                            const void *restrict src,
+                            struct vadpcm_validation *restrict validation);
+
+// SSE2 decoder. Same interface as vadpcm_decoder_decode().
+vadpcm_error vadpcm_decoder_decode_sse2(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+
+// SSE2 decoder with byte-swapped output.
+vadpcm_error vadpcm_decoder_decode_swap_sse2(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+
+// SSE2 decoder with floating-point output.
+vadpcm_error vadpcm_decoder_decode_f32_sse2(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src);
+
+// SSE2 mixing kernels. Same interface as the portable mixing kernels.
+vadpcm_error vadpcm_decoder_mix_f32_sse2(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right);
+vadpcm_error vadpcm_decoder_mix_s32_sse2(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right);
+
+// SSE2 interleaved decoder. Each pair of channels is decoded together and
+// interleaved in registers.
+vadpcm_error vadpcm_decode_interleaved_sse2(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest);
+
+// SSSE3 versions of the SSE2 decoders. These are compiled from the same code,
+// but unpack the residuals with PSHUFB.
+vadpcm_error vadpcm_decode_ssse3(int predictor_count, int order,
+                                 const struct vadpcm_vector *restrict codebook,
+                                 struct vadpcm_vector *restrict state,
+                                 size_t frame_count, int16_t *restrict dest,
+                                 const void *restrict src);
+void vadpcm_decode_trusted_ssse3(int predictor_count, int order,
+                                 const struct vadpcm_vector *restrict codebook,
+                                 struct vadpcm_vector *restrict state,
+                                 size_t frame_count, int16_t *restrict dest,
+                                 const void *restrict src);
+vadpcm_error vadpcm_decoder_decode_ssse3(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+vadpcm_error vadpcm_decoder_decode_swap_ssse3(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src);
+vadpcm_error vadpcm_decoder_decode_f32_ssse3(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src);
+vadpcm_error vadpcm_decoder_mix_f32_ssse3(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right);
+vadpcm_error vadpcm_decoder_mix_s32_ssse3(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right);
+vadpcm_error vadpcm_decode_interleaved_ssse3(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest);
+
+// AVX2 implementation of vadpcm_decode_multi(). Decodes two streams at a time,
+// one in each 128-bit lane.
+vadpcm_error vadpcm_decode_multi_avx2(size_t job_count,
+                                      struct vadpcm_decode_job *restrict jobs);
+
+// AVX2 interleaved decoder. Decodes each pair of channels in the two 128-bit
+// lanes.
+vadpcm_error vadpcm_decode_interleaved_avx2(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest);
+#endif
@@ -0,0 +1,312 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+
+#include "codec/vadpcm.h"
+
+#if VADPCM_X86
+
+#include <immintrin.h>
+#include <stdbool.h>
+#include <string.h>
+
+// This decodes two independent streams at the same time, one in each 128-bit
+// lane. The calculation in each lane is the same as vadpcm_decode_frame_sse2().
+// See decode.h for a description of the matrix layout.
+
+// Multiply elements 2p and 2p+1 of the input vector x by the corresponding
+// pair of matrix columns, and add the result to the accumulators lo and hi.
+// The matrix for the low lane is m0, and the matrix for the high lane is m1.
+#define VADPCM_MADD2(lo, hi, x, m0, m1, p)                                   \
+    do {                                                                     \
+        __m256i pair_ = _mm256_shuffle_epi32(x, (p) * 0x55);                 \
+        lo = _mm256_add_epi32(                                               \
+            lo, _mm256_madd_epi16(pair_, vadpcm_load2((m0) + 2 * (p),        \
+                                                      (m1) + 2 * (p))));     \
+        hi = _mm256_add_epi32(                                               \
+            hi, _mm256_madd_epi16(pair_, vadpcm_load2((m0) + 2 * (p) + 1,    \
+                                                      (m1) + 2 * (p) + 1))); \
+    } while (0)
+
+// Combine two 128-bit vectors into one 256-bit vector.
+VADPCM_TARGET("avx2")
+static inline __m256i vadpcm_combine(__m128i lo, __m128i hi) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+// Load one vector into each 128-bit lane.
+VADPCM_TARGET("avx2")
+static inline __m256i vadpcm_load2(const struct vadpcm_vector *lo,
+                                   const struct vadpcm_vector *hi) {
+    return vadpcm_combine(_mm_load_si128((const __m128i *)lo->v),
+                          _mm_load_si128((const __m128i *)hi->v));
+}
+
+// A stream assigned to one lane.
+struct vadpcm_lane {
+    struct vadpcm_decode_job *job;
+    size_t frame;
+    uint32_t invalid;
+};
+
+// Store vectors of samples from two channels, a and b, as interleaved pairs,
+// with stride samples from one pair to the next.
+VADPCM_TARGET("avx2")
+static inline void vadpcm_store_pairs_avx2(int16_t *restrict dest,
+                                           size_t stride, __m128i a,
+                                           __m128i b) {
+    __m128i pairs[2] = {_mm_unpacklo_epi16(a, b), _mm_unpackhi_epi16(a, b)};
+    if (stride == 2) {
+        _mm256_storeu_si256((__m256i *)dest,
+                            vadpcm_combine(pairs[0], pairs[1]));
+        return;
+    }
+    for (int h = 0; h < 2; h++) {
+        __m128i x = pairs[h];
+        for (int i = 0; i < 4; i++) {
+            int32_t pair = _mm_cvtsi128_si32(x);
+            memcpy(dest + stride * (4 * h + i), &pair, sizeof(pair));
+            x = _mm_srli_si128(x, 4);
+        }
+    }
+}
+
+// Decode frame_count frames from two streams, one in each lane, starting with
+// the previous output vector out. Returns the last output vector. If stride is
+// zero, each stream is written to its own output array. Otherwise, the streams
+// are written to dest[0] as interleaved pairs, with stride samples from one
+// pair to the next. Invalid predictors are accumulated into invalid_out.
+VADPCM_TARGET("avx2")
+static VADPCM_ALWAYS_INLINE __m256i vadpcm_decode2_impl_avx2(
+    const struct vadpcm_decoder *const *decoder, const uint8_t *const *src,
+    int16_t *const *dest, size_t stride, __m256i out, size_t frame_count,
+    uint32_t *restrict invalid_out) {
+    // The state columns before this pair are all zero, in both lanes.
+    int order = decoder[0]->order > decoder[1]->order ? decoder[0]->order
+                                                       : decoder[1]->order;
+    int first_pair = (8 - order) >> 1;
+    uint32_t invalid[2] = {0, 0};
+    const __m256i shuffle0 =
+        _mm256_setr_epi8(-1, 0, -1, 0, -1, 1, -1, 1, //
+                         -1, 2, -1, 2, -1, 3, -1, 3, //
+                         -1, 0, -1, 0, -1, 1, -1, 1, //
+                         -1, 2, -1, 2, -1, 3, -1, 3);
+    const __m256i shuffle1 =
+        _mm256_setr_epi8(-1, 4, -1, 4, -1, 5, -1, 5, //
+                         -1, 6, -1, 6, -1, 7, -1, 7, //
+                         -1, 4, -1, 4, -1, 5, -1, 5, //
+                         -1, 6, -1, 6, -1, 7, -1, 7);
+    // Multiplying by 16 moves the low nibble into the top four bits.
+    const __m256i nibble_shift = _mm256_setr_epi16(
+        1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16);
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        const uint8_t *fin[2];
+        const struct vadpcm_vector *matrix[2];
+        int scaling[2];
+        for (int k = 0; k < 2; k++) {
+            fin[k] = src[k] + kVADPCMFrameByteSize * frame;
+            int control = fin[k][0];
+            int predictor_index = control & 15;
+            scaling[k] = control >> 4;
+            invalid[k] |= ~decoder[k]->valid_mask >> predictor_index;
+            matrix[k] = decoder[k]->matrix[predictor_index];
+        }
+        const struct vadpcm_vector *m0 = matrix[0], *m1 = matrix[1];
+        __m256i shift = vadpcm_combine(_mm_set1_epi32(scaling[0]),
+                                       _mm_set1_epi32(scaling[1]));
+
+        // Move each 4-bit residual into the high bits of a 16-bit lane.
+        __m256i bytes =
+            vadpcm_combine(_mm_loadl_epi64((const __m128i *)(fin[0] + 1)),
+                           _mm_loadl_epi64((const __m128i *)(fin[1] + 1)));
+        __m256i rvec[2];
+        rvec[0] = _mm256_shuffle_epi8(bytes, shuffle0);
+        rvec[1] = _mm256_shuffle_epi8(bytes, shuffle1);
+
+        for (int vector = 0; vector < 2; vector++) {
+            // Sign-extend the residuals.
+            __m256i residual = _mm256_srai_epi16(
+                _mm256_mullo_epi16(rvec[vector], nibble_shift), 12);
+
+            // Contribution from the residuals, before scaling.
+            __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+            VADPCM_MADD2(lo, hi, residual, m0 + 8, m1 + 8, 0);
+            VADPCM_MADD2(lo, hi, residual, m0 + 8, m1 + 8, 1);
+            VADPCM_MADD2(lo, hi, residual, m0 + 8, m1 + 8, 2);
+            VADPCM_MADD2(lo, hi, residual, m0 + 8, m1 + 8, 3);
+            lo = _mm256_sllv_epi32(lo, shift);
+            hi = _mm256_sllv_epi32(hi, shift);
+
+            // Contribution from the previous vector.
+            switch (first_pair) {
+            case 0:
+                VADPCM_MADD2(lo, hi, out, m0, m1, 0);
+                // fall through
+            case 1:
+                VADPCM_MADD2(lo, hi, out, m0, m1, 1);
+                // fall through
+            case 2:
+                VADPCM_MADD2(lo, hi, out, m0, m1, 2);
+                // fall through
+            case 3:
+                VADPCM_MADD2(lo, hi, out, m0, m1, 3);
+                break;
+            }
+
+            // Discard fractional part and clamp to 16-bit range.
+            out = _mm256_packs_epi32(_mm256_srai_epi32(lo, 11),
+                                     _mm256_srai_epi32(hi, 11));
+            size_t offset = kVADPCMFrameSampleCount * frame + 8 * vector;
+            if (stride == 0) {
+                _mm_storeu_si128((__m128i *)(dest[0] + offset),
+                                 _mm256_castsi256_si128(out));
+                _mm_storeu_si128((__m128i *)(dest[1] + offset),
+                                 _mm256_extracti128_si256(out, 1));
+            } else {
+                vadpcm_store_pairs_avx2(dest[0] + stride * offset, stride,
+                                        _mm256_castsi256_si128(out),
+                                        _mm256_extracti128_si256(out, 1));
+            }
+        }
+    }
+    for (int k = 0; k < 2; k++) {
+        invalid_out[k] |= invalid[k];
+    }
+    return out;
+}
+
+// Decode frame_count frames from the two streams in the lanes, starting at
+// each lane's current position. Returns the last output vector.
+VADPCM_TARGET("avx2")
+static __m256i vadpcm_decode2_avx2(struct vadpcm_lane *restrict lanes,
+                                   __m256i out, size_t frame_count) {
+    const struct vadpcm_decoder *decoder[2];
+    const uint8_t *src[2];
+    int16_t *dest[2];
+    for (int k = 0; k < 2; k++) {
+        const struct vadpcm_decode_job *job = lanes[k].job;
+        decoder[k] = job->decoder;
+        src[k] = (const uint8_t *)job->src +
+                 kVADPCMFrameByteSize * lanes[k].frame;
+        dest[k] = job->dest + kVADPCMFrameSampleCount * lanes[k].frame;
+    }
+    uint32_t invalid[2] = {0, 0};
+    out = vadpcm_decode2_impl_avx2(decoder, src, dest, 0, out, frame_count,
+                                   invalid);
+    for (int k = 0; k < 2; k++) {
+        lanes[k].frame += frame_count;
+        lanes[k].invalid |= invalid[k];
+    }
+    return out;
+}
+
+// Store the result for a lane's job.
+static bool vadpcm_lane_finish(struct vadpcm_lane *restrict lane) {
+    bool is_invalid = (lane->invalid & 1) != 0;
+    lane->job->error = is_invalid ? kVADPCMErrInvalidData : 0;
+    lane->job = NULL;
+    return is_invalid;
+}
+
+VADPCM_TARGET("avx2")
+vadpcm_error vadpcm_decode_multi_avx2(size_t job_count,
+                                      struct vadpcm_decode_job *restrict jobs) {
+    // Each lane decodes one job at a time. When a lane finishes its job, it
+    // picks up the next job, so both lanes stay busy until the jobs run out.
+    struct vadpcm_lane lanes[2] = {{NULL, 0, 0}, {NULL, 0, 0}};
+    __m128i state[2] = {_mm_setzero_si128(), _mm_setzero_si128()};
+    size_t next_job = 0;
+    bool any_invalid = false;
+    for (;;) {
+        for (int k = 0; k < 2; k++) {
+            while (lanes[k].job == NULL && next_job < job_count) {
+                struct vadpcm_decode_job *job = &jobs[next_job++];
+                if (job->frame_count == 0) {
+                    job->error = 0;
+                    continue;
+                }
+                lanes[k] = (struct vadpcm_lane){job, 0, 0};
+                state[k] = _mm_load_si128((const __m128i *)job->state->v);
+            }
+        }
+        if (lanes[0].job == NULL || lanes[1].job == NULL) {
+            break;
+        }
+        size_t remaining0 = lanes[0].job->frame_count - lanes[0].frame;
+        size_t remaining1 = lanes[1].job->frame_count - lanes[1].frame;
+        size_t frame_count = remaining0 < remaining1 ? remaining0 : remaining1;
+        __m256i out = vadpcm_decode2_avx2(
+            lanes, vadpcm_combine(state[0], state[1]), frame_count);
+        state[0] = _mm256_castsi256_si128(out);
+        state[1] = _mm256_extracti128_si256(out, 1);
+        for (int k = 0; k < 2; k++) {
+            if (lanes[k].frame == lanes[k].job->frame_count) {
+                _mm_store_si128((__m128i *)lanes[k].job->state->v, state[k]);
+                any_invalid |= vadpcm_lane_finish(&lanes[k]);
+            }
+        }
+    }
+
+    // At most one job is left. Finish it by itself.
+    for (int k = 0; k < 2; k++) {
+        struct vadpcm_lane *restrict lane = &lanes[k];
+        struct vadpcm_decode_job *job = lane->job;
+        if (job == NULL) {
+            continue;
+        }
+        _mm_store_si128((__m128i *)job->state->v, state[k]);
+        vadpcm_error err = vadpcm_decoder_decode_sse2(
+            job->decoder, job->state, job->frame_count - lane->frame,
+            job->dest + kVADPCMFrameSampleCount * lane->frame,
+            (const uint8_t *)job->src + kVADPCMFrameByteSize * lane->frame);
+        if (err != 0) {
+            lane->invalid = 1;
+        }
+        any_invalid |= vadpcm_lane_finish(lane);
+    }
+    return any_invalid ? kVADPCMErrInvalidData : 0;
+}
+
+VADPCM_TARGET("avx2")
+vadpcm_error vadpcm_decode_interleaved_avx2(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest) {
+    bool any_invalid = false;
+    size_t c = 0;
+    for (; c + 2 <= channel_count; c += 2) {
+        const struct vadpcm_decoder *decoder[2];
+        const uint8_t *src[2];
+        __m128i state[2];
+        for (int k = 0; k < 2; k++) {
+            decoder[k] = channels[c + k].decoder;
+            src[k] = channels[c + k].src;
+            state[k] =
+                _mm_load_si128((const __m128i *)channels[c + k].state->v);
+        }
+        int16_t *pair_dest[2] = {dest + c, NULL};
+        uint32_t invalid[2] = {0, 0};
+        __m256i out = vadpcm_decode2_impl_avx2(
+            decoder, src, pair_dest, stride, vadpcm_combine(state[0], state[1]),
+            frame_count, invalid);
+        _mm_store_si128((__m128i *)channels[c].state->v,
+                        _mm256_castsi256_si128(out));
+        _mm_store_si128((__m128i *)channels[c + 1].state->v,
+                        _mm256_extracti128_si256(out, 1));
+        for (int k = 0; k < 2; k++) {
+            bool is_invalid = (invalid[k] & 1) != 0;
+            channels[c + k].error = is_invalid ? kVADPCMErrInvalidData : 0;
+            any_invalid |= is_invalid;
+        }
+    }
+
+    // A final odd channel is decoded by itself.
+    if (c < channel_count &&
+        vadpcm_decode_interleaved_sse2(1, &channels[c], frame_count, stride,
+                                       dest + c) != 0) {
+        any_invalid = true;
+    }
+    return any_invalid ? kVADPCMErrInvalidData : 0;
+}
+
+#endif // VADPCM_X86
@@ -0,0 +1,396 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+
+#include "codec/vadpcm.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#if VADPCM_X86
+
+// This file is also compiled by decode_ssse3.c, which defines these macros to
+// make a second copy of the kernels that unpacks the residuals with PSHUFB.
+#ifndef VADPCM_SSE_SSSE3
+#define VADPCM_SSE_SSSE3 0
+#define VADPCM_SSE_TARGET "sse2"
+#define VADPCM_SSE_NAME(name) name##_sse2
+#endif
+
+#include <emmintrin.h>
+#if VADPCM_SSE_SSSE3
+#include <tmmintrin.h>
+#endif
+
+// See decode.h for a description of the matrix layout.
+
+// Multiply elements 2p and 2p+1 of the input vector x by the corresponding
+// pair of matrix columns, and add the result to the accumulators lo and hi.
+#define VADPCM_MADD(lo, hi, x, matrix, p)                                    \
+    do {                                                                     \
+        __m128i pair_ = _mm_shuffle_epi32(x, (p) * 0x55);                    \
+        const __m128i *col_ = (const __m128i *)(matrix)[2 * (p)].v;          \
+        lo = _mm_add_epi32(lo, _mm_madd_epi16(pair_, _mm_load_si128(col_))); \
+        hi = _mm_add_epi32(hi,                                               \
+                           _mm_madd_epi16(pair_, _mm_load_si128(col_ + 1))); \
+    } while (0)
+
+// Decode one frame, given the previous output vector. Returns the last output
+// vector. The samples are converted to the output format in registers, before
+// they are stored. When mixing, gain contains the left and right gains, twice.
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+static VADPCM_ALWAYS_INLINE __m128i vadpcm_decode_frame_sse2(
+    const struct vadpcm_vector *restrict matrix, int first_pair, __m128i out,
+    void *restrict dest, const uint8_t *restrict fin, vadpcm_output output,
+    __m128 gain) {
+    // Multiplying by 16 moves the low nibble into the top four bits.
+    const __m128i nibble_shift = _mm_setr_epi16(1, 16, 1, 16, 1, 16, 1, 16);
+    __m128i scaling = _mm_cvtsi32_si128(fin[0] >> 4);
+
+    // Move each 4-bit residual into the high bits of a 16-bit lane.
+    __m128i bytes = _mm_loadl_epi64((const __m128i *)(fin + 1));
+    __m128i rvec[2];
+#if VADPCM_SSE_SSSE3
+    rvec[0] = _mm_shuffle_epi8(
+        bytes, _mm_setr_epi8(-1, 0, -1, 0, -1, 1, -1, 1, //
+                             -1, 2, -1, 2, -1, 3, -1, 3));
+    rvec[1] = _mm_shuffle_epi8(
+        bytes, _mm_setr_epi8(-1, 4, -1, 4, -1, 5, -1, 5, //
+                             -1, 6, -1, 6, -1, 7, -1, 7));
+#else
+    const __m128i zero = _mm_setzero_si128();
+    bytes = _mm_unpacklo_epi8(bytes, bytes);
+    rvec[0] = _mm_unpacklo_epi8(zero, bytes);
+    rvec[1] = _mm_unpackhi_epi8(zero, bytes);
+#endif
+
+    for (int vector = 0; vector < 2; vector++) {
+        // Sign-extend the residuals.
+        __m128i residual =
+            _mm_srai_epi16(_mm_mullo_epi16(rvec[vector], nibble_shift), 12);
+
+        // Contribution from the residuals, before scaling.
+        __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+        VADPCM_MADD(lo, hi, residual, matrix + 8, 0);
+        VADPCM_MADD(lo, hi, residual, matrix + 8, 1);
+        VADPCM_MADD(lo, hi, residual, matrix + 8, 2);
+        VADPCM_MADD(lo, hi, residual, matrix + 8, 3);
+        lo = _mm_sll_epi32(lo, scaling);
+        hi = _mm_sll_epi32(hi, scaling);
+
+        // Contribution from the previous vector.
+        switch (first_pair) {
+        case 0:
+            VADPCM_MADD(lo, hi, out, matrix, 0);
+            // fall through
+        case 1:
+            VADPCM_MADD(lo, hi, out, matrix, 1);
+            // fall through
+        case 2:
+            VADPCM_MADD(lo, hi, out, matrix, 2);
+            // fall through
+        case 3:
+            VADPCM_MADD(lo, hi, out, matrix, 3);
+            break;
+        }
+
+        // Discard fractional part and clamp to 16-bit range.
+        out = _mm_packs_epi32(_mm_srai_epi32(lo, 11), _mm_srai_epi32(hi, 11));
+        // Convert to float for the floating-point and mixing outputs. This
+        // sign-extends to 32 bits by unpacking into the high half.
+        __m128 half[2] = {
+            _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(out, out), 16)),
+            _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(out, out), 16)),
+        };
+        switch (output) {
+        case kVADPCMOutputS16:
+            _mm_storeu_si128((__m128i *)((int16_t *)dest + 8 * vector), out);
+            break;
+        case kVADPCMOutputS16Swap:
+            _mm_storeu_si128(
+                (__m128i *)((int16_t *)dest + 8 * vector),
+                _mm_or_si128(_mm_slli_epi16(out, 8), _mm_srli_epi16(out, 8)));
+            break;
+        case kVADPCMOutputF32: {
+            const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+            float *fdest = (float *)dest + 8 * vector;
+            _mm_storeu_ps(fdest, _mm_mul_ps(half[0], scale));
+            _mm_storeu_ps(fdest + 4, _mm_mul_ps(half[1], scale));
+        } break;
+        case kVADPCMOutputMixF32:
+        case kVADPCMOutputMixS32: {
+            // Each sample is duplicated into a left and right lane, then
+            // multiplied by the gain and added to the mix.
+            __m128 stereo[4];
+            for (int h = 0; h < 2; h++) {
+                stereo[2 * h] =
+                    _mm_mul_ps(_mm_unpacklo_ps(half[h], half[h]), gain);
+                stereo[2 * h + 1] =
+                    _mm_mul_ps(_mm_unpackhi_ps(half[h], half[h]), gain);
+            }
+            if (output == kVADPCMOutputMixF32) {
+                float *mix = (float *)dest + 16 * vector;
+                for (int i = 0; i < 4; i++) {
+                    _mm_storeu_ps(mix + 4 * i,
+                                  _mm_add_ps(_mm_loadu_ps(mix + 4 * i),
+                                             stereo[i]));
+                }
+            } else {
+                // Out of range, the conversion gives INT32_MIN, so clamp
+                // first. NaN is converted to the minimum, like the scalar
+                // kernel.
+                int32_t *mix = (int32_t *)dest + 16 * vector;
+                const __m128 lo = _mm_set1_ps(VADPCM_MIX_S32_MIN);
+                const __m128 hi = _mm_set1_ps(VADPCM_MIX_S32_MAX);
+                for (int i = 0; i < 4; i++) {
+                    __m128i *ptr = (__m128i *)(mix + 4 * i);
+                    __m128 x = _mm_min_ps(_mm_max_ps(stereo[i], lo), hi);
+                    _mm_storeu_si128(ptr, _mm_add_epi32(_mm_loadu_si128(ptr),
+                                                        _mm_cvtps_epi32(x)));
+                }
+            }
+        } break;
+        }
+    }
+    return out;
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+static VADPCM_ALWAYS_INLINE vadpcm_error vadpcm_decode_impl_sse2(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src, bool trusted) {
+    if (frame_count == 0) {
+        return 0;
+    }
+    // Matrixes are only filled in for predictors when they are first used,
+    // rather than preparing the whole codebook, which can take longer than
+    // decoding a short run of frames.
+    struct vadpcm_vector matrix[kVADPCMMaxPredictorCount][16];
+    uint32_t ready = 0;
+    // The state columns before this pair are all zero.
+    int first_pair = (8 - order) >> 1;
+    __m128i out = _mm_load_si128((const __m128i *)state->v);
+    const uint8_t *sptr = src;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        const uint8_t *fin = sptr + kVADPCMFrameByteSize * frame;
+        int predictor_index = fin[0] & 15;
+        if ((ready & (1u << predictor_index)) == 0) {
+            // Unused predictors have a zero matrix, so trusted input does not
+            // need to be checked.
+            if (predictor_index < predictor_count) {
+                vadpcm_predictor_matrix(matrix[predictor_index], order,
+                                        codebook + order * predictor_index);
+            } else if (trusted) {
+                memset(matrix[predictor_index], 0,
+                       sizeof(matrix[predictor_index]));
+            } else {
+                _mm_store_si128((__m128i *)state->v, out);
+                return kVADPCMErrInvalidData;
+            }
+            ready |= 1u << predictor_index;
+        }
+        out = vadpcm_decode_frame_sse2(matrix[predictor_index],
+                                       first_pair, out,
+                                       dest + kVADPCMFrameSampleCount * frame,
+                                       fin, kVADPCMOutputS16, _mm_setzero_ps());
+    }
+    _mm_store_si128((__m128i *)state->v, out);
+    return 0;
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decode)(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decode_impl_sse2(predictor_count, order, codebook, state,
+                                   frame_count, dest, src, false);
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+void VADPCM_SSE_NAME(vadpcm_decode_trusted)(
+    int predictor_count, int order,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    vadpcm_decode_impl_sse2(predictor_count, order, codebook, state,
+                            frame_count, dest, src, true);
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+static VADPCM_ALWAYS_INLINE vadpcm_error vadpcm_decoder_decode_impl_sse2(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    void *restrict dest, const void *restrict src, vadpcm_output output,
+    __m128 gain) {
+    int first_pair = (8 - decoder->order) >> 1;
+    uint32_t invalid = 0;
+    __m128i out = _mm_load_si128((const __m128i *)state->v);
+    const uint8_t *sptr = src;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        const uint8_t *fin = sptr + kVADPCMFrameByteSize * frame;
+        // Invalid predictors have a zero matrix, so there is no need to stop
+        // early.
+        int predictor_index = fin[0] & 15;
+        invalid |= ~decoder->valid_mask >> predictor_index;
+        size_t offset = kVADPCMFrameSampleCount * frame;
+        void *fdest;
+        switch (output) {
+        case kVADPCMOutputS16:
+        case kVADPCMOutputS16Swap:
+            fdest = (int16_t *)dest + offset;
+            break;
+        case kVADPCMOutputF32:
+            fdest = (float *)dest + offset;
+            break;
+        default:
+            // Stereo, with 32-bit samples.
+            fdest = (float *)dest + 2 * offset;
+            break;
+        }
+        out = vadpcm_decode_frame_sse2(decoder->matrix[predictor_index],
+                                       first_pair, out, fdest, fin, output,
+                                       gain);
+    }
+    _mm_store_si128((__m128i *)state->v, out);
+    return (invalid & 1) != 0 ? kVADPCMErrInvalidData : 0;
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decoder_decode)(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl_sse2(decoder, state, frame_count, dest,
+                                           src, kVADPCMOutputS16,
+                                           _mm_setzero_ps());
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decoder_decode_swap)(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int16_t *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl_sse2(decoder, state, frame_count, dest,
+                                           src, kVADPCMOutputS16Swap,
+                                           _mm_setzero_ps());
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decoder_decode_f32)(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src) {
+    return vadpcm_decoder_decode_impl_sse2(decoder, state, frame_count, dest,
+                                           src, kVADPCMOutputF32,
+                                           _mm_setzero_ps());
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decoder_mix_f32)(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    float *restrict dest, const void *restrict src, float left, float right) {
+    return vadpcm_decoder_decode_impl_sse2(
+        decoder, state, frame_count, dest, src, kVADPCMOutputMixF32,
+        _mm_setr_ps(left, right, left, right));
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decoder_mix_s32)(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    int32_t *restrict dest, const void *restrict src, float left,
+    float right) {
+    return vadpcm_decoder_decode_impl_sse2(
+        decoder, state, frame_count, dest, src, kVADPCMOutputMixS32,
+        _mm_setr_ps(left, right, left, right));
+}
+
+// Store vectors of samples from two channels, a and b, as interleaved pairs,
+// with stride samples from one pair to the next.
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+static inline void vadpcm_store_pairs_sse2(int16_t *restrict dest,
+                                           size_t stride, __m128i a,
+                                           __m128i b) {
+    __m128i pairs[2] = {_mm_unpacklo_epi16(a, b), _mm_unpackhi_epi16(a, b)};
+    if (stride == 2) {
+        _mm_storeu_si128((__m128i *)dest, pairs[0]);
+        _mm_storeu_si128((__m128i *)dest + 1, pairs[1]);
+        return;
+    }
+    for (int h = 0; h < 2; h++) {
+        __m128i x = pairs[h];
+        for (int i = 0; i < 4; i++) {
+            int32_t pair = _mm_cvtsi128_si32(x);
+            memcpy(dest + stride * (4 * h + i), &pair, sizeof(pair));
+            x = _mm_srli_si128(x, 4);
+        }
+    }
+}
+
+VADPCM_TARGET(VADPCM_SSE_TARGET)
+vadpcm_error VADPCM_SSE_NAME(vadpcm_decode_interleaved)(
+    size_t channel_count, struct vadpcm_channel *restrict channels,
+    size_t frame_count, size_t stride, int16_t *restrict dest) {
+    bool any_invalid = false;
+    for (size_t c = 0; c < channel_count; c += 2) {
+        // Decode the channels in pairs, and a final odd channel by itself. The
+        // two channels in a pair are independent, so their frames can be
+        // decoded in parallel by the CPU.
+        int count = channel_count - c < 2 ? 1 : 2;
+        const struct vadpcm_decoder *decoder[2];
+        const uint8_t *src[2];
+        int first_pair[2];
+        uint32_t invalid[2] = {0, 0};
+        __m128i out[2];
+        for (int k = 0; k < count; k++) {
+            decoder[k] = channels[c + k].decoder;
+            src[k] = channels[c + k].src;
+            first_pair[k] = (8 - decoder[k]->order) >> 1;
+            out[k] = _mm_load_si128((const __m128i *)channels[c + k].state->v);
+        }
+        for (size_t frame = 0; frame < frame_count; frame++) {
+            __m128i samples[2][2];
+            for (int k = 0; k < count; k++) {
+                const uint8_t *fin = src[k] + kVADPCMFrameByteSize * frame;
+                // Invalid predictors have a zero matrix, so there is no need
+                // to stop early.
+                int predictor_index = fin[0] & 15;
+                invalid[k] |= ~decoder[k]->valid_mask >> predictor_index;
+                out[k] = vadpcm_decode_frame_sse2(
+                    decoder[k]->matrix[predictor_index], first_pair[k],
+                    out[k], samples[k], fin, kVADPCMOutputS16,
+                    _mm_setzero_ps());
+            }
+            int16_t *fdest =
+                dest + stride * kVADPCMFrameSampleCount * frame + c;
+            if (count == 2) {
+                for (int vector = 0; vector < 2; vector++) {
+                    vadpcm_store_pairs_sse2(fdest + stride * 8 * vector, stride,
+                                            samples[0][vector],
+                                            samples[1][vector]);
+                }
+            } else {
+                const int16_t *mono = (const int16_t *)samples[0];
+                for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+                    fdest[stride * i] = mono[i];
+                }
+            }
+        }
+        for (int k = 0; k < count; k++) {
+            struct vadpcm_channel *restrict channel = &channels[c + k];
+            _mm_store_si128((__m128i *)channel->state->v, out[k]);
+            bool is_invalid = (invalid[k] & 1) != 0;
+            channel->error = is_invalid ? kVADPCMErrInvalidData : 0;
+            any_invalid |= is_invalid;
+        }
+    }
+    return any_invalid ? kVADPCMErrInvalidData : 0;
+}
+
+#endif // VADPCM_X86
@@ -0,0 +1,12 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+
+// The SSE2 decoder kernels, compiled again for SSSE3 so the residuals can be
+// unpacked with PSHUFB. This needs a separate copy, because a function compiled
+// for SSE2 cannot inline SSSE3 instructions.
+#define VADPCM_SSE_SSSE3 1
+#define VADPCM_SSE_TARGET "ssse3"
+#define VADPCM_SSE_NAME(name) name##_ssse3
+
+#include "codec/decode_sse2.c"
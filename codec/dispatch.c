@@ -0,0 +1,252 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/dispatch.h"
+
+#include "codec/alist_kernels.h"
+#include "codec/autocorr.h"
+#include "codec/decode.h"
+#include "codec/encode.h"
+#include "codec/resample.h"
+#include "codec/vadpcm.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+// getenv is not deprecated.
+#pragma warning(disable : 4996)
+#endif
+
+static const struct vadpcm_kernels kVADPCMKernels[] = {
+    [kVADPCMISAScalar] =
+        {
+            .decode = vadpcm_decode_scalar,
+            .decode_trusted = vadpcm_decode_trusted_scalar,
+            .validate = vadpcm_validate_scalar,
+            .decoder_decode = vadpcm_decoder_decode_scalar,
+            .decoder_decode_swap = vadpcm_decoder_decode_swap_scalar,
+            .decoder_decode_f32 = vadpcm_decoder_decode_f32_scalar,
+            .decoder_mix_f32 = vadpcm_decoder_mix_f32_scalar,
+            .decoder_mix_s32 = vadpcm_decoder_mix_s32_scalar,
+            .decode_interleaved = vadpcm_decode_interleaved_scalar,
+            .resample = vadpcm_resample_scalar,
+            .autocorr = vadpcm_autocorr_scalar,
+            .encode_data = vadpcm_encode_data_scalar,
+            .alist_mix = vadpcm_alist_mix_scalar,
+            .alist_mix_gains = vadpcm_alist_mix_gains_scalar,
+            .alist_interleave = vadpcm_alist_interleave_scalar,
+        },
+    [kVADPCMISASWAR] =
+        {
+            .decode = vadpcm_decode_swar,
+            .decode_trusted = vadpcm_decode_trusted_swar,
+            .validate = vadpcm_validate_scalar,
+            .decoder_decode = vadpcm_decoder_decode_swar,
+            .decoder_decode_swap = vadpcm_decoder_decode_swap_swar,
+            .decoder_decode_f32 = vadpcm_decoder_decode_f32_swar,
+            .decoder_mix_f32 = vadpcm_decoder_mix_f32_swar,
+            .decoder_mix_s32 = vadpcm_decoder_mix_s32_swar,
+            .decode_interleaved = vadpcm_decode_interleaved_swar,
+            .resample = vadpcm_resample_scalar,
+            .autocorr = vadpcm_autocorr_scalar,
+            .encode_data = vadpcm_encode_data_scalar,
+            .alist_mix = vadpcm_alist_mix_scalar,
+            .alist_mix_gains = vadpcm_alist_mix_gains_scalar,
+            .alist_interleave = vadpcm_alist_interleave_scalar,
+        },
+#if VADPCM_X86
+    [kVADPCMISASSE2] =
+        {
+            .decode = vadpcm_decode_sse2,
+            .decode_trusted = vadpcm_decode_trusted_sse2,
+            .validate = vadpcm_validate_sse2,
+            .decoder_decode = vadpcm_decoder_decode_sse2,
+            .decoder_decode_swap = vadpcm_decoder_decode_swap_sse2,
+            .decoder_decode_f32 = vadpcm_decoder_decode_f32_sse2,
+            .decoder_mix_f32 = vadpcm_decoder_mix_f32_sse2,
+            .decoder_mix_s32 = vadpcm_decoder_mix_s32_sse2,
+            .decode_interleaved = vadpcm_decode_interleaved_sse2,
+            .resample = vadpcm_resample_sse2,
+            .autocorr = vadpcm_autocorr_sse2,
+            .encode_data = vadpcm_encode_data_scalar,
+            .alist_mix = vadpcm_alist_mix_sse2,
+            .alist_mix_gains = vadpcm_alist_mix_gains_sse2,
+            .alist_interleave = vadpcm_alist_interleave_sse2,
+        },
+    [kVADPCMISASSE41] =
+        {
+            .decode = vadpcm_decode_ssse3,
+            .decode_trusted = vadpcm_decode_trusted_ssse3,
+            .validate = vadpcm_validate_sse2,
+            .decoder_decode = vadpcm_decoder_decode_ssse3,
+            .decoder_decode_swap = vadpcm_decoder_decode_swap_ssse3,
+            .decoder_decode_f32 = vadpcm_decoder_decode_f32_ssse3,
+            .decoder_mix_f32 = vadpcm_decoder_mix_f32_ssse3,
+            .decoder_mix_s32 = vadpcm_decoder_mix_s32_ssse3,
+            .decode_interleaved = vadpcm_decode_interleaved_ssse3,
+            .resample = vadpcm_resample_sse2,
+            .autocorr = vadpcm_autocorr_sse2,
+            .encode_data = vadpcm_encode_data_sse41,
+            .alist_mix = vadpcm_alist_mix_sse2,
+            .alist_mix_gains = vadpcm_alist_mix_gains_sse2,
+            .alist_interleave = vadpcm_alist_interleave_sse2,
+        },
+    [kVADPCMISAAVX2] =
+        {
+            .decode = vadpcm_decode_ssse3,
+            .decode_trusted = vadpcm_decode_trusted_ssse3,
+            .validate = vadpcm_validate_sse2,
+            .decoder_decode = vadpcm_decoder_decode_ssse3,
+            .decoder_decode_swap = vadpcm_decoder_decode_swap_ssse3,
+            .decoder_decode_f32 = vadpcm_decoder_decode_f32_ssse3,
+            .decoder_mix_f32 = vadpcm_decoder_mix_f32_ssse3,
+            .decoder_mix_s32 = vadpcm_decoder_mix_s32_ssse3,
+            .decode_multi = vadpcm_decode_multi_avx2,
+            .decode_interleaved = vadpcm_decode_interleaved_avx2,
+            .resample = vadpcm_resample_sse2,
+            .autocorr = vadpcm_autocorr_avx2,
+            .encode_data = vadpcm_encode_data_sse41,
+            .alist_mix = vadpcm_alist_mix_sse2,
+            .alist_mix_gains = vadpcm_alist_mix_gains_sse2,
+            .alist_interleave = vadpcm_alist_interleave_sse2,
+        },
+#endif
+};
+
+static const char kVADPCMISANames[][8] = {
+    [kVADPCMISAScalar] = "scalar",
+    [kVADPCMISASWAR] = "swar",
+    [kVADPCMISASSE2] = "sse2",
+    [kVADPCMISASSE41] = "sse4.1",
+    [kVADPCMISAAVX2] = "avx2",
+};
+
+enum {
+    kVADPCMISACount = sizeof(kVADPCMISANames) / sizeof(*kVADPCMISANames),
+};
+
+// The active instruction set, or -1 if it has not been chosen yet. Threads
+// that race to initialize this will all store the same value.
+static int vadpcm_active_isa = -1;
+
+static int vadpcm_load_isa(void) {
+#if __GNUC__
+    return __atomic_load_n(&vadpcm_active_isa, __ATOMIC_RELAXED);
+#else
+    return *(volatile int *)&vadpcm_active_isa;
+#endif
+}
+
+static void vadpcm_store_isa(int isa) {
+#if __GNUC__
+    __atomic_store_n(&vadpcm_active_isa, isa, __ATOMIC_RELAXED);
+#else
+    *(volatile int *)&vadpcm_active_isa = isa;
+#endif
+}
+
+vadpcm_isa vadpcm_cpu_isa(void) {
+#if VADPCM_X86
+#if __GNUC__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return kVADPCMISAAVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return kVADPCMISASSE41;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return kVADPCMISASSE2;
+    }
+#elif _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    if (max_leaf < 1) {
+        return kVADPCMISASWAR;
+    }
+    __cpuid(info, 1);
+    int ecx = info[2], edx = info[3];
+    bool sse2 = (edx & (1 << 26)) != 0;
+    bool sse41 = (ecx & (1 << 19)) != 0;
+    // AVX requires that the OS saves the YMM registers.
+    bool avx = (ecx & (1 << 27)) != 0 && (ecx & (1 << 28)) != 0 &&
+               (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (avx && max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    if (avx2) {
+        return kVADPCMISAAVX2;
+    }
+    if (sse41) {
+        return kVADPCMISASSE41;
+    }
+    if (sse2) {
+        return kVADPCMISASSE2;
+    }
+#endif
+#endif
+    return kVADPCMISASWAR;
+}
+
+// Return the instruction set to use when none is requested. This is the best
+// instruction set supported by the CPU, except that SWAR is only used when
+// requested, because it is not faster than the scalar code.
+static int vadpcm_default_isa(int cpu_isa) {
+    return cpu_isa == kVADPCMISASWAR ? kVADPCMISAScalar : cpu_isa;
+}
+
+// Choose the instruction set to use by default.
+static int vadpcm_init_isa(void) {
+    int cpu_isa = vadpcm_cpu_isa();
+    int isa = vadpcm_default_isa(cpu_isa);
+    const char *name = getenv("VADPCM_ISA");
+    if (name != NULL) {
+        for (int i = 0; i < kVADPCMISACount; i++) {
+            if (strcmp(name, kVADPCMISANames[i]) == 0) {
+                isa = i < cpu_isa ? i : cpu_isa;
+                break;
+            }
+        }
+    }
+    vadpcm_store_isa(isa);
+    return isa;
+}
+
+const char *vadpcm_isa_name(vadpcm_isa isa) {
+    if ((int)isa < 0 || kVADPCMISACount <= (int)isa) {
+        return NULL;
+    }
+    return kVADPCMISANames[isa];
+}
+
+vadpcm_isa vadpcm_get_isa(void) {
+    int isa = vadpcm_load_isa();
+    if (isa < 0) {
+        isa = vadpcm_init_isa();
+    }
+    return isa;
+}
+
+vadpcm_isa vadpcm_set_isa(vadpcm_isa isa) {
+    int cpu_isa = vadpcm_cpu_isa();
+    int new_isa;
+    if ((int)isa < 0 || kVADPCMISACount <= (int)isa) {
+        new_isa =
+            (int)isa < 0 ? kVADPCMISAScalar : vadpcm_default_isa(cpu_isa);
+    } else {
+        new_isa = (int)isa < cpu_isa ? (int)isa : cpu_isa;
+    }
+    vadpcm_store_isa(new_isa);
+    return new_isa;
+}
+
+const struct vadpcm_kernels *vadpcm_get_kernels(void) {
+    return &kVADPCMKernels[vadpcm_get_isa()];
+}
@@ -0,0 +1,119 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+// Runtime selection of codec kernels. Internal header.
+//
+// Kernels which use instruction set extensions are compiled with function
+// target attributes, so the library as a whole can be built for the baseline
+// architecture and still use the extensions on CPUs that support them.
+
+#include "codec/vadpcm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define VADPCM_X86 1
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define VADPCM_BIG_ENDIAN 1
+#else
+#define VADPCM_BIG_ENDIAN 0
+#endif
+
+#if __GNUC__
+#define VADPCM_TARGET(name) __attribute__((target(name)))
+#else
+#define VADPCM_TARGET(name)
+#endif
+
+// Force a function to be inlined, so it can be specialized for constant
+// arguments.
+#if __GNUC__
+#define VADPCM_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif _MSC_VER
+#define VADPCM_ALWAYS_INLINE __forceinline
+#else
+#define VADPCM_ALWAYS_INLINE inline
+#endif
+
+struct vadpcm_stats;
+struct vadpcm_encoder_state;
+struct vadpcm_validation;
+
+// Implementations of the codec kernels for one instruction set.
+struct vadpcm_kernels {
+    vadpcm_error (*decode)(int predictor_count, int order,
+                           const struct vadpcm_vector *restrict codebook,
+                           struct vadpcm_vector *restrict state,
+                           size_t frame_count, int16_t *restrict dest,
+                           const void *restrict src);
+    void (*decode_trusted)(int predictor_count, int order,
+                           const struct vadpcm_vector *restrict codebook,
+                           struct vadpcm_vector *restrict state,
+                           size_t frame_count, int16_t *restrict dest,
+                           const void *restrict src);
+    size_t (*validate)(int predictor_count, size_t frame_count,
+                       const void *restrict src,
+                       struct vadpcm_validation *restrict validation);
+    vadpcm_error (*decoder_decode)(
+        const struct vadpcm_decoder *restrict decoder,
+        struct vadpcm_vector *restrict state, size_t frame_count,
+        int16_t *restrict dest, const void *restrict src);
+    // Same as decoder_decode, but the output samples are byte-swapped.
+    vadpcm_error (*decoder_decode_swap)(
+        const struct vadpcm_decoder *restrict decoder,
+        struct vadpcm_vector *restrict state, size_t frame_count,
+        int16_t *restrict dest, const void *restrict src);
+    // Same as decoder_decode, but the output is floating-point.
+    vadpcm_error (*decoder_decode_f32)(
+        const struct vadpcm_decoder *restrict decoder,
+        struct vadpcm_vector *restrict state, size_t frame_count,
+        float *restrict dest, const void *restrict src);
+    // Decode and add to a stereo mix. See vadpcm_decoder_mix_f32_scalar().
+    vadpcm_error (*decoder_mix_f32)(
+        const struct vadpcm_decoder *restrict decoder,
+        struct vadpcm_vector *restrict state, size_t frame_count,
+        float *restrict dest, const void *restrict src, float left,
+        float right);
+    vadpcm_error (*decoder_mix_s32)(
+        const struct vadpcm_decoder *restrict decoder,
+        struct vadpcm_vector *restrict state, size_t frame_count,
+        int32_t *restrict dest, const void *restrict src, float left,
+        float right);
+    // Optional. If NULL, streams are decoded one at a time.
+    vadpcm_error (*decode_multi)(size_t job_count,
+                                 struct vadpcm_decode_job *restrict jobs);
+    // Same as vadpcm_decode_interleaved(), but does not check the stride or
+    // advance the input.
+    vadpcm_error (*decode_interleaved)(
+        size_t channel_count, struct vadpcm_channel *restrict channels,
+        size_t frame_count, size_t stride, int16_t *restrict dest);
+    size_t (*resample)(const float *restrict src, size_t src_count,
+                       uint32_t *restrict position, uint32_t step, size_t count,
+                       float *restrict dest);
+    void (*autocorr)(size_t frame_count, float (*restrict corr)[6],
+                     const int16_t *restrict src);
+    // Audio list mixing. See codec/alist_kernels.h.
+    void (*alist_mix)(size_t count, uint8_t *out, const uint8_t *in, int gain);
+    void (*alist_mix_gains)(size_t count, uint8_t *out, const uint8_t *in,
+                            const int16_t *restrict gains);
+    void (*alist_interleave)(size_t count, uint8_t *out, const uint8_t *left,
+                             const uint8_t *right);
+    void (*encode_data)(size_t frame_count, void *restrict dest,
+                        const int16_t *restrict src,
+                        const uint8_t *restrict predictors,
+                        const struct vadpcm_vector *restrict codebook,
+                        struct vadpcm_stats *restrict stats,
+                        struct vadpcm_encoder_state *restrict encoder_state);
+};
+
+// Return the best instruction set supported by the CPU.
+vadpcm_isa vadpcm_cpu_isa(void);
+
+// Return the kernels for the active instruction set.
+const struct vadpcm_kernels *vadpcm_get_kernels(void);
@@ -0,0 +1,150 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+#include "codec/encode.h"
+#include "codec/vadpcm.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// Return true if two decoder states give the same prediction. Only the last
+// kVADPCMEncodeOrder samples are used by the predictor.
+static bool vadpcm_splice_converged(const struct vadpcm_vector *restrict a,
+                                    const struct vadpcm_vector *restrict b) {
+    for (int i = kVADPCMVectorSampleCount - kVADPCMEncodeOrder;
+         i < kVADPCMVectorSampleCount; i++) {
+        if (a->v[i] != b->v[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Return the squared error between decoded audio and the target.
+static int64_t vadpcm_splice_error(const int16_t *restrict pcm,
+                                   const int16_t *restrict target) {
+    int64_t error = 0;
+    for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+        int64_t diff = pcm[i] - target[i];
+        error += diff * diff;
+    }
+    return error;
+}
+
+// Write one frame after an edit point, so it decodes close to the target
+// audio when starting from the given decoder state. This uses either the
+// original frame or the frame encoded again, whichever is closer. Once the
+// difference from the original state is small, the original frames are
+// closer, and the difference decays to zero as they are decoded. Advances the
+// decoder state, and sets reencoded if the frame was encoded again.
+static vadpcm_error vadpcm_splice_frame(
+    const struct vadpcm_decoder *restrict decoder,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_vector *restrict state, const int16_t *restrict target,
+    uint8_t *restrict dest, const uint8_t *restrict src, bool *reencoded) {
+    int16_t pcm[kVADPCMFrameSampleCount];
+    struct vadpcm_vector original_state = *state;
+    vadpcm_error err =
+        vadpcm_decoder_decode(decoder, &original_state, 1, pcm, src);
+    if (err != 0) {
+        return err;
+    }
+    int64_t original_error = vadpcm_splice_error(pcm, target);
+
+    // Keep the original predictor, and let the encoder choose the scaling.
+    uint8_t frame[kVADPCMFrameByteSize];
+    uint8_t predictor = src[0] & 15;
+    struct vadpcm_encoder_state encoder_state = {
+        .data =
+            {
+                state->v[kVADPCMVectorSampleCount - 2],
+                state->v[kVADPCMVectorSampleCount - 1],
+            },
+        .rng = 0,
+    };
+    struct vadpcm_stats stats;
+    vadpcm_encode_data(1, frame, target, &predictor, codebook, &stats,
+                       &encoder_state);
+    struct vadpcm_vector encoded_state = *state;
+    vadpcm_decoder_decode(decoder, &encoded_state, 1, pcm, frame);
+
+    *reencoded = vadpcm_splice_error(pcm, target) < original_error;
+    if (*reencoded) {
+        memcpy(dest, frame, kVADPCMFrameByteSize);
+        *state = encoded_state;
+    } else {
+        memcpy(dest, src, kVADPCMFrameByteSize);
+        *state = original_state;
+    }
+    return 0;
+}
+
+vadpcm_error vadpcm_splice(
+    int predictor_count, const struct vadpcm_vector *restrict codebook,
+    size_t max_frames, size_t segment_count,
+    const struct vadpcm_splice_segment *restrict segments, void *restrict dest,
+    struct vadpcm_vector *restrict state, struct vadpcm_splice_stats *stats) {
+    struct vadpcm_decoder decoder;
+    vadpcm_error err = vadpcm_decoder_prepare(&decoder, predictor_count,
+                                              kVADPCMEncodeOrder, codebook);
+    if (err != 0) {
+        return err;
+    }
+    struct vadpcm_splice_stats result = {0, 0};
+    uint8_t *dptr = dest;
+    for (size_t seg = 0; seg < segment_count; seg++) {
+        const struct vadpcm_splice_segment *segment = &segments[seg];
+        const uint8_t *sptr = segment->src;
+        size_t frame_count = segment->frame_count;
+        struct vadpcm_vector original = segment->state;
+        size_t frame = 0;
+
+        // Encode frames again, to match the original decoded audio, until the
+        // decoder state converges.
+        while (frame < frame_count &&
+               !vadpcm_splice_converged(state, &original)) {
+            if (frame == max_frames) {
+                result.unconverged_count++;
+                break;
+            }
+            int16_t target[kVADPCMFrameSampleCount];
+            const uint8_t *fptr = sptr + frame * kVADPCMFrameByteSize;
+            err = vadpcm_decoder_decode(&decoder, &original, 1, target, fptr);
+            bool reencoded = false;
+            if (err == 0) {
+                err = vadpcm_splice_frame(&decoder, codebook, state, target,
+                                          dptr + frame * kVADPCMFrameByteSize,
+                                          fptr, &reencoded);
+            }
+            if (err != 0) {
+                return err;
+            }
+            if (reencoded) {
+                result.reencode_count++;
+            }
+            frame++;
+        }
+
+        // Copy the remaining frames. If the state converged, decoding them
+        // would give the same state as in the original stream. Otherwise, they
+        // are decoded to find the state for the next edit point.
+        memcpy(dptr + frame * kVADPCMFrameByteSize,
+               sptr + frame * kVADPCMFrameByteSize,
+               (frame_count - frame) * kVADPCMFrameByteSize);
+        if (frame < frame_count && vadpcm_splice_converged(state, &original)) {
+            *state = segment->end_state;
+            frame = frame_count;
+        }
+        err = vadpcm_skip(&decoder, state, frame_count - frame,
+                          sptr + frame * kVADPCMFrameByteSize);
+        if (err != 0) {
+            return err;
+        }
+        dptr += frame_count * kVADPCMFrameByteSize;
+    }
+    if (stats != NULL) {
+        *stats = result;
+    }
+    return 0;
+}
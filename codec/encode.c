@@ -4,6 +4,7 @@
 #include "codec/encode.h"
 
 #include "codec/autocorr.h"
+#include "codec/dispatch.h"
 #include "codec/predictor.h"
 #include "codec/random.h"
 #include "codec/vadpcm.h"
@@ -77,24 +78,52 @@ static int vadpcm_getshift(int min, int max) {
     return shift;
 }
 
-// Encode audio as VADPCM, given the assignment of each frame to a predictor.
-void vadpcm_encode_data(size_t frame_count, void *restrict dest,
-                        const int16_t *restrict src,
-                        const uint8_t *restrict predictors,
-                        const struct vadpcm_vector *restrict codebook,
-                        struct vadpcm_stats *restrict stats,
-                        struct vadpcm_encoder_state *restrict encoder_state) {
+int vadpcm_encode_shift(const int16_t *restrict src,
+                        const struct vadpcm_vector *restrict pvec, int s0,
+                        int s1) {
+    // Calculate the residual with full precision, and figure out the scaling
+    // factor necessary to encode it.
+    int state[4] = {s0, s1, src[6], src[7]};
+    int accumulator[8], s;
+    int min = 0, max = 0;
+    for (int vector = 0; vector < 2; vector++) {
+        s0 = state[vector * 2];
+        s1 = state[vector * 2 + 1];
+        for (int i = 0; i < 8; i++) {
+            accumulator[i] = (src[vector * 8 + i] * (1 << 11)) -
+                             s0 * pvec[0].v[i] - s1 * pvec[1].v[i];
+        }
+        for (int i = 0; i < 8; i++) {
+            s = accumulator[i] >> 11;
+            if (s < min) {
+                min = s;
+            }
+            if (s > max) {
+                max = s;
+            }
+            for (int j = 0; j < 7 - i; j++) {
+                accumulator[i + 1 + j] -= s * pvec[1].v[j];
+            }
+        }
+    }
+    return vadpcm_getshift(min, max);
+}
+
+void vadpcm_encode_data_scalar(
+    size_t frame_count, void *restrict dest, const int16_t *restrict src,
+    const uint8_t *restrict predictors,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_stats *restrict stats,
+    struct vadpcm_encoder_state *restrict encoder_state) {
     uint32_t rng_state = encoder_state->rng;
     uint8_t *destptr = dest;
-    int state[4];
-    state[0] = encoder_state->data[0];
-    state[1] = encoder_state->data[1];
+    int state[4] = {encoder_state->data[0], encoder_state->data[1], 0, 0};
     stats->signal_mean_square = 0.0;
     stats->error_mean_square = 0.0;
     for (size_t frame = 0; frame < frame_count; frame++) {
         unsigned predictor = predictors[frame];
         const struct vadpcm_vector *restrict pvec = codebook + 2 * predictor;
-        int accumulator[8], s0, s1, s, a, r, min, max;
+        int accumulator[8], s0, s1, s, a, r;
 
         double sum_square = 0.0;
         for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
@@ -103,34 +132,8 @@ void vadpcm_encode_data(size_t frame_count, void *restrict dest,
         }
         stats->signal_mean_square += sum_square;
 
-        // Calculate the residual with full precision, and figure out the
-        // scaling factor necessary to encode it.
-        state[2] = src[frame * 16 + 6];
-        state[3] = src[frame * 16 + 7];
-        min = 0;
-        max = 0;
-        for (int vector = 0; vector < 2; vector++) {
-            s0 = state[vector * 2];
-            s1 = state[vector * 2 + 1];
-            for (int i = 0; i < 8; i++) {
-                accumulator[i] =
-                    (src[frame * 16 + vector * 8 + i] * (1 << 11)) -
-                    s0 * pvec[0].v[i] - s1 * pvec[1].v[i];
-            }
-            for (int i = 0; i < 8; i++) {
-                s = accumulator[i] >> 11;
-                if (s < min) {
-                    min = s;
-                }
-                if (s > max) {
-                    max = s;
-                }
-                for (int j = 0; j < 7 - i; j++) {
-                    accumulator[i + 1 + j] -= s * pvec[1].v[j];
-                }
-            }
-        }
-        int shift = vadpcm_getshift(min, max);
+        int shift =
+            vadpcm_encode_shift(src + frame * 16, pvec, state[0], state[1]);
 
         // Try a range of 3 shift values, and use the shift value that produces
         // the lowest error.
@@ -207,6 +210,16 @@ void vadpcm_encode_data(size_t frame_count, void *restrict dest,
     stats->error_mean_square *= factor;
 }
 
+void vadpcm_encode_data(size_t frame_count, void *restrict dest,
+                        const int16_t *restrict src,
+                        const uint8_t *restrict predictors,
+                        const struct vadpcm_vector *restrict codebook,
+                        struct vadpcm_stats *restrict stats,
+                        struct vadpcm_encoder_state *restrict encoder_state) {
+    vadpcm_get_kernels()->encode_data(frame_count, dest, src, predictors,
+                                      codebook, stats, encoder_state);
+}
+
 vadpcm_error vadpcm_encode(const struct vadpcm_params *restrict params,
                            struct vadpcm_vector *restrict codebook,
                            size_t frame_count, void *restrict dest,
@@ -3,6 +3,7 @@
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #pragma once
 
+#include "codec/dispatch.h"
 #include "codec/vadpcm.h"
 
 #include <stddef.h>
@@ -36,3 +37,29 @@ void vadpcm_encode_data(size_t frame_count, void *restrict dest,
                         const struct vadpcm_vector *restrict codebook,
                         struct vadpcm_stats *restrict stats,
                         struct vadpcm_encoder_state *restrict encoder_state);
+
+// Portable implementation of vadpcm_encode_data.
+void vadpcm_encode_data_scalar(
+    size_t frame_count, void *restrict dest, const int16_t *restrict src,
+    const uint8_t *restrict predictors,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_stats *restrict stats,
+    struct vadpcm_encoder_state *restrict encoder_state);
+
+#if VADPCM_X86
+// SSE4.1 implementation of vadpcm_encode_data. Tries the candidate scaling
+// factors for each frame in parallel.
+void vadpcm_encode_data_sse41(
+    size_t frame_count, void *restrict dest, const int16_t *restrict src,
+    const uint8_t *restrict predictors,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_stats *restrict stats,
+    struct vadpcm_encoder_state *restrict encoder_state);
+#endif
+
+// Calculate the initial estimate for the scaling factor of one frame, given
+// the frame's input, the predictor vectors, and the previous two samples of
+// decoder output. The encoder tries this value and its neighbors.
+int vadpcm_encode_shift(const int16_t *restrict src,
+                        const struct vadpcm_vector *restrict pvec, int s0,
+                        int s1);
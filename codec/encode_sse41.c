@@ -0,0 +1,160 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/encode.h"
+
+#include "codec/dispatch.h"
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+
+#if VADPCM_X86
+
+#include <smmintrin.h>
+
+// The scalar encoder tries up to three different scaling factors for each
+// frame, one after another. This kernel tries them all at the same time, with
+// one scaling factor in each lane. The random number sequence is the same for
+// each scaling factor, so it is computed once.
+//
+// Each lane produces the same result as the scalar encoder. The variable
+// shifts are done with multiplication:
+//
+//   (u >> (16 - shift)) == (u * 2^shift) >> 16, for 0 <= u < 2^16
+//   clamp(x >> shift, -8, 7) == (clamp(x, -8 * 2^shift, 8 * 2^shift - 1) *
+//                                2^(12 - shift)) >> 12
+//
+// The squared error for each sample fits in 32 bits as an unsigned number, and
+// the sum of 16 squared errors is exact in a double, so the error is summed
+// with 64-bit integers instead.
+
+VADPCM_TARGET("sse4.1")
+void vadpcm_encode_data_sse41(
+    size_t frame_count, void *restrict dest, const int16_t *restrict src,
+    const uint8_t *restrict predictors,
+    const struct vadpcm_vector *restrict codebook,
+    struct vadpcm_stats *restrict stats,
+    struct vadpcm_encoder_state *restrict encoder_state) {
+    uint32_t rng_state = encoder_state->rng;
+    uint8_t *destptr = dest;
+    int state[2] = {encoder_state->data[0], encoder_state->data[1]};
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sample_min = _mm_set1_epi32(-0x8000);
+    const __m128i sample_max = _mm_set1_epi32(0x7fff);
+    stats->signal_mean_square = 0.0;
+    stats->error_mean_square = 0.0;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        unsigned predictor = predictors[frame];
+        const struct vadpcm_vector *restrict pvec = codebook + 2 * predictor;
+        const int16_t *restrict fin = src + frame * kVADPCMFrameSampleCount;
+
+        double sum_square = 0.0;
+        for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+            double value = (double)fin[i];
+            sum_square += value * value;
+        }
+        stats->signal_mean_square += sum_square;
+
+        // Choose the scaling factor for each lane. Unused lanes repeat the
+        // last scaling factor.
+        int shift = vadpcm_encode_shift(fin, pvec, state[0], state[1]);
+        int min_shift = shift > 0 ? shift - 1 : 0;
+        int max_shift = shift < 12 ? shift + 1 : 12;
+        int lane_count = max_shift - min_shift + 1;
+        int shifts[4];
+        for (int k = 0; k < 4; k++) {
+            int lane_shift = min_shift + k;
+            shifts[k] = lane_shift < max_shift ? lane_shift : max_shift;
+        }
+        const __m128i scale = _mm_setr_epi32(
+            1 << shifts[0], 1 << shifts[1], 1 << shifts[2], 1 << shifts[3]);
+        const __m128i unscale =
+            _mm_setr_epi32(1 << (12 - shifts[0]), 1 << (12 - shifts[1]),
+                           1 << (12 - shifts[2]), 1 << (12 - shifts[3]));
+        const __m128i residual_min = _mm_mullo_epi32(scale, _mm_set1_epi32(-8));
+        const __m128i residual_max =
+            _mm_sub_epi32(_mm_slli_epi32(scale, 3), _mm_set1_epi32(1));
+
+        __m128i s0 = _mm_set1_epi32(state[0]);
+        __m128i s1 = _mm_set1_epi32(state[1]);
+        __m128i error_lo = zero, error_hi = zero;
+        __m128i residual[kVADPCMFrameSampleCount];
+        for (int vector = 0; vector < 2; vector++) {
+            __m128i accumulator[8];
+            for (int i = 0; i < 8; i++) {
+                accumulator[i] = _mm_add_epi32(
+                    _mm_mullo_epi32(s0, _mm_set1_epi32(pvec[0].v[i])),
+                    _mm_mullo_epi32(s1, _mm_set1_epi32(pvec[1].v[i])));
+            }
+            for (int i = 0; i < 8; i++) {
+                __m128i s = _mm_set1_epi32(fin[vector * 8 + i]);
+                __m128i a = _mm_srai_epi32(accumulator[i], 11);
+                // Calculate the residual, encode as 4 bits.
+                __m128i bias = _mm_srli_epi32(
+                    _mm_mullo_epi32(_mm_set1_epi32(rng_state >> 16), scale),
+                    16);
+                rng_state = vadpcm_rng(rng_state);
+                __m128i r = _mm_add_epi32(_mm_sub_epi32(s, a), bias);
+                r = _mm_min_epi32(_mm_max_epi32(r, residual_min), residual_max);
+                r = _mm_srai_epi32(_mm_mullo_epi32(r, unscale), 12);
+                residual[vector * 8 + i] = r;
+                // Update state to match decoder.
+                __m128i sout = _mm_mullo_epi32(r, scale);
+                for (int j = 0; j < 7 - i; j++) {
+                    accumulator[i + 1 + j] = _mm_add_epi32(
+                        accumulator[i + 1 + j],
+                        _mm_mullo_epi32(sout, _mm_set1_epi32(pvec[1].v[j])));
+                }
+                sout = _mm_add_epi32(sout, a);
+                sout = _mm_min_epi32(_mm_max_epi32(sout, sample_min),
+                                     sample_max);
+                s0 = s1;
+                s1 = sout;
+                // Track encoding error.
+                __m128i serror = _mm_sub_epi32(s, sout);
+                serror = _mm_mullo_epi32(serror, serror);
+                error_lo =
+                    _mm_add_epi64(error_lo, _mm_unpacklo_epi32(serror, zero));
+                error_hi =
+                    _mm_add_epi64(error_hi, _mm_unpackhi_epi32(serror, zero));
+            }
+        }
+
+        // Choose the scaling factor with the lowest error. Ties go to the
+        // smaller scaling factor, like the scalar encoder.
+        uint64_t error[4];
+        _mm_storeu_si128((__m128i *)error, error_lo);
+        _mm_storeu_si128((__m128i *)(error + 2), error_hi);
+        int best = 0;
+        for (int k = 1; k < lane_count; k++) {
+            if (error[k] < error[best]) {
+                best = k;
+            }
+        }
+        int32_t rvalue[kVADPCMFrameSampleCount][4];
+        for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+            _mm_storeu_si128((__m128i *)rvalue[i], residual[i]);
+        }
+        uint8_t *fout = destptr + frame * kVADPCMFrameByteSize;
+        fout[0] = (shifts[best] << 4) | predictor;
+        for (int i = 0; i < 8; i++) {
+            fout[1 + i] = ((rvalue[2 * i][best] & 15) << 4) |
+                          (rvalue[2 * i + 1][best] & 15);
+        }
+        int32_t svalue[2][4];
+        _mm_storeu_si128((__m128i *)svalue[0], s0);
+        _mm_storeu_si128((__m128i *)svalue[1], s1);
+        state[0] = svalue[0][best];
+        state[1] = svalue[1][best];
+        stats->error_mean_square += (double)error[best];
+    }
+    *encoder_state = (struct vadpcm_encoder_state){
+        .data = {state[0], state[1]},
+        .rng = rng_state,
+    };
+    double factor = 1.0 / ((double)(frame_count * kVADPCMFrameSampleCount) *
+                           (32768.0 * 32768.0));
+    stats->signal_mean_square *= factor;
+    stats->error_mean_square *= factor;
+}
+
+#endif // VADPCM_X86
@@ -0,0 +1,81 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/vadpcm.h"
+
+#include "codec/dispatch.h"
+
+#include <math.h>
+
+// Calculate the left and right gain for a voice, using an equal-power pan law.
+static void vadpcm_voice_gain(const struct vadpcm_voice *restrict voice,
+                              float scale, float *restrict left,
+                              float *restrict right) {
+    float pan = voice->pan;
+    if (!(pan > -1.0f)) {
+        pan = -1.0f;
+    } else if (pan > 1.0f) {
+        pan = 1.0f;
+    }
+    // Angle from 0 (left) to pi/2 (right).
+    float angle = (pan + 1.0f) * 0.785398163f;
+    float gain = voice->gain * scale;
+    *left = gain * cosf(angle);
+    *right = gain * sinf(angle);
+}
+
+// Return the number of frames to mix from a voice.
+static size_t vadpcm_voice_frames(const struct vadpcm_voice *restrict voice,
+                                  size_t frame_count) {
+    return voice->frame_count < frame_count ? voice->frame_count : frame_count;
+}
+
+// Advance a voice past the frames which were mixed.
+static void vadpcm_voice_advance(struct vadpcm_voice *restrict voice,
+                                 size_t frame_count) {
+    voice->src =
+        (const uint8_t *)voice->src + frame_count * kVADPCMFrameByteSize;
+    voice->frame_count -= frame_count;
+}
+
+vadpcm_error vadpcm_mix_f32(size_t voice_count,
+                            struct vadpcm_voice *restrict voices,
+                            size_t frame_count, float *restrict dest) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    vadpcm_error result = 0;
+    for (size_t i = 0; i < voice_count; i++) {
+        struct vadpcm_voice *voice = &voices[i];
+        float left, right;
+        vadpcm_voice_gain(voice, 1.0f / 32768.0f, &left, &right);
+        size_t n = vadpcm_voice_frames(voice, frame_count);
+        voice->error = kernels->decoder_mix_f32(voice->decoder, voice->state,
+                                                n, dest, voice->src, left,
+                                                right);
+        if (voice->error != 0) {
+            result = voice->error;
+        }
+        vadpcm_voice_advance(voice, n);
+    }
+    return result;
+}
+
+vadpcm_error vadpcm_mix_s32(size_t voice_count,
+                            struct vadpcm_voice *restrict voices,
+                            size_t frame_count, int32_t *restrict dest) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    vadpcm_error result = 0;
+    for (size_t i = 0; i < voice_count; i++) {
+        struct vadpcm_voice *voice = &voices[i];
+        float left, right;
+        vadpcm_voice_gain(voice, 1.0f, &left, &right);
+        size_t n = vadpcm_voice_frames(voice, frame_count);
+        voice->error = kernels->decoder_mix_s32(voice->decoder, voice->state,
+                                                n, dest, voice->src, left,
+                                                right);
+        if (voice->error != 0) {
+            result = voice->error;
+        }
+        vadpcm_voice_advance(voice, n);
+    }
+    return result;
+}
@@ -0,0 +1,91 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/resample.h"
+
+#include "codec/vadpcm.h"
+
+#include <string.h>
+
+enum {
+    // Number of samples in the window before the current frame.
+    kVADPCMResampleHistory = kVADPCMResampleWindow - kVADPCMFrameSampleCount,
+};
+
+size_t vadpcm_resample_scalar(const float *restrict src, size_t src_count,
+                              uint32_t *restrict position, uint32_t step,
+                              size_t count, float *restrict dest) {
+    uint32_t pos = *position;
+    size_t i = 0;
+    while (i < count && (pos >> 16) + 4 <= src_count) {
+        const float *restrict x = src + (pos >> 16);
+        float t = (float)(pos & 0xffff) * (1.0f / 65536.0f);
+        dest[i] = vadpcm_cubic(x[0], x[1], x[2], x[3], t);
+        pos += step;
+        i++;
+    }
+    *position = pos;
+    return i;
+}
+
+// Decode the next frame into the window, after the history. After the end of
+// the input, the window is filled with silence.
+static vadpcm_error vadpcm_resampler_decode(
+    struct vadpcm_resampler *restrict resampler) {
+    float *frame = resampler->window + kVADPCMResampleHistory;
+    if (resampler->frame_count == 0) {
+        memset(frame, 0, sizeof(float) * kVADPCMFrameSampleCount);
+        return 0;
+    }
+    vadpcm_error err = vadpcm_decoder_decode_f32(
+        resampler->decoder, &resampler->state, 1, frame, resampler->src);
+    resampler->src = (const uint8_t *)resampler->src + kVADPCMFrameByteSize;
+    resampler->frame_count--;
+    return err;
+}
+
+vadpcm_error vadpcm_resampler_init(
+    struct vadpcm_resampler *restrict resampler,
+    const struct vadpcm_decoder *restrict decoder, size_t frame_count,
+    const void *restrict src) {
+    memset(resampler, 0, sizeof(*resampler));
+    resampler->decoder = decoder;
+    resampler->src = src;
+    resampler->frame_count = frame_count;
+    // The first output sample is the first sample of the frame. Its first tap
+    // is the last sample of history, which is silence.
+    resampler->position = (uint32_t)(kVADPCMResampleHistory - 1) << 16;
+    return vadpcm_resampler_decode(resampler);
+}
+
+vadpcm_error vadpcm_resample(struct vadpcm_resampler *restrict resampler,
+                             uint32_t step, size_t sample_count,
+                             float *restrict dest) {
+    if (step > kVADPCMResampleMaxStep) {
+        return kVADPCMErrInvalidParams;
+    }
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    vadpcm_error result = 0;
+    for (;;) {
+        // Move to the frame containing the next output sample. The last
+        // samples of the old frame become the history.
+        while ((resampler->position >> 16) + 4 > kVADPCMResampleWindow) {
+            memmove(resampler->window,
+                    resampler->window + kVADPCMFrameSampleCount,
+                    sizeof(float) * kVADPCMResampleHistory);
+            resampler->position -= (uint32_t)kVADPCMFrameSampleCount << 16;
+            vadpcm_error err = vadpcm_resampler_decode(resampler);
+            if (err != 0) {
+                result = err;
+            }
+        }
+        if (sample_count == 0) {
+            return result;
+        }
+        size_t n = kernels->resample(resampler->window, kVADPCMResampleWindow,
+                                     &resampler->position, step, sample_count,
+                                     dest);
+        dest += n;
+        sample_count -= n;
+    }
+}
@@ -0,0 +1,40 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+// Resampling kernels. Internal header.
+//
+// Output samples are interpolated from four input samples with a Catmull-Rom
+// cubic spline. Positions are 16.16 fixed-point. A position p refers to the
+// point between src[i+1] and src[i+2], where i = p >> 16, and the four taps are
+// src[i] through src[i+3].
+
+#include "codec/dispatch.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Interpolate one sample, where t is the fraction between x1 and x2.
+static inline float vadpcm_cubic(float x0, float x1, float x2, float x3,
+                                 float t) {
+    float a = 3.0f * (x1 - x2) + x3 - x0;
+    float b = 2.0f * x0 - 5.0f * x1 + 4.0f * x2 - x3;
+    float c = x2 - x0;
+    return x1 + 0.5f * t * (c + t * (b + t * a));
+}
+
+// Portable resampling kernel. Writes up to count samples to dest, starting at
+// *position and advancing by step for each sample. Stops early at the first
+// position which needs a tap past the end of src. Returns the number of samples
+// written, and updates *position.
+size_t vadpcm_resample_scalar(const float *restrict src, size_t src_count,
+                              uint32_t *restrict position, uint32_t step,
+                              size_t count, float *restrict dest);
+
+#if VADPCM_X86
+// SSE2 resampling kernel. Interpolates four samples at a time.
+size_t vadpcm_resample_sse2(const float *restrict src, size_t src_count,
+                            uint32_t *restrict position, uint32_t step,
+                            size_t count, float *restrict dest);
+#endif
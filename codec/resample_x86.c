@@ -0,0 +1,60 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/resample.h"
+
+#if VADPCM_X86
+
+#include <emmintrin.h>
+
+VADPCM_TARGET("sse2")
+size_t vadpcm_resample_sse2(const float *restrict src, size_t src_count,
+                            uint32_t *restrict position, uint32_t step,
+                            size_t count, float *restrict dest) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 five = _mm_set1_ps(5.0f);
+    const __m128 frac_scale = _mm_set1_ps(1.0f / 65536.0f);
+    const __m128i frac_mask = _mm_set1_epi32(0xffff);
+    uint32_t pos = *position;
+    size_t i = 0;
+    // Each group of four samples must have all taps inside the source.
+    while (i + 4 <= count && ((pos + 3 * step) >> 16) + 4 <= src_count) {
+        uint32_t p[4];
+        for (int j = 0; j < 4; j++) {
+            p[j] = pos + j * step;
+        }
+        // Load the four taps for each sample, then transpose so that xk
+        // contains tap k for all four samples.
+        __m128 x0 = _mm_loadu_ps(src + (p[0] >> 16));
+        __m128 x1 = _mm_loadu_ps(src + (p[1] >> 16));
+        __m128 x2 = _mm_loadu_ps(src + (p[2] >> 16));
+        __m128 x3 = _mm_loadu_ps(src + (p[3] >> 16));
+        _MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+        __m128i pvec = _mm_setr_epi32(p[0], p[1], p[2], p[3]);
+        __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(pvec, frac_mask)),
+                              frac_scale);
+
+        // Same operations as vadpcm_cubic(), in the same order.
+        __m128 a = _mm_sub_ps(
+            _mm_add_ps(_mm_mul_ps(three, _mm_sub_ps(x1, x2)), x3), x0);
+        __m128 b = _mm_sub_ps(
+            _mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, x0), _mm_mul_ps(five, x1)),
+                       _mm_mul_ps(four, x2)),
+            x3);
+        __m128 c = _mm_sub_ps(x2, x0);
+        __m128 y = _mm_add_ps(_mm_mul_ps(t, a), b);
+        y = _mm_add_ps(_mm_mul_ps(t, y), c);
+        y = _mm_add_ps(x1, _mm_mul_ps(_mm_mul_ps(half, t), y));
+        _mm_storeu_ps(dest + i, y);
+        pos += 4 * step;
+        i += 4;
+    }
+    *position = pos;
+    return i + vadpcm_resample_scalar(src, src_count, position, step, count - i,
+                                      dest + i);
+}
+
+#endif // VADPCM_X86
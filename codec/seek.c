@@ -0,0 +1,141 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+#include "codec/vadpcm.h"
+
+#include <string.h>
+
+size_t vadpcm_seek_table_size(size_t frame_count, uint32_t interval) {
+    if (interval == 0) {
+        return 0;
+    }
+    return (frame_count + interval - 1) / interval;
+}
+
+vadpcm_error vadpcm_seek_table_build(
+    struct vadpcm_seek_table *restrict table,
+    const struct vadpcm_decoder *restrict decoder, size_t frame_count,
+    const void *restrict src) {
+    uint32_t interval = table->interval;
+    if (interval == 0 ||
+        table->entry_count != vadpcm_seek_table_size(frame_count, interval)) {
+        return kVADPCMErrInvalidParams;
+    }
+    const uint8_t *sptr = src;
+    struct vadpcm_vector state;
+    memset(&state, 0, sizeof(state));
+    vadpcm_error result = 0;
+    for (size_t i = 0; i < table->entry_count; i++) {
+        table->state[i] = state;
+        size_t start = i * interval;
+        size_t remaining = frame_count - start;
+        size_t n = remaining < interval ? remaining : interval;
+        vadpcm_error err = vadpcm_skip(decoder, &state, n,
+                                       sptr + start * kVADPCMFrameByteSize);
+        if (err != 0) {
+            result = err;
+        }
+    }
+    return result;
+}
+
+vadpcm_error vadpcm_seek_state(const struct vadpcm_decoder *restrict decoder,
+                               const struct vadpcm_seek_table *restrict table,
+                               size_t frame_count, const void *restrict src,
+                               size_t frame,
+                               struct vadpcm_vector *restrict state) {
+    if (frame > frame_count) {
+        return kVADPCMErrInvalidParams;
+    }
+    size_t start = 0;
+    if (table != NULL && table->entry_count > 0) {
+        if (table->interval == 0 ||
+            table->entry_count !=
+                vadpcm_seek_table_size(frame_count, table->interval)) {
+            return kVADPCMErrInvalidParams;
+        }
+        size_t entry = frame / table->interval;
+        if (entry >= table->entry_count) {
+            entry = table->entry_count - 1;
+        }
+        *state = table->state[entry];
+        start = entry * table->interval;
+    } else {
+        memset(state, 0, sizeof(*state));
+    }
+    const uint8_t *sptr = src;
+    return vadpcm_skip(decoder, state, frame - start,
+                       sptr + start * kVADPCMFrameByteSize);
+}
+
+vadpcm_error vadpcm_decode_range(
+    const struct vadpcm_decoder *restrict decoder,
+    const struct vadpcm_seek_table *restrict table, size_t frame_count,
+    const void *restrict src, size_t first_sample, size_t sample_count,
+    int16_t *restrict dest) {
+    size_t total_samples = frame_count * kVADPCMFrameSampleCount;
+    if (first_sample > total_samples ||
+        sample_count > total_samples - first_sample) {
+        return kVADPCMErrInvalidParams;
+    }
+    if (sample_count == 0) {
+        return 0;
+    }
+    const uint8_t *sptr = src;
+    size_t first_frame = first_sample / kVADPCMFrameSampleCount;
+    size_t end_sample = first_sample + sample_count;
+
+    // Find the nearest entry in the seek table at or before the first frame.
+    struct vadpcm_vector state;
+    size_t frame = 0;
+    if (table != NULL && table->entry_count > 0) {
+        if (table->interval == 0 ||
+            table->entry_count !=
+                vadpcm_seek_table_size(frame_count, table->interval)) {
+            return kVADPCMErrInvalidParams;
+        }
+        size_t entry = first_frame / table->interval;
+        state = table->state[entry];
+        frame = entry * table->interval;
+    } else {
+        memset(&state, 0, sizeof(state));
+    }
+    vadpcm_error result =
+        vadpcm_skip(decoder, &state, first_frame - frame,
+                    sptr + frame * kVADPCMFrameByteSize);
+    frame = first_frame;
+
+    // Decode the frames that overlap the range. Frames which are entirely
+    // inside the range are decoded directly to the output.
+    int16_t scratch[kVADPCMFrameSampleCount];
+    size_t pos = 0;
+    while (pos < sample_count) {
+        size_t frame_start = frame * kVADPCMFrameSampleCount;
+        const uint8_t *fptr = sptr + frame * kVADPCMFrameByteSize;
+        vadpcm_error err;
+        if (frame_start >= first_sample &&
+            end_sample - frame_start >= kVADPCMFrameSampleCount) {
+            size_t n = (end_sample - frame_start) / kVADPCMFrameSampleCount;
+            err = vadpcm_decoder_decode(decoder, &state, n, dest + pos, fptr);
+            frame += n;
+            pos += n * kVADPCMFrameSampleCount;
+        } else {
+            err = vadpcm_decoder_decode(decoder, &state, 1, scratch, fptr);
+            size_t start = frame_start < first_sample
+                               ? first_sample - frame_start
+                               : 0;
+            size_t end = end_sample - frame_start < kVADPCMFrameSampleCount
+                             ? end_sample - frame_start
+                             : kVADPCMFrameSampleCount;
+            memcpy(dest + pos, scratch + start,
+                   sizeof(*scratch) * (end - start));
+            frame++;
+            pos += end - start;
+        }
+        if (err != 0) {
+            result = err;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+#include "codec/vadpcm.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// Return true if all residuals in a frame are zero. Frames with an invalid
+// predictor index are not flat, so they are decoded and the error is reported.
+static bool vadpcm_frame_is_flat(const struct vadpcm_decoder *restrict decoder,
+                                 const uint8_t *frame) {
+    if (((decoder->valid_mask >> (frame[0] & 15)) & 1) == 0) {
+        return false;
+    }
+    for (int i = 1; i < kVADPCMFrameByteSize; i++) {
+        if (frame[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Return true if the part of the decoder state used for prediction is zero.
+static bool vadpcm_state_is_zero(const struct vadpcm_vector *restrict state,
+                                 int order) {
+    for (int i = kVADPCMVectorSampleCount - order;
+         i < kVADPCMVectorSampleCount; i++) {
+        if (state->v[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+vadpcm_error vadpcm_scan_silence(const struct vadpcm_decoder *restrict decoder,
+                                 size_t frame_count, const void *restrict src,
+                                 size_t max_runs,
+                                 struct vadpcm_silence *restrict runs,
+                                 size_t *restrict run_count) {
+    const uint8_t *sptr = src;
+    struct vadpcm_vector state;
+    memset(&state, 0, sizeof(state));
+    bool silent_state = true;
+    size_t count = 0;
+    vadpcm_error result = 0;
+    size_t frame = 0;
+    while (frame < frame_count) {
+        if (silent_state &&
+            vadpcm_frame_is_flat(decoder,
+                                 sptr + frame * kVADPCMFrameByteSize)) {
+            // The decoded audio is zero through the run.
+            size_t start = frame;
+            do {
+                frame++;
+            } while (frame < frame_count &&
+                     vadpcm_frame_is_flat(
+                         decoder, sptr + frame * kVADPCMFrameByteSize));
+            if (count < max_runs) {
+                runs[count] = (struct vadpcm_silence){
+                    .start = start,
+                    .frame_count = frame - start,
+                };
+            }
+            count++;
+            memset(&state, 0, sizeof(state));
+            continue;
+        }
+
+        // Decode up to the next flat frame, which may be silent.
+        size_t end = frame + 1;
+        while (end < frame_count &&
+               !vadpcm_frame_is_flat(decoder,
+                                     sptr + end * kVADPCMFrameByteSize)) {
+            end++;
+        }
+        vadpcm_error err = vadpcm_skip(decoder, &state, end - frame,
+                                       sptr + frame * kVADPCMFrameByteSize);
+        if (err != 0) {
+            result = err;
+        }
+        silent_state = vadpcm_state_is_zero(&state, decoder->order);
+        frame = end;
+    }
+    *run_count = count;
+    return result;
+}
@@ -0,0 +1,147 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/vadpcm.h"
+
+#include "codec/dispatch.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+void vadpcm_stream_init(struct vadpcm_stream *restrict stream,
+                        const struct vadpcm_decoder *restrict decoder,
+                        size_t sample_count, const void *restrict src) {
+    memset(stream, 0, sizeof(*stream));
+    stream->decoder = decoder;
+    stream->src = src;
+    stream->sample_count = sample_count;
+}
+
+vadpcm_error vadpcm_stream_set_loop(struct vadpcm_stream *restrict stream,
+                                    const struct vadpcm_loop *restrict loop) {
+    if (loop == NULL) {
+        memset(&stream->loop, 0, sizeof(stream->loop));
+        stream->loop_remaining = 0;
+        return 0;
+    }
+    if (loop->start >= loop->end || loop->end > stream->sample_count) {
+        return kVADPCMErrInvalidParams;
+    }
+    stream->loop = *loop;
+    stream->loop_remaining = loop->count;
+    return 0;
+}
+
+// Return the frame containing the current position.
+static const void *vadpcm_stream_frame(
+    const struct vadpcm_stream *restrict stream) {
+    return (const uint8_t *)stream->src +
+           (stream->position / kVADPCMFrameSampleCount) * kVADPCMFrameByteSize;
+}
+
+// Decode the frame containing the current position into the buffer.
+static vadpcm_error vadpcm_stream_fill(
+    struct vadpcm_stream *restrict stream,
+    const struct vadpcm_kernels *restrict kernels) {
+    vadpcm_error err =
+        kernels->decoder_decode(stream->decoder, &stream->state, 1,
+                                stream->buffer, vadpcm_stream_frame(stream));
+    stream->buffer_count = kVADPCMFrameSampleCount -
+                           (int)(stream->position % kVADPCMFrameSampleCount);
+    return err;
+}
+
+// Decode samples from the current position, without crossing the end of the
+// stream or loop.
+static vadpcm_error vadpcm_stream_decode(
+    struct vadpcm_stream *restrict stream,
+    const struct vadpcm_kernels *restrict kernels, size_t sample_count,
+    int16_t *restrict dest) {
+    vadpcm_error result = 0;
+
+    // Samples left over from the previous read.
+    size_t n = (size_t)stream->buffer_count;
+    if (n > sample_count) {
+        n = sample_count;
+    }
+    const int16_t *buffered =
+        stream->buffer + kVADPCMFrameSampleCount - stream->buffer_count;
+    memcpy(dest, buffered, sizeof(*dest) * n);
+    stream->buffer_count -= (int)n;
+    stream->position += n;
+    dest += n;
+    sample_count -= n;
+    if (sample_count == 0) {
+        return 0;
+    }
+
+    // Whole frames. The position is now at the start of a frame.
+    size_t frame_count = sample_count / kVADPCMFrameSampleCount;
+    if (frame_count > 0) {
+        result = kernels->decoder_decode(stream->decoder, &stream->state,
+                                         frame_count, dest,
+                                         vadpcm_stream_frame(stream));
+        n = frame_count * kVADPCMFrameSampleCount;
+        stream->position += n;
+        dest += n;
+        sample_count -= n;
+    }
+
+    // Part of a frame. The rest of the frame is kept for the next read.
+    if (sample_count > 0) {
+        vadpcm_error err = vadpcm_stream_fill(stream, kernels);
+        if (err != 0) {
+            result = err;
+        }
+        memcpy(dest, stream->buffer, sizeof(*dest) * sample_count);
+        stream->buffer_count -= (int)sample_count;
+        stream->position += sample_count;
+    }
+    return result;
+}
+
+vadpcm_error vadpcm_stream_read(struct vadpcm_stream *restrict stream,
+                                size_t sample_count, int16_t *restrict dest,
+                                size_t *restrict read_count) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    vadpcm_error result = 0;
+    size_t total = 0;
+    while (sample_count > 0) {
+        bool looping = stream->loop.end != 0 && stream->loop_remaining > 0;
+        size_t end = looping ? stream->loop.end : stream->sample_count;
+        if (stream->position >= end) {
+            if (!looping) {
+                break;
+            }
+            // Jump back to the start of the loop. The frame containing the
+            // start is stored in the loop, so it goes in the buffer, and
+            // decoding continues from the next frame.
+            if (stream->loop_remaining != UINT32_MAX) {
+                stream->loop_remaining--;
+            }
+            stream->position = stream->loop.start;
+            memcpy(stream->buffer, stream->loop.state, sizeof(stream->buffer));
+            memcpy(stream->state.v,
+                   stream->loop.state + kVADPCMFrameSampleCount -
+                       kVADPCMVectorSampleCount,
+                   sizeof(stream->state.v));
+            stream->buffer_count =
+                kVADPCMFrameSampleCount -
+                (int)(stream->position % kVADPCMFrameSampleCount);
+            continue;
+        }
+        size_t n = end - stream->position;
+        if (n > sample_count) {
+            n = sample_count;
+        }
+        vadpcm_error err = vadpcm_stream_decode(stream, kernels, n, dest);
+        if (err != 0) {
+            result = err;
+        }
+        dest += n;
+        sample_count -= n;
+        total += n;
+    }
+    *read_count = total;
+    return result;
+}
@@ -34,6 +34,44 @@ typedef enum {
 // error codes.
 const char *vadpcm_error_name(vadpcm_error err);
 
+// Instruction set extensions that the codec can use, in order from least to
+// most capable. Each one implies the ones before it.
+typedef enum {
+    // Portable C code only.
+    kVADPCMISAScalar,
+
+    // Portable C code, using 64-bit integers to operate on several values at
+    // once (SIMD within a register). This is never chosen by default, because
+    // it is not faster than the scalar code on common compilers.
+    kVADPCMISASWAR,
+
+    // x86 SSE2.
+    kVADPCMISASSE2,
+
+    // x86 SSE4.1. Also implies SSSE3.
+    kVADPCMISASSE41,
+
+    // x86 AVX2.
+    kVADPCMISAAVX2,
+} vadpcm_isa;
+
+// Return the short name of the instruction set, which is the same name used in
+// the VADPCM_ISA environment variable. Returns NULL for unknown values.
+const char *vadpcm_isa_name(vadpcm_isa isa);
+
+// Return the instruction set that the codec uses. By default, this is the best
+// instruction set that the CPU supports, other than SWAR. This can be changed
+// by setting the VADPCM_ISA environment variable to "scalar", "swar", "sse2",
+// "sse4.1", or "avx2" before the codec is first used, or by calling
+// vadpcm_set_isa().
+vadpcm_isa vadpcm_get_isa(void);
+
+// Limit the codec to the given instruction set, or the best instruction set
+// that the CPU supports, whichever is lower. Returns the instruction set that
+// the codec will use. This takes precedence over VADPCM_ISA. Calls already in
+// progress on other threads are not affected.
+vadpcm_isa vadpcm_set_isa(vadpcm_isa isa);
+
 enum {
     // The number of samples in a VADPCM frame.
     kVADPCMFrameSampleCount = 16,
@@ -58,6 +96,14 @@ enum {
     // The predictor order when encoding. Other values are not supported. Do not
     // change this value.
     kVADPCMEncodeOrder = 2,
+
+    // The number of decoded samples a resampler keeps: three samples of
+    // history, followed by one frame.
+    kVADPCMResampleWindow = kVADPCMFrameSampleCount + 3,
+
+    // The maximum resampling step, 16.0 in 16.16 fixed-point. This raises the
+    // pitch by four octaves.
+    kVADPCMResampleMaxStep = 16 << 16,
 };
 
 // A vector of sample data.
@@ -98,6 +144,520 @@ vadpcm_error vadpcm_decode(int predictor_count, int order,
                            size_t frame_count, int16_t *VADPCM_RESTRICT dest,
                            const void *VADPCM_RESTRICT src);
 
+// Counters collected while decoding with vadpcm_decode_telemetry().
+struct vadpcm_telemetry {
+    // Number of frames decoded.
+    size_t frame_count;
+
+    // Number of output samples which were clamped to the 16-bit range.
+    size_t clamp_count;
+
+    // Number of frames which use each predictor index.
+    size_t predictor_histogram[16];
+
+    // Number of frames which use each scaling factor.
+    size_t scaling_histogram[16];
+};
+
+// Decode VADPCM-encoded audio, and count how often each predictor and scaling
+// factor is used and how many samples are clamped. Otherwise, the same as
+// vadpcm_decode(). This is slower than vadpcm_decode(), and is meant for
+// diagnosing problems with encoded audio.
+//
+// The counts are added to the telemetry, which should be zeroed before the
+// first call. Decoding a stream in pieces gives the same counts as decoding it
+// all at once.
+vadpcm_error vadpcm_decode_telemetry(
+    int predictor_count, int order,
+    const struct vadpcm_vector *VADPCM_RESTRICT codebook,
+    struct vadpcm_vector *VADPCM_RESTRICT state, size_t frame_count,
+    int16_t *VADPCM_RESTRICT dest, const void *VADPCM_RESTRICT src,
+    struct vadpcm_telemetry *VADPCM_RESTRICT telemetry);
+
+// Information about encoded data, filled in by vadpcm_validate().
+struct vadpcm_validation {
+    // Index of the first frame with an invalid predictor index, or the frame
+    // count if every frame is valid.
+    size_t invalid_frame;
+
+    // Number of frames which use each predictor index, including invalid
+    // indexes.
+    size_t predictor_histogram[16];
+
+    // Number of frames which use each scaling factor.
+    size_t scaling_histogram[16];
+};
+
+// Check that every frame in encoded data uses a predictor in the codebook, so
+// it can be decoded with vadpcm_decode_trusted(). Frame headers are checked
+// and counted with SIMD, when available.
+//
+// Arguments:
+//   predictor_count: Number of predictors in codebook
+//   frame_count: Number of frames of VADPCM to check
+//   src: Input array of frame_count * kVADPCMFrameByteSize bytes
+//   validation: If not NULL, this will be filled with the position of the
+//     first invalid frame, and a count of how often each predictor and scaling
+//     factor are used
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range.
+//   kVADPCMErrInvalidParams: Invalid predictor count.
+vadpcm_error vadpcm_validate(
+    int predictor_count, size_t frame_count, const void *VADPCM_RESTRICT src,
+    struct vadpcm_validation *VADPCM_RESTRICT validation);
+
+// Decode VADPCM-encoded audio which has been checked by vadpcm_validate(),
+// without checking the predictor index of each frame. Otherwise, the same as
+// vadpcm_decode(). The result is undefined if the input is not valid.
+void vadpcm_decode_trusted(int predictor_count, int order,
+                           const struct vadpcm_vector *VADPCM_RESTRICT codebook,
+                           struct vadpcm_vector *VADPCM_RESTRICT state,
+                           size_t frame_count, int16_t *VADPCM_RESTRICT dest,
+                           const void *VADPCM_RESTRICT src);
+
+// Decode VADPCM-encoded audio to floating-point samples in the range -1..1.
+// Each output sample is the output of vadpcm_decode() divided by 32768. Same
+// arguments as vadpcm_decode(), except for the type of dest.
+//
+// Error codes:
+//   kVADPCMErrInvalidParams: Predictor count or order out of range.
+//   kVADPCMErrInvalidData: Predictor index out of range. All frames are still
+//     decoded, but the output is unspecified.
+vadpcm_error vadpcm_decode_f32(
+    int predictor_count, int order,
+    const struct vadpcm_vector *VADPCM_RESTRICT codebook,
+    struct vadpcm_vector *VADPCM_RESTRICT state, size_t frame_count,
+    float *VADPCM_RESTRICT dest, const void *VADPCM_RESTRICT src);
+
+// A codebook which has been expanded into prediction matrixes for decoding.
+// Preparing a codebook once avoids recalculating the predictors for each call
+// to vadpcm_decode(). Initialize with vadpcm_decoder_prepare(). The contents
+// are private and may change in future versions.
+struct vadpcm_decoder {
+    // Predictor order.
+    int order;
+
+    // Bit set of valid predictor indexes.
+    uint32_t valid_mask;
+
+    // Prediction matrix for each predictor. Unused predictors are zero.
+    struct vadpcm_vector matrix[kVADPCMMaxPredictorCount][16];
+};
+
+// Prepare a codebook for decoding.
+//
+// Arguments:
+//   decoder: Output prepared codebook
+//   predictor_count: Number of predictors in codebook
+//   order: Predictor order in codebook
+//   codebook: Array of predictor_count * order vectors in codebook
+//
+// Error codes:
+//   kVADPCMErrInvalidParams: Predictor count or order out of range.
+vadpcm_error vadpcm_decoder_prepare(
+    struct vadpcm_decoder *VADPCM_RESTRICT decoder, int predictor_count,
+    int order, const struct vadpcm_vector *VADPCM_RESTRICT codebook);
+
+// Decode VADPCM-encoded audio using a prepared codebook. This produces the same
+// output as vadpcm_decode(), except when the data is invalid.
+//
+// Arguments:
+//   decoder: Prepared codebook
+//   state: Decoder state, initially zero
+//   frame_count: Number of frames of VADPCM to decode
+//   dest: Output array of frame_count * kVADPCMFrameSampleCount elements
+//   src: Input array of frame_count * kVADPCMFrameByteSize bytes
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range. All frames are still
+//     decoded, but the output is unspecified.
+vadpcm_error vadpcm_decoder_decode(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+    struct vadpcm_vector *VADPCM_RESTRICT state, size_t frame_count,
+    int16_t *VADPCM_RESTRICT dest, const void *VADPCM_RESTRICT src);
+
+// Decode VADPCM-encoded audio using a prepared codebook, and write the output
+// as big-endian 16-bit samples. Otherwise the same as vadpcm_decoder_decode().
+// The destination must be aligned to 2 bytes.
+vadpcm_error vadpcm_decoder_decode_be(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+    struct vadpcm_vector *VADPCM_RESTRICT state, size_t frame_count,
+    void *VADPCM_RESTRICT dest, const void *VADPCM_RESTRICT src);
+
+// Decode VADPCM-encoded audio using a prepared codebook, and write the output
+// as little-endian 16-bit samples. Otherwise the same as
+// vadpcm_decoder_decode(). The destination must be aligned to 2 bytes.
+vadpcm_error vadpcm_decoder_decode_le(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+    struct vadpcm_vector *VADPCM_RESTRICT state, size_t frame_count,
+    void *VADPCM_RESTRICT dest, const void *VADPCM_RESTRICT src);
+
+// Decode VADPCM-encoded audio using a prepared codebook, and write the output
+// as floating-point samples in the range -1..1. Otherwise the same as
+// vadpcm_decoder_decode().
+vadpcm_error vadpcm_decoder_decode_f32(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+    struct vadpcm_vector *VADPCM_RESTRICT state, size_t frame_count,
+    float *VADPCM_RESTRICT dest, const void *VADPCM_RESTRICT src);
+
+// One stream of audio to decode with vadpcm_decode_multi().
+struct vadpcm_decode_job {
+    // Prepared codebook.
+    const struct vadpcm_decoder *decoder;
+
+    // Decoder state, initially zero.
+    struct vadpcm_vector *state;
+
+    // Number of frames of VADPCM to decode.
+    size_t frame_count;
+
+    // Output array of frame_count * kVADPCMFrameSampleCount elements.
+    int16_t *dest;
+
+    // Input array of frame_count * kVADPCMFrameByteSize bytes.
+    const void *src;
+
+    // Result of decoding this stream, set by vadpcm_decode_multi().
+    vadpcm_error error;
+};
+
+// Decode multiple independent streams of VADPCM-encoded audio. Each stream
+// produces the same result as vadpcm_decoder_decode(). Decoding a single
+// stream is limited by the dependency from one vector to the next, so
+// decoding streams together, in different vector lanes, can be faster.
+//
+// Error codes:
+//   kVADPCMErrInvalidData: A predictor index in any stream is out of range.
+//     The error for each stream is stored in the stream's job.
+vadpcm_error vadpcm_decode_multi(
+    size_t job_count, struct vadpcm_decode_job *VADPCM_RESTRICT jobs);
+
+// One channel to decode with vadpcm_decode_interleaved().
+struct vadpcm_channel {
+    // Prepared codebook.
+    const struct vadpcm_decoder *decoder;
+
+    // Decoder state, initially zero.
+    struct vadpcm_vector *state;
+
+    // Input array of VADPCM frames. Decoding advances this past the frames
+    // which were decoded.
+    const void *src;
+
+    // Result of decoding this channel, set by vadpcm_decode_interleaved().
+    vadpcm_error error;
+};
+
+// Decode several channels of VADPCM-encoded audio directly into an interleaved
+// output buffer. Each channel produces the same samples as
+// vadpcm_decoder_decode(). Sample i of channel c is written to
+// dest[i * stride + c]. Other elements of the output are not modified, so a
+// stride larger than the channel count can be used to fill some of the
+// channels in a wider buffer. Channels are decoded in pairs, which is faster
+// than decoding them one at a time.
+//
+// Arguments:
+//   channel_count: Number of channels
+//   channels: Array of channel_count channels
+//   frame_count: Number of frames to decode from each channel
+//   stride: Number of elements between samples in the output, at least
+//     channel_count
+//   dest: Output array of frame_count * kVADPCMFrameSampleCount * stride
+//     elements
+//
+// Error codes:
+//   kVADPCMErrInvalidData: A predictor index in any channel is out of range.
+//     The error for each channel is stored in the channel.
+//   kVADPCMErrInvalidParams: The stride is less than the channel count.
+vadpcm_error vadpcm_decode_interleaved(
+    size_t channel_count, struct vadpcm_channel *VADPCM_RESTRICT channels,
+    size_t frame_count, size_t stride, int16_t *VADPCM_RESTRICT dest);
+
+// A table of decoder states at regular intervals, which allows decoding to
+// start in the middle of a stream.
+struct vadpcm_seek_table {
+    // Number of frames between entries. Must be positive. Entry i contains the
+    // decoder state at the start of frame i * interval.
+    uint32_t interval;
+
+    // Number of entries in the table.
+    size_t entry_count;
+
+    // Decoder state for each entry.
+    struct vadpcm_vector *state;
+};
+
+// Return the number of entries in a seek table for the given number of frames.
+size_t vadpcm_seek_table_size(size_t frame_count, uint32_t interval);
+
+// Fill in a seek table by decoding the entire stream. The interval,
+// entry_count, and state fields must already be set, and entry_count must be
+// equal to vadpcm_seek_table_size().
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range.
+//   kVADPCMErrInvalidParams: Invalid table size or interval.
+vadpcm_error vadpcm_seek_table_build(
+    struct vadpcm_seek_table *VADPCM_RESTRICT table,
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder, size_t frame_count,
+    const void *VADPCM_RESTRICT src);
+
+// Decode a range of samples from a stream, starting from the nearest seek table
+// entry. The output is the same as decoding the stream from the beginning.
+//
+// Arguments:
+//   decoder: Prepared codebook
+//   table: Seek table for the stream, or NULL to decode from the beginning
+//   frame_count: Number of frames in the stream
+//   src: Input array of frame_count * kVADPCMFrameByteSize bytes
+//   first_sample: Index of the first sample to decode
+//   sample_count: Number of samples to decode
+//   dest: Output array of sample_count elements
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range.
+//   kVADPCMErrInvalidParams: Sample range out of bounds, or invalid table.
+vadpcm_error vadpcm_decode_range(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+    const struct vadpcm_seek_table *VADPCM_RESTRICT table, size_t frame_count,
+    const void *VADPCM_RESTRICT src, size_t first_sample, size_t sample_count,
+    int16_t *VADPCM_RESTRICT dest);
+
+// Get the decoder state before a frame, by decoding from the nearest seek table
+// entry at or before the frame.
+//
+// Arguments:
+//   decoder: Prepared codebook
+//   table: Seek table for the stream, or NULL to decode from the beginning
+//   frame_count: Number of frames in the stream
+//   src: Input array of frame_count * kVADPCMFrameByteSize bytes
+//   frame: Index of the frame, which may be equal to frame_count
+//   state: Output decoder state
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range.
+//   kVADPCMErrInvalidParams: Frame out of bounds, or invalid table.
+vadpcm_error vadpcm_seek_state(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+    const struct vadpcm_seek_table *VADPCM_RESTRICT table, size_t frame_count,
+    const void *VADPCM_RESTRICT src, size_t frame,
+    struct vadpcm_vector *VADPCM_RESTRICT state);
+
+// One voice to decode and mix with vadpcm_mix_f32() or vadpcm_mix_s32().
+struct vadpcm_voice {
+    // Prepared codebook.
+    const struct vadpcm_decoder *decoder;
+
+    // Decoder state, initially zero.
+    struct vadpcm_vector *state;
+
+    // Input array of frame_count * kVADPCMFrameByteSize bytes. Mixing advances
+    // this past the frames which were mixed.
+    const void *src;
+
+    // Number of frames remaining in the input. Mixing subtracts the number of
+    // frames which were mixed. The voice is silent once this reaches zero.
+    size_t frame_count;
+
+    // Volume, where 1.0 is the original level.
+    float gain;
+
+    // Stereo position, from -1.0 (left) to 1.0 (right). Panning uses equal
+    // power, so a centered voice is 3 dB quieter in each channel.
+    float pan;
+
+    // Result of mixing this voice, set by vadpcm_mix_f32() or vadpcm_mix_s32().
+    vadpcm_error error;
+};
+
+// Decode voices and add them to an interleaved stereo mix, without decoding
+// each voice to a separate buffer. The mix is not cleared first. Each voice is
+// scaled so that full scale is -1..1, multiplied by its gain and pan, and
+// added to the mix.
+//
+// The mix is updated in place for each voice, so it should be small enough to
+// stay in cache, such as a few thousand samples. Call this repeatedly to mix
+// longer streams.
+//
+// Arguments:
+//   voice_count: Number of voices
+//   voices: Array of voice_count voices
+//   frame_count: Number of frames to mix
+//   dest: Stereo mix, 2 * frame_count * kVADPCMFrameSampleCount elements
+//
+// Error codes:
+//   kVADPCMErrInvalidData: A predictor index in any voice is out of range. The
+//     error for each voice is stored in the voice.
+vadpcm_error vadpcm_mix_f32(size_t voice_count,
+                            struct vadpcm_voice *VADPCM_RESTRICT voices,
+                            size_t frame_count, float *VADPCM_RESTRICT dest);
+
+// Decode voices and add them to an interleaved stereo 32-bit integer mix. The
+// same as vadpcm_mix_f32(), except that full scale is -32768..32767, and each
+// scaled sample is rounded to the nearest integer before it is added. A scaled
+// sample outside the 32-bit range saturates, but the mix wraps around if it
+// overflows.
+vadpcm_error vadpcm_mix_s32(size_t voice_count,
+                            struct vadpcm_voice *VADPCM_RESTRICT voices,
+                            size_t frame_count, int32_t *VADPCM_RESTRICT dest);
+
+// A decoder which resamples its output, to play audio at a different pitch.
+// Frames are decoded as they are needed, so the entire stream does not have to
+// be decoded first. Initialize with vadpcm_resampler_init(). Fields other than
+// src and frame_count are private.
+struct vadpcm_resampler {
+    // Prepared codebook.
+    const struct vadpcm_decoder *decoder;
+
+    // Decoder state.
+    struct vadpcm_vector state;
+
+    // The next frame to decode, and the number of frames remaining. The output
+    // is silent after the last frame.
+    const void *src;
+    size_t frame_count;
+
+    // Position of the next output sample in the window, in 16.16 fixed-point.
+    uint32_t position;
+
+    // Decoded samples.
+    float window[kVADPCMResampleWindow];
+};
+
+// Initialize a resampler, and decode the first frame.
+//
+// Arguments:
+//   resampler: Resampler to initialize
+//   decoder: Prepared codebook, which must remain valid while in use
+//   frame_count: Number of frames of VADPCM to decode
+//   src: Input array of frame_count * kVADPCMFrameByteSize bytes
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range.
+vadpcm_error vadpcm_resampler_init(
+    struct vadpcm_resampler *VADPCM_RESTRICT resampler,
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder, size_t frame_count,
+    const void *VADPCM_RESTRICT src);
+
+// Produce resampled output, as floating-point samples in the range -1..1. The
+// output is interpolated with a cubic spline. The first output sample is the
+// first decoded sample, and each output sample advances by step input samples.
+// The step is 16.16 fixed-point, so 0x10000 plays at the original pitch, and
+// it can change between calls.
+//
+// Arguments:
+//   resampler: Resampler state
+//   step: Input samples per output sample, in 16.16 fixed-point
+//   sample_count: Number of samples to produce
+//   dest: Output array of sample_count elements
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range. Output continues.
+//   kVADPCMErrInvalidParams: Step is larger than kVADPCMResampleMaxStep.
+vadpcm_error vadpcm_resample(struct vadpcm_resampler *VADPCM_RESTRICT resampler,
+                             uint32_t step, size_t sample_count,
+                             float *VADPCM_RESTRICT dest);
+
+// A loop in a VADPCM stream. The decoded frame which contains the start of the
+// loop is stored with the loop, so playback can jump from the end of the loop
+// back to the start without decoding anything before it. This is the same
+// convention as libultra.
+struct vadpcm_loop {
+    // Index of the first sample in the loop.
+    uint32_t start;
+
+    // Index of the sample after the last sample in the loop.
+    uint32_t end;
+
+    // Number of times to jump back to the start, or UINT32_MAX to repeat
+    // forever. This is the same as the count stored in AIFF files.
+    uint32_t count;
+
+    // Decoded samples of the frame which contains the start of the loop. After
+    // jumping back, the samples from the start of the loop to the end of this
+    // frame are played, and decoding continues with the next frame, using the
+    // last samples of this frame as the decoder state.
+    int16_t state[kVADPCMFrameSampleCount];
+};
+
+// A decoder which produces any number of samples at a time, rather than whole
+// frames. The unused part of the last decoded frame is kept for the next read.
+// The stream can have a loop. Initialize with vadpcm_stream_init(). All fields
+// are private.
+struct vadpcm_stream {
+    // Prepared codebook.
+    const struct vadpcm_decoder *decoder;
+
+    // Decoder state.
+    struct vadpcm_vector state;
+
+    // Input data, starting with the first frame.
+    const void *src;
+
+    // Number of samples in the stream.
+    size_t sample_count;
+
+    // Index of the next sample to read.
+    size_t position;
+
+    // The loop, or a loop with an end of zero if there is no loop.
+    struct vadpcm_loop loop;
+
+    // Number of times remaining to jump back to the start of the loop.
+    uint32_t loop_remaining;
+
+    // Number of decoded samples in the buffer. These are at the end, and the
+    // first of them is the sample at the current position.
+    int buffer_count;
+
+    // The frame containing the current position, if it has been decoded.
+    int16_t buffer[kVADPCMFrameSampleCount];
+};
+
+// Initialize a stream decoder. Nothing is decoded until the first read.
+//
+// Arguments:
+//   stream: Stream to initialize
+//   decoder: Prepared codebook, which must remain valid while in use
+//   sample_count: Number of samples in the stream. This does not have to be a
+//     multiple of kVADPCMFrameSampleCount, and the padding at the end of the
+//     last frame is never returned.
+//   src: Input array of ceil(sample_count / kVADPCMFrameSampleCount) frames
+void vadpcm_stream_init(struct vadpcm_stream *VADPCM_RESTRICT stream,
+                        const struct vadpcm_decoder *VADPCM_RESTRICT decoder,
+                        size_t sample_count, const void *VADPCM_RESTRICT src);
+
+// Set the loop for a stream, or remove it if the loop is NULL. When a read
+// reaches the end of the loop, it continues from the start of the loop using
+// the frame stored in the loop, until the loop count runs out. If the
+// stream is already past the end of the loop, the next read jumps to the start.
+//
+// Error codes:
+//   kVADPCMErrInvalidParams: The loop is empty or extends past the end of the
+//     stream.
+vadpcm_error vadpcm_stream_set_loop(
+    struct vadpcm_stream *VADPCM_RESTRICT stream,
+    const struct vadpcm_loop *VADPCM_RESTRICT loop);
+
+// Decode the next samples from a stream. Whole frames are decoded directly to
+// the output. Only a frame which is not used completely is decoded to the
+// buffer in the stream.
+//
+// Arguments:
+//   stream: Stream state
+//   sample_count: Number of samples to read
+//   dest: Output array of sample_count elements
+//   read_count: Set to the number of samples read, which is less than
+//     sample_count only at the end of the stream
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range. Output continues.
+vadpcm_error vadpcm_stream_read(struct vadpcm_stream *VADPCM_RESTRICT stream,
+                                size_t sample_count,
+                                int16_t *VADPCM_RESTRICT dest,
+                                size_t *VADPCM_RESTRICT read_count);
+
 // Parameters for VADPCM encoding.
 struct vadpcm_params {
     // The number of predictors to put in the codebook.
@@ -137,6 +697,99 @@ vadpcm_error vadpcm_encode(const struct vadpcm_params *VADPCM_RESTRICT params,
                            const int16_t *VADPCM_RESTRICT src,
                            struct vadpcm_stats *stats);
 
+// A range of frames from an encoded stream, to join with vadpcm_splice().
+struct vadpcm_splice_segment {
+    // Encoded frames in the range.
+    const void *src;
+
+    // Number of frames in the range.
+    size_t frame_count;
+
+    // Decoder state before the first frame in the range, in the stream the
+    // range was taken from.
+    struct vadpcm_vector state;
+
+    // Decoder state after the last frame in the range, in the stream the range
+    // was taken from. This is used instead of decoding the range, once the
+    // state converges.
+    struct vadpcm_vector end_state;
+};
+
+// Statistics about vadpcm_splice().
+struct vadpcm_splice_stats {
+    // Number of frames which were encoded again.
+    size_t reencode_count;
+
+    // Number of edit points where the decoder state did not converge to the
+    // original state within the limit. After these points, the decoded audio
+    // is slightly different from the original until the difference decays.
+    size_t unconverged_count;
+};
+
+// Join ranges of encoded audio which use the same codebook, without decoding
+// and encoding the whole stream. After each edit point, the decoder starts from
+// a different state than it did in the original stream. Frames after the edit
+// point are encoded again from the original decoded audio, or copied if that
+// is closer to the original, until the decoder state is the same as the
+// original. The remaining frames are copied without decoding them, so the work
+// depends on the number of edit points, not the length of the audio. Only
+// ranges which do not converge are decoded to the end, to find the state.
+//
+// Arguments:
+//   predictor_count: Number of predictors in the codebook
+//   codebook: Array of predictor_count * kVADPCMEncodeOrder vectors
+//   max_frames: Maximum number of frames to process after each edit point
+//     before giving up on convergence
+//   segment_count: Number of ranges to join
+//   segments: Ranges to join, in order
+//   dest: Output array, with room for the total number of frames
+//   state: Decoder state, before the first frame of output. Updated to the
+//     state after the last frame. Should be zero for the start of a stream.
+//   stats: If not NULL, this will be filled with stats about the edit
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range.
+//   kVADPCMErrInvalidParams: Predictor count out of range.
+vadpcm_error vadpcm_splice(
+    int predictor_count, const struct vadpcm_vector *VADPCM_RESTRICT codebook,
+    size_t max_frames, size_t segment_count,
+    const struct vadpcm_splice_segment *VADPCM_RESTRICT segments,
+    void *VADPCM_RESTRICT dest, struct vadpcm_vector *VADPCM_RESTRICT state,
+    struct vadpcm_splice_stats *stats);
+
+// A run of silent frames, found by vadpcm_scan_silence().
+struct vadpcm_silence {
+    // Index of the first frame in the run.
+    size_t start;
+
+    // Number of frames in the run.
+    size_t frame_count;
+};
+
+// Find runs of frames which decode to silence. A frame is silent if all of its
+// residuals are zero and the decoder state before it is zero, which can be
+// seen from the encoded data. The rest of the stream is decoded only to find
+// the decoder state. Any run of silent frames can be removed from the stream
+// without changing the rest of the decoded audio, because the decoder state is
+// zero before and after the run.
+//
+// Arguments:
+//   decoder: Prepared codebook
+//   frame_count: Number of frames in the stream
+//   src: Input array of frame_count * kVADPCMFrameByteSize bytes
+//   max_runs: Number of elements in the runs array
+//   runs: Output array of runs, in order
+//   run_count: Set to the number of runs found, which may be larger than
+//     max_runs. Only the first max_runs runs are written.
+//
+// Error codes:
+//   kVADPCMErrInvalidData: Predictor index out of range. The scan continues.
+vadpcm_error vadpcm_scan_silence(
+    const struct vadpcm_decoder *VADPCM_RESTRICT decoder, size_t frame_count,
+    const void *VADPCM_RESTRICT src, size_t max_runs,
+    struct vadpcm_silence *VADPCM_RESTRICT runs,
+    size_t *VADPCM_RESTRICT run_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,46 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+#include "codec/dispatch.h"
+#include "codec/vadpcm.h"
+
+#include <string.h>
+
+size_t vadpcm_validate_scalar(int predictor_count, size_t frame_count,
+                              const void *restrict src,
+                              struct vadpcm_validation *restrict validation) {
+    const uint8_t *sptr = src;
+    size_t invalid_frame = frame_count;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        int control = sptr[kVADPCMFrameByteSize * frame];
+        if ((control & 15) >= predictor_count && invalid_frame == frame_count) {
+            invalid_frame = frame;
+            if (validation == NULL) {
+                break;
+            }
+        }
+        if (validation != NULL) {
+            validation->predictor_histogram[control & 15]++;
+            validation->scaling_histogram[control >> 4]++;
+        }
+    }
+    return invalid_frame;
+}
+
+vadpcm_error vadpcm_validate(int predictor_count, size_t frame_count,
+                             const void *restrict src,
+                             struct vadpcm_validation *restrict validation) {
+    if (predictor_count < 1 || kVADPCMMaxPredictorCount < predictor_count) {
+        return kVADPCMErrInvalidParams;
+    }
+    if (validation != NULL) {
+        memset(validation, 0, sizeof(*validation));
+    }
+    size_t invalid_frame = vadpcm_get_kernels()->validate(
+        predictor_count, frame_count, src, validation);
+    if (validation != NULL) {
+        validation->invalid_frame = invalid_frame;
+    }
+    return invalid_frame < frame_count ? kVADPCMErrInvalidData : 0;
+}
@@ -0,0 +1,123 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+
+#if VADPCM_X86
+
+#include <emmintrin.h>
+
+enum {
+    // Number of frames checked at a time. This is 144 bytes, which is a
+    // multiple of both the frame size and the vector size.
+    kVADPCMValidateBlock = 16,
+
+    // Number of blocks which can be counted in 8-bit lanes without overflow.
+    kVADPCMValidateCountBlocks = 255,
+};
+
+// Mask of the control bytes, for each of the nine vectors in a block. Each
+// frame's control byte is in a different lane.
+static const uint8_t kVADPCMValidateMask[kVADPCMFrameByteSize][16] = {
+    {255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0},
+    {0, 0, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0},
+    {0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0},
+    {0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255},
+    {0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0},
+    {0, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0},
+    {0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0},
+    {0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0},
+    {0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0, 0},
+};
+
+// Add the counts in each lane to a histogram, and clear them.
+VADPCM_TARGET("sse2")
+static void vadpcm_validate_flush(__m128i *restrict counts,
+                                  size_t *restrict histogram) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < 16; i++) {
+        __m128i sum = _mm_sad_epu8(counts[i], zero);
+        histogram[i] += (size_t)_mm_cvtsi128_si32(sum) +
+                        (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+        counts[i] = zero;
+    }
+}
+
+VADPCM_TARGET("sse2")
+size_t vadpcm_validate_sse2(int predictor_count, size_t frame_count,
+                            const void *restrict src,
+                            struct vadpcm_validation *restrict validation) {
+    const uint8_t *sptr = src;
+    // Predictor indexes above the limit are nonzero after a saturating
+    // subtract.
+    const __m128i limit = _mm_set1_epi8((char)(predictor_count - 1));
+    const __m128i nibble = _mm_set1_epi8(15);
+    const __m128i zero = _mm_setzero_si128();
+    // Number of frames in each lane which use each predictor index and scaling
+    // factor, since the last flush.
+    __m128i predictor_counts[16], scaling_counts[16];
+    for (int i = 0; i < 16; i++) {
+        predictor_counts[i] = zero;
+        scaling_counts[i] = zero;
+    }
+    int pending = 0;
+    size_t invalid_frame = frame_count;
+    size_t frame = 0;
+    for (; frame + kVADPCMValidateBlock <= frame_count;
+         frame += kVADPCMValidateBlock) {
+        const uint8_t *block = sptr + kVADPCMFrameByteSize * frame;
+        // The control bytes for the frames in the block, in a different order.
+        __m128i control = zero;
+        for (int i = 0; i < kVADPCMFrameByteSize; i++) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+            __m128i mask =
+                _mm_loadu_si128((const __m128i *)kVADPCMValidateMask[i]);
+            control = _mm_or_si128(control, _mm_and_si128(x, mask));
+        }
+        __m128i predictor = _mm_and_si128(control, nibble);
+        __m128i invalid = _mm_subs_epu8(predictor, limit);
+        if (invalid_frame == frame_count &&
+            _mm_movemask_epi8(_mm_cmpeq_epi8(invalid, zero)) != 0xffff) {
+            // Find the invalid frame in the block.
+            invalid_frame = frame + vadpcm_validate_scalar(
+                                        predictor_count, kVADPCMValidateBlock,
+                                        block, NULL);
+            if (validation == NULL) {
+                return invalid_frame;
+            }
+        }
+        if (validation != NULL) {
+            __m128i scaling = _mm_and_si128(_mm_srli_epi16(control, 4), nibble);
+            for (int i = 0; i < 16; i++) {
+                __m128i value = _mm_set1_epi8((char)i);
+                predictor_counts[i] =
+                    _mm_sub_epi8(predictor_counts[i],
+                                 _mm_cmpeq_epi8(predictor, value));
+                scaling_counts[i] = _mm_sub_epi8(
+                    scaling_counts[i], _mm_cmpeq_epi8(scaling, value));
+            }
+            if (++pending == kVADPCMValidateCountBlocks) {
+                vadpcm_validate_flush(predictor_counts,
+                                      validation->predictor_histogram);
+                vadpcm_validate_flush(scaling_counts,
+                                      validation->scaling_histogram);
+                pending = 0;
+            }
+        }
+    }
+    if (validation != NULL) {
+        vadpcm_validate_flush(predictor_counts,
+                              validation->predictor_histogram);
+        vadpcm_validate_flush(scaling_counts, validation->scaling_histogram);
+    }
+    // Check the remaining frames.
+    size_t tail_invalid =
+        vadpcm_validate_scalar(predictor_count, frame_count - frame,
+                               sptr + kVADPCMFrameByteSize * frame, validation);
+    if (invalid_frame == frame_count) {
+        invalid_frame = frame + tail_invalid;
+    }
+    return invalid_frame;
+}
+
+#endif
@@ -2,9 +2,11 @@
 // This file is part of VADPCM. VADPCM is licensed under the terms of the
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #pragma once
+#include "codec/vadpcm.h"
 #include "common/defs.h"
 #include "common/extended.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -45,11 +47,33 @@ struct aiff_data {
     // VADPCM codebook. If not present, then the order and predictor count are
     // both zero.
     struct vadpcm_codebook codebook;
+
+    // VADPCM seek table. If not present, then the entry count is zero. Only
+    // the last codebook.order elements of each state vector are stored in the
+    // file.
+    struct vadpcm_seek_table seek_table;
+
+    // Loop. This comes from the VADPCM loop chunk if there is one, otherwise
+    // from the sustain loop in the INST chunk. If there is no loop, the loop
+    // end is zero. Only one loop is supported.
+    struct vadpcm_loop loop;
+
+    // True if the loop decoder state was read from the VADPCM loop chunk. Loops
+    // from the INST chunk do not have a state.
+    bool has_loop_state;
 };
 
-// Parse an AIFF or AIFF-C file. Returns 0 on success.
+// Parse an AIFF or AIFF-C file. Returns 0 on success. On failure, nothing is
+// left allocated.
 int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
                size_t size);
 
+// Create the part of an AIFF or AIFF-C file which comes before the sample
+// data. Only the size of the audio data is used, not its contents. If the size
+// is odd, a pad byte must be written after the audio data. The header is
+// allocated with malloc. Returns 0 on success.
+int aiff_write_header(const struct aiff_data *restrict aiff, uint8_t **header,
+                      size_t *header_size);
+
 // Write out an AIFF or AIFF-C file to disk. Returns 0 on success.
 int aiff_write(const struct aiff_data *restrict aiff, const char *filename);
@@ -6,3 +6,11 @@
 const uint8_t kAPPLCodebook[12] = {
     11, 'V', 'A', 'D', 'P', 'C', 'M', 'C', 'O', 'D', 'E', 'S',
 };
+
+const uint8_t kAPPLSeekTable[12] = {
+    11, 'V', 'A', 'D', 'P', 'C', 'M', 'S', 'E', 'E', 'K', 'S',
+};
+
+const uint8_t kAPPLLoops[12] = {
+    11, 'V', 'A', 'D', 'P', 'C', 'M', 'L', 'O', 'O', 'P', 'S',
+};
@@ -24,3 +24,9 @@
 
 // APPL name for VADPCM codebook.
 extern const uint8_t kAPPLCodebook[12];
+
+// APPL name for VADPCM seek table.
+extern const uint8_t kAPPLSeekTable[12];
+
+// APPL name for VADPCM loops.
+extern const uint8_t kAPPLLoops[12];
@@ -11,6 +11,7 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 // This is a little clumsy.
@@ -118,8 +119,220 @@ static int aiff_parse_codebook(struct vadpcm_codebook *restrict codebook,
     return 0;
 }
 
-int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
-               size_t size) {
+static int aiff_parse_seek_table(struct vadpcm_seek_table *restrict table,
+                                 int *restrict order, const uint8_t *ptr,
+                                 uint32_t size) {
+    if (size < 2) {
+        LOG_ERROR("seek table too short; size=%" PRIu32, size);
+        return -1;
+    }
+    uint16_t version = read16be(ptr);
+    if (version != 1) {
+        LOG_ERROR("seek table has unknown version; version=%" PRIu16, version);
+        return -1;
+    }
+    if (size < 12) {
+        LOG_ERROR("seek table too short; size=%" PRIu32, size);
+        return -1;
+    }
+    uint16_t table_order = read16be(ptr + 2);
+    uint32_t interval = read32be(ptr + 4);
+    uint32_t entry_count = read32be(ptr + 8);
+    if (table_order > kVADPCMMaxOrder) {
+        LOG_ERROR("seek table order is too large; order=%" PRIu16
+                  ", maximum=%u",
+                  table_order, kVADPCMMaxOrder);
+        return -1;
+    }
+    if (interval == 0) {
+        LOG_ERROR("seek table interval is zero");
+        return -1;
+    }
+    // Can't overflow, maximum value is less than 2^37.
+    if ((uint64_t)entry_count * table_order * 2 > size - 12) {
+        LOG_ERROR("seek table is too short; size=%" PRIu32, size);
+        return -1;
+    }
+    // The first entry is the state at the start of the audio, which is always
+    // zero. The table is only an optimization, so decoding can proceed
+    // without it.
+    for (int i = 0; i < table_order && entry_count > 0; i++) {
+        if (read16be(ptr + 12 + 2 * i) != 0) {
+            LOG_INFO("seek table does not start with a zero state, ignoring");
+            *table = (struct vadpcm_seek_table){0, 0, NULL};
+            *order = table_order;
+            return 0;
+        }
+    }
+    struct vadpcm_vector *state = NULL;
+    if (entry_count > 0) {
+        state = XMALLOC(entry_count, sizeof(*state));
+        const uint8_t *sptr = ptr + 12;
+        for (uint32_t i = 0; i < entry_count; i++) {
+            int n = kVADPCMVectorSampleCount - table_order;
+            for (int j = 0; j < n; j++) {
+                state[i].v[j] = 0;
+            }
+            for (int j = n; j < kVADPCMVectorSampleCount; j++) {
+                state[i].v[j] = read16be(sptr);
+                sptr += 2;
+            }
+        }
+    }
+    *table = (struct vadpcm_seek_table){
+        .interval = interval,
+        .entry_count = entry_count,
+        .state = state,
+    };
+    *order = table_order;
+    return 0;
+}
+
+// A marker from the MARK chunk. Marker names are ignored.
+struct aiff_marker {
+    uint16_t id;
+    uint32_t position;
+};
+
+static int aiff_parse_mark(struct aiff_marker **markers, uint32_t *count,
+                           const uint8_t *ptr, uint32_t size) {
+    if (size < 2) {
+        LOG_ERROR("MARK chunk is too small; size=%" PRIu32 ", minimum=2",
+                  size);
+        return -1;
+    }
+    uint32_t marker_count = read16be(ptr);
+    struct aiff_marker *marker = NULL;
+    if (marker_count > 0) {
+        marker = XMALLOC(marker_count, sizeof(*marker));
+    }
+    uint32_t offset = 2;
+    for (uint32_t i = 0; i < marker_count; i++) {
+        // ID, position, and a name which is padded to an even length.
+        if (size - offset < 7) {
+            LOG_ERROR("MARK chunk is truncated");
+            free(marker);
+            return -1;
+        }
+        const uint8_t *mptr = ptr + offset;
+        uint32_t name_size = align32((uint32_t)mptr[6] + 1, 2);
+        if (size - offset - 6 < name_size) {
+            LOG_ERROR("MARK chunk is truncated");
+            free(marker);
+            return -1;
+        }
+        marker[i] = (struct aiff_marker){
+            .id = read16be(mptr),
+            .position = read32be(mptr + 2),
+        };
+        offset += 6 + name_size;
+    }
+    *markers = marker;
+    *count = marker_count;
+    return 0;
+}
+
+// Find the position of a marker. Returns 0 on success.
+static int aiff_find_marker(const struct aiff_marker *markers,
+                            uint32_t marker_count, uint16_t id,
+                            uint32_t *position) {
+    for (uint32_t i = 0; i < marker_count; i++) {
+        if (markers[i].id == id) {
+            *position = markers[i].position;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Get the loop from the sustain loop in the INST chunk. Returns 0 on success,
+// including if the loop is ignored.
+static int aiff_parse_inst_loop(struct aiff_data *restrict aiff, int play_mode,
+                                uint16_t begin_id, uint16_t end_id,
+                                const uint8_t *mark_ptr, uint32_t mark_size) {
+    // Play mode 1 is forward looping, and 2 is forward/backward.
+    if (play_mode != 1) {
+        LOG_INFO("unsupported loop play mode, ignoring loop; mode=%d",
+                 play_mode);
+        return 0;
+    }
+    if (mark_ptr == NULL) {
+        LOG_INFO("INST chunk has a loop but there is no MARK chunk, "
+                 "ignoring loop");
+        return 0;
+    }
+    struct aiff_marker *markers;
+    uint32_t marker_count;
+    if (aiff_parse_mark(&markers, &marker_count, mark_ptr, mark_size) != 0) {
+        return -1;
+    }
+    uint32_t start, end;
+    if (aiff_find_marker(markers, marker_count, begin_id, &start) != 0 ||
+        aiff_find_marker(markers, marker_count, end_id, &end) != 0) {
+        LOG_INFO("loop marker not found, ignoring loop; begin=%" PRIu16
+                 ", end=%" PRIu16,
+                 begin_id, end_id);
+    } else {
+        aiff->loop = (struct vadpcm_loop){
+            .start = start,
+            .end = end,
+            .count = UINT32_MAX,
+        };
+    }
+    free(markers);
+    return 0;
+}
+
+static int aiff_parse_loops(struct vadpcm_loop *restrict loop,
+                            bool *restrict has_loop, const uint8_t *ptr,
+                            uint32_t size) {
+    enum {
+        // Start, end, count, and 16 samples of state.
+        kLoopSize = 12 + 2 * kVADPCMFrameSampleCount,
+    };
+    if (size < 4) {
+        LOG_ERROR("loop chunk too short; size=%" PRIu32, size);
+        return -1;
+    }
+    uint16_t version = read16be(ptr);
+    if (version != 1) {
+        LOG_ERROR("loop chunk has unknown version; version=%" PRIu16,
+                  version);
+        return -1;
+    }
+    uint32_t loop_count = read16be(ptr + 2);
+    // Can't overflow, maximum value is less than 2^22.
+    if (4 + loop_count * kLoopSize > size) {
+        LOG_ERROR("loop chunk is too short; size=%" PRIu32, size);
+        return -1;
+    }
+    if (loop_count == 0) {
+        return 0;
+    }
+    if (loop_count > 1) {
+        LOG_INFO("only the first loop is used; loops=%" PRIu32, loop_count);
+    }
+    const uint8_t *lptr = ptr + 4;
+    *loop = (struct vadpcm_loop){
+        .start = read32be(lptr),
+        .end = read32be(lptr + 4),
+        .count = read32be(lptr + 8),
+    };
+    // The state is the decoded frame which contains the start of the loop.
+    const uint8_t *sptr = lptr + 12;
+    for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+        loop->state[i] = read16be(sptr + 2 * i);
+    }
+    *has_loop = true;
+    return 0;
+}
+
+// Parse an AIFF or AIFF-C file. On failure, the codebook and seek table may
+// be allocated, and the caller must free them.
+static int aiff_parse_file(struct aiff_data *restrict aiff, const uint8_t *ptr,
+                           size_t size) {
+    aiff->codebook = (struct vadpcm_codebook){0, 0, NULL};
+    aiff->seek_table = (struct vadpcm_seek_table){0, 0, NULL};
     // Read the header.
     if (size < 12) {
         LOG_ERROR("file size is too small; size=%zu, minimum=12", size);
@@ -149,6 +362,8 @@ int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
         return -1;
     }
     aiff->version_timestamp = 0;
+    memset(&aiff->loop, 0, sizeof(aiff->loop));
+    aiff->has_loop_state = false;
     uint32_t content_size = read32be(ptr + 4);
     LOG_DEBUG("size=%" PRIu32, content_size);
     if (content_size > size - 8) {
@@ -163,6 +378,16 @@ int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
     bool has_comm = false;
     bool has_ssnd = false;
     bool has_codebook = false;
+    bool has_seek_table = false;
+    int seek_table_order = 0;
+    bool has_loops = false;
+    // MARK chunk, which is only parsed if the INST chunk needs it.
+    const uint8_t *mark_ptr = NULL;
+    uint32_t mark_size = 0;
+    // Sustain loop from the INST chunk: play mode, begin and end marker IDs.
+    bool has_inst = false;
+    int inst_play_mode = 0;
+    uint16_t inst_begin = 0, inst_end = 0;
     while (offset < end) {
         if (8 > end - offset) {
             LOG_ERROR("incomplete chunk header; offset=%td", offset);
@@ -231,10 +456,26 @@ int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
             }
             aiff->version_timestamp = read32be(cptr);
             break;
-        /* case CHUNK_MARK: */
-        /*     break; */
-        /* case CHUNK_INST: */
-        /*     break; */
+        case CHUNK_MARK:
+            if (mark_ptr != NULL) {
+                LOG_ERROR("multiple MARK chunks found");
+                return -1;
+            }
+            mark_ptr = cptr;
+            mark_size = chunk_size;
+            break;
+        case CHUNK_INST:
+            if (chunk_size < 20) {
+                LOG_ERROR("INST chunk is too small; size=%" PRIu32
+                          ", minimum=20",
+                          chunk_size);
+                return -1;
+            }
+            has_inst = true;
+            inst_play_mode = (int16_t)read16be(cptr + 8);
+            inst_begin = read16be(cptr + 10);
+            inst_end = read16be(cptr + 12);
+            break;
         case CHUNK_APPL: {
             LOG_DEBUG("APPL CHUNK");
             if (chunk_size < 4) {
@@ -273,6 +514,28 @@ int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
                             0) {
                             return -1;
                         }
+                    } else if (memcmp(nptr, kAPPLLoops, 12) == 0) {
+                        if (has_loops) {
+                            LOG_ERROR("multiple loop chunks found");
+                            return -1;
+                        }
+                        has_loops = true;
+                        if (aiff_parse_loops(&aiff->loop,
+                                             &aiff->has_loop_state, aptr,
+                                             asize) != 0) {
+                            return -1;
+                        }
+                    } else if (memcmp(nptr, kAPPLSeekTable, 12) == 0) {
+                        if (has_seek_table) {
+                            LOG_ERROR("multiple seek tables found");
+                            return -1;
+                        }
+                        has_seek_table = true;
+                        if (aiff_parse_seek_table(&aiff->seek_table,
+                                                  &seek_table_order, aptr,
+                                                  asize) != 0) {
+                            return -1;
+                        }
                     }
                 }
             }
@@ -299,9 +562,45 @@ int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
         LOG_ERROR("no codebook");
         return -1;
     }
+    if (has_inst && !has_loops && inst_play_mode != 0) {
+        if (aiff_parse_inst_loop(aiff, inst_play_mode, inst_begin, inst_end,
+                                 mark_ptr, mark_size) != 0) {
+            return -1;
+        }
+    }
+    if (aiff->seek_table.entry_count > 0 &&
+        seek_table_order != aiff->codebook.order) {
+        // The table is only an optimization, so decoding can proceed without
+        // it.
+        LOG_INFO("seek table order does not match codebook, ignoring; "
+                 "order=%d, codebook order=%d",
+                 seek_table_order, aiff->codebook.order);
+        free(aiff->seek_table.state);
+        aiff->seek_table = (struct vadpcm_seek_table){0, 0, NULL};
+    }
     LOG_DEBUG("channels: %" PRIu32, aiff->num_channels);
     LOG_DEBUG("frames: %" PRIu32, aiff->num_sample_frames);
     LOG_DEBUG("bits: %" PRIu32, aiff->sample_size);
     LOG_DEBUG("audio: ptr=%p; size=%zu", aiff->audio.ptr, aiff->audio.size);
+    if (aiff->seek_table.entry_count > 0) {
+        LOG_DEBUG("seek table: interval=%" PRIu32 ", entries=%zu",
+                  aiff->seek_table.interval, aiff->seek_table.entry_count);
+    }
+    if (aiff->loop.end != 0) {
+        LOG_DEBUG("loop: start=%" PRIu32 ", end=%" PRIu32 ", count=%" PRIu32,
+                  aiff->loop.start, aiff->loop.end, aiff->loop.count);
+    }
     return 0;
 }
+
+int aiff_parse(struct aiff_data *restrict aiff, const uint8_t *ptr,
+               size_t size) {
+    int r = aiff_parse_file(aiff, ptr, size);
+    if (r != 0) {
+        free(aiff->codebook.vector);
+        free(aiff->seek_table.state);
+        aiff->codebook = (struct vadpcm_codebook){0, 0, NULL};
+        aiff->seek_table = (struct vadpcm_seek_table){0, 0, NULL};
+    }
+    return r;
+}
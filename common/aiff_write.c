@@ -16,6 +16,7 @@ enum {
     kChunkFVER,
     kChunkCOMM,
     kChunkVCodebook,
+    kChunkVSeekTable,
     kChunkSSND,
 
     kChunkCount,
@@ -25,6 +26,7 @@ static const uint32_t kChunkID[] = {
     [kChunkFVER] = CHUNK_FVER,
     [kChunkCOMM] = CHUNK_COMM,
     [kChunkVCodebook] = CHUNK_APPL,
+    [kChunkVSeekTable] = CHUNK_APPL,
     [kChunkSSND] = CHUNK_SSND,
 };
 
@@ -38,7 +40,8 @@ static const struct aiff_codec kAIFFCodecs[] = {
     [kAIFFCodecVADPCM] = {CODEC_VADPCM, "\13VADPCM ~4-1"},
 };
 
-int aiff_write(const struct aiff_data *restrict aiff, const char *filename) {
+int aiff_write_header(const struct aiff_data *restrict aiff, uint8_t **header,
+                      size_t *header_size) {
     // Calculate size of each chunk.
     // 0 = not present.
     uint32_t chunk_size[kChunkCount];
@@ -61,6 +64,15 @@ int aiff_write(const struct aiff_data *restrict aiff, const char *filename) {
             chunk_size[kChunkVCodebook] =
                 16 + 6 +
                 16 * aiff->codebook.order * aiff->codebook.predictor_count;
+            size_t entry_count = aiff->seek_table.entry_count;
+            if (entry_count > 0) {
+                if (entry_count > (0xffffffff - 28) / (2 * kVADPCMMaxOrder)) {
+                    LOG_ERROR("seek table too large");
+                    return -1;
+                }
+                chunk_size[kChunkVSeekTable] =
+                    16 + 12 + 2 * aiff->codebook.order * (uint32_t)entry_count;
+            }
         }
         break;
     }
@@ -142,17 +154,50 @@ int aiff_write(const struct aiff_data *restrict aiff, const char *filename) {
                 vector++;
                 cptr += 16;
             }
+
+            // VADPCM seek table.
+            if (chunk_size[kChunkVSeekTable] > 0) {
+                cptr = ptr + chunk_offset[kChunkVSeekTable];
+                write32be(cptr, APPL_STOC);
+                memcpy(cptr + 4, kAPPLSeekTable, 12);
+                cptr += 16;
+                const struct vadpcm_seek_table *restrict table =
+                    &aiff->seek_table;
+                write16be(cptr, 1); // version
+                write16be(cptr + 2, codebook->order);
+                write32be(cptr + 4, table->interval);
+                write32be(cptr + 8, table->entry_count);
+                cptr += 12;
+                for (size_t i = 0; i < table->entry_count; i++) {
+                    for (int j = kVADPCMVectorSampleCount - codebook->order;
+                         j < kVADPCMVectorSampleCount; j++) {
+                        write16be(cptr, table->state[i].v[j]);
+                        cptr += 2;
+                    }
+                }
+            }
         }
     }
 
-    // Create file.
+    *header = ptr;
+    *header_size = head_size;
+    return 0;
+}
+
+int aiff_write(const struct aiff_data *restrict aiff, const char *filename) {
+    uint8_t *header;
+    size_t header_size;
+    int r = aiff_write_header(aiff, &header, &header_size);
+    if (r != 0) {
+        return r;
+    }
     uint8_t zero = 0;
     struct byteslice chunks[3] = {
-        {.ptr = ptr, .size = head_size},
+        {.ptr = header, .size = header_size},
         aiff->audio,
-        {.ptr = &zero, .size = chunk_size[kChunkSSND] & 1},
+        {.ptr = &zero, .size = aiff->audio.size & 1},
     };
-    int r = output_file_write(filename, chunks, 3);
-    free(ptr);
+    r = output_file_write(filename, chunks, 3);
+    free(header);
     return r;
 }
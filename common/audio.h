@@ -2,10 +2,14 @@
 // This file is part of VADPCM. VADPCM is licensed under the terms of the
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #pragma once
+#include "codec/vadpcm.h"
 #include "common/defs.h"
 #include "common/extended.h"
 #include "common/format.h"
+#include "common/util.h"
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Maximum number of samples in an input file. This limit is somewhat
@@ -14,6 +18,24 @@
 // go over it because of padding.
 #define MAX_INPUT_LENGTH ((uint32_t)0x40000000)
 
+// Format of PCM samples in memory.
+typedef enum {
+    // 16-bit integers, native byte order.
+    kSampleNative,
+    // 16-bit integers, big-endian.
+    kSampleBigEndian,
+    // 16-bit integers, little-endian.
+    kSampleLittleEndian,
+    // 32-bit floating-point, native byte order. Full scale is -1..1.
+    kSampleFloat,
+} sample_format;
+
+// Return the size of one sample, in bytes.
+size_t sample_format_size(sample_format format);
+
+// Return the format for 16-bit PCM samples in a file format.
+sample_format sample_format_for_file(file_format format);
+
 // Metadata for audio files. For convenience, the audio data is always padded
 // with zeroes to a multiple of the VADPCM frame size.
 struct audio_meta {
@@ -39,19 +61,116 @@ int audio_read_pcm(struct audio_pcm *restrict audio, const char *filename,
 int audio_write_pcm(struct audio_pcm *restrict audio, const char *filename,
                     file_format format);
 
+// Write PCM audio to a file. The samples must already be in the byte order
+// used by the file format, or they must be kSampleFloat. Floating-point samples
+// can only be written to WAVE files.
+int audio_write_pcm_raw(const struct audio_meta *restrict meta,
+                        const void *sample_data, sample_format samples,
+                        const char *filename, file_format format);
+
 // Destroy PCM if it was returned from audio_read_pcm().
 void audio_pcm_destroy(struct audio_pcm *restrict audio);
 
+// Writer for PCM audio, which writes a block of samples at a time instead of
+// keeping the entire file in memory.
+struct audio_pcm_writer {
+    struct output_stream stream;
+    sample_format samples;
+    // Number of samples left to write.
+    uint32_t remaining;
+};
+
+// Open a PCM audio file for writing, and write the header. The filename "-"
+// is standard output. If use_float is true, the file contains 32-bit
+// floating-point samples, which is only supported for WAVE files.
+int audio_pcm_writer_open(struct audio_pcm_writer *restrict writer,
+                          const char *filename, file_format format,
+                          const struct audio_meta *restrict meta,
+                          bool use_float);
+
+// Write 16-bit samples to a PCM audio file. Only meta.original_sample_count
+// samples are written in total, and any samples past that are discarded. The
+// file must not use floating-point samples. NOTE: This will modify the samples
+// in-place.
+int audio_pcm_writer_write(struct audio_pcm_writer *restrict writer,
+                           int16_t *samples, size_t count);
+
+// Write samples to a PCM audio file, which are already in the format given by
+// writer->samples. Otherwise the same as audio_pcm_writer_write().
+int audio_pcm_writer_write_raw(struct audio_pcm_writer *restrict writer,
+                               const void *samples, size_t count);
+
+// Finish writing a PCM audio file and close it. Fails if fewer than
+// meta.original_sample_count samples were written.
+int audio_pcm_writer_close(struct audio_pcm_writer *restrict writer);
+
 // VADPCM-encoded audio data.
 struct audio_vadpcm {
     struct audio_meta meta;
     struct vadpcm_codebook codebook;
-    uint8_t *encoded_data;
+    // Seek table, or an empty table if the file does not have one.
+    struct vadpcm_seek_table seek_table;
+    // Loop, including the decoder state at the start. If there is no loop, the
+    // loop end is zero.
+    struct vadpcm_loop loop;
+    // Points into the input file, which is kept open.
+    const uint8_t *encoded_data;
+    struct input_file input;
 };
 
 // Read VADPCM audio from a file.
 int audio_read_vadpcm(struct audio_vadpcm *restrict audio,
                       const char *filename);
 
+// Write VADPCM audio to an AIFF-C file. The encoded data contains
+// meta.padded_sample_count samples. If seek_interval is nonzero, a seek table
+// with an entry every seek_interval frames is built and written. Returns 0 on
+// success.
+int audio_write_vadpcm(const struct audio_meta *restrict meta,
+                       const struct vadpcm_codebook *restrict codebook,
+                       const void *encoded_data, uint32_t seek_interval,
+                       const char *filename);
+
+// Parse the argument of the --seek-interval option. Logs an error and returns
+// false if the argument is not a positive 32-bit integer.
+bool parse_seek_interval(const char *arg, uint32_t *interval);
+
+// Decode VADPCM audio, writing meta.padded_sample_count samples to dest in the
+// given format. If the audio has a seek table, the work is split across up to
+// thread_count threads. The output does not depend on the number of threads.
+// Returns 0 on success.
+int audio_vadpcm_decode(const struct audio_vadpcm *restrict audio,
+                        void *restrict dest, sample_format samples,
+                        int thread_count);
+
+// Decode VADPCM audio to a PCM audio file, like audio_vadpcm_decode() followed
+// by audio_write_pcm_raw(). The output file is mapped into memory and the
+// samples are decoded directly into it, so no separate buffer is needed.
+// Floating-point samples can only be written to WAVE files.
+int audio_vadpcm_decode_file(const struct audio_vadpcm *restrict audio,
+                             const char *filename, file_format format,
+                             bool use_float, int thread_count);
+
+// A clip to decode with audio_decode_batch(), such as one sound in a bank.
+struct decode_clip {
+    // Prepared decoder for the clip's codebook. Clips may share a decoder.
+    const struct vadpcm_decoder *decoder;
+    // Encoded audio and its length, in frames. The clip is decoded from the
+    // start, with a zero decoder state.
+    const void *src;
+    size_t frame_count;
+    // Output, with room for frame_count * kVADPCMFrameSampleCount samples.
+    void *dest;
+    // Result of decoding the clip, set by audio_decode_batch().
+    vadpcm_error error;
+};
+
+// Decode a batch of clips, writing samples in the given format, using up to
+// thread_count threads. Consecutive short clips are grouped into a single task,
+// so the cost of scheduling is small compared to decoding. Sets the error for
+// each clip, and returns the number of clips which could not be decoded.
+size_t audio_decode_batch(size_t clip_count, struct decode_clip *clips,
+                          sample_format samples, int thread_count);
+
 // Destroy VADPCM if it was returned from audio_read_vadpcm().
 void audio_vadpcm_destroy(struct audio_vadpcm *restrict audio);
@@ -0,0 +1,245 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/audio.h"
+
+#include "codec/vadpcm.h"
+#include "common/util.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    // Number of tasks to create for each thread, so threads which finish early
+    // can pick up more work.
+    kTasksPerThread = 4,
+
+    // Minimum number of frames in a batch decode task. Smaller clips are
+    // grouped together until the task is at least this long.
+    kBatchMinTaskFrames = 256,
+};
+
+// Decode audio, writing samples in the given format.
+static vadpcm_error decode_samples(
+    const struct vadpcm_decoder *restrict decoder,
+    struct vadpcm_vector *restrict state, size_t frame_count,
+    void *restrict dest, const void *restrict src, sample_format samples) {
+    switch (samples) {
+    case kSampleBigEndian:
+        return vadpcm_decoder_decode_be(decoder, state, frame_count, dest,
+                                        src);
+    case kSampleLittleEndian:
+        return vadpcm_decoder_decode_le(decoder, state, frame_count, dest,
+                                        src);
+    case kSampleFloat:
+        return vadpcm_decoder_decode_f32(decoder, state, frame_count, dest,
+                                         src);
+    default:
+        return vadpcm_decoder_decode(decoder, state, frame_count, dest, src);
+    }
+}
+
+// A parallel decode. Each task decodes a run of consecutive seek table
+// entries, starting from the state in the table.
+struct decode_parallel {
+    const struct vadpcm_decoder *decoder;
+    const struct vadpcm_seek_table *table;
+    size_t frame_count;
+    size_t entries_per_task;
+    const uint8_t *src;
+    uint8_t *dest;
+    sample_format samples;
+    // Result of each task.
+    vadpcm_error *error;
+    // Whether the state at the end of each task matches the next entry in the
+    // seek table.
+    bool *consistent;
+};
+
+static void decode_parallel_task(void *ctx, size_t task) {
+    const struct decode_parallel *restrict p = ctx;
+    const struct vadpcm_seek_table *restrict table = p->table;
+    size_t first_entry = task * p->entries_per_task;
+    size_t end_entry = first_entry + p->entries_per_task;
+    if (end_entry > table->entry_count) {
+        end_entry = table->entry_count;
+    }
+    size_t first_frame = first_entry * table->interval;
+    size_t end_frame = end_entry * table->interval;
+    if (end_frame > p->frame_count) {
+        end_frame = p->frame_count;
+    }
+    // The first entry in the table should be zero, but it comes from the file
+    // and is not checked, so the first task starts from zero like a serial
+    // decode. The other tasks are checked by comparing their end states.
+    struct vadpcm_vector state;
+    if (first_entry == 0) {
+        memset(&state, 0, sizeof(state));
+    } else {
+        state = table->state[first_entry];
+    }
+    p->error[task] = decode_samples(
+        p->decoder, &state, end_frame - first_frame,
+        p->dest + first_frame * kVADPCMFrameSampleCount *
+                      sample_format_size(p->samples),
+        p->src + first_frame * kVADPCMFrameByteSize, p->samples);
+    // The decoder only uses the last "order" samples of the state.
+    bool consistent = true;
+    if (end_entry < table->entry_count) {
+        const struct vadpcm_vector *next = &table->state[end_entry];
+        for (int i = kVADPCMVectorSampleCount - p->decoder->order;
+             i < kVADPCMVectorSampleCount; i++) {
+            if (state.v[i] != next->v[i]) {
+                consistent = false;
+            }
+        }
+    }
+    p->consistent[task] = consistent;
+}
+
+// Decode in parallel using the seek table. Returns false if the seek table
+// does not match the audio data, in which case the output is incomplete.
+static bool decode_parallel(const struct vadpcm_decoder *restrict decoder,
+                            const struct vadpcm_seek_table *restrict table,
+                            size_t frame_count, void *dest,
+                            const uint8_t *src, sample_format samples,
+                            int thread_count, vadpcm_error *restrict errp) {
+    size_t task_count = (size_t)thread_count * kTasksPerThread;
+    if (task_count > table->entry_count) {
+        task_count = table->entry_count;
+    }
+    size_t entries_per_task =
+        (table->entry_count + task_count - 1) / task_count;
+    task_count = (table->entry_count + entries_per_task - 1) / entries_per_task;
+    struct decode_parallel p = {
+        .decoder = decoder,
+        .table = table,
+        .frame_count = frame_count,
+        .entries_per_task = entries_per_task,
+        .src = src,
+        .dest = dest,
+        .samples = samples,
+        .error = XMALLOC(task_count, sizeof(*p.error)),
+        .consistent = XMALLOC(task_count, sizeof(*p.consistent)),
+    };
+    thread_run(thread_count, task_count, decode_parallel_task, &p);
+    vadpcm_error err = 0;
+    bool consistent = true;
+    for (size_t i = 0; i < task_count; i++) {
+        if (p.error[i] != 0) {
+            err = p.error[i];
+        }
+        if (!p.consistent[i]) {
+            consistent = false;
+        }
+    }
+    free(p.error);
+    free(p.consistent);
+    *errp = err;
+    return consistent;
+}
+
+int audio_vadpcm_decode(const struct audio_vadpcm *restrict audio,
+                        void *restrict dest, sample_format samples,
+                        int thread_count) {
+    struct vadpcm_decoder decoder;
+    vadpcm_error err = vadpcm_decoder_prepare(
+        &decoder, audio->codebook.predictor_count, audio->codebook.order,
+        audio->codebook.vector);
+    if (err != 0) {
+        LOG_ERROR("invalid codebook: %s", vadpcm_error_name(err));
+        return -1;
+    }
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    const struct vadpcm_seek_table *restrict table = &audio->seek_table;
+    bool done = false;
+    if (thread_count > 1 && table->entry_count > 1) {
+        // The seek table comes from the file, so it is checked against the
+        // decoded data. The output is only used if every chunk ends with the
+        // state recorded for the start of the next chunk, which guarantees it
+        // is identical to the output of a serial decode.
+        done = decode_parallel(&decoder, table, frame_count, dest,
+                               audio->encoded_data, samples, thread_count,
+                               &err);
+        if (!done) {
+            LOG_INFO("seek table does not match audio data, "
+                     "decoding without it");
+        }
+    }
+    if (!done) {
+        struct vadpcm_vector state;
+        memset(&state, 0, sizeof(state));
+        err = decode_samples(&decoder, &state, frame_count, dest,
+                             audio->encoded_data, samples);
+    }
+    if (err != 0) {
+        LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
+        return -1;
+    }
+    return 0;
+}
+
+// A batch decode. Each task decodes a run of consecutive clips.
+struct decode_batch {
+    struct decode_clip *clips;
+    // Index of the first clip in each task, followed by the clip count.
+    const size_t *task_start;
+    sample_format samples;
+};
+
+static void decode_batch_task(void *ctx, size_t task) {
+    const struct decode_batch *restrict b = ctx;
+    for (size_t i = b->task_start[task]; i < b->task_start[task + 1]; i++) {
+        struct decode_clip *restrict clip = &b->clips[i];
+        struct vadpcm_vector state;
+        memset(&state, 0, sizeof(state));
+        clip->error = decode_samples(clip->decoder, &state, clip->frame_count,
+                                     clip->dest, clip->src, b->samples);
+    }
+}
+
+size_t audio_decode_batch(size_t clip_count, struct decode_clip *clips,
+                          sample_format samples, int thread_count) {
+    if (clip_count == 0) {
+        return 0;
+    }
+    // Split the clips into tasks of roughly equal length, with a few tasks for
+    // each thread, but do not make the tasks too short.
+    size_t total_frames = 0;
+    for (size_t i = 0; i < clip_count; i++) {
+        total_frames += clips[i].frame_count;
+    }
+    size_t target_count =
+        (size_t)(thread_count > 1 ? thread_count : 1) * kTasksPerThread;
+    size_t task_frames = total_frames / target_count;
+    if (task_frames < kBatchMinTaskFrames) {
+        task_frames = kBatchMinTaskFrames;
+    }
+    size_t *task_start = XMALLOC(clip_count + 1, sizeof(*task_start));
+    size_t task_count = 0, frames = 0;
+    for (size_t i = 0; i < clip_count; i++) {
+        if (i == 0 || frames >= task_frames) {
+            task_start[task_count++] = i;
+            frames = 0;
+        }
+        frames += clips[i].frame_count;
+    }
+    task_start[task_count] = clip_count;
+
+    struct decode_batch b = {
+        .clips = clips,
+        .task_start = task_start,
+        .samples = samples,
+    };
+    thread_run(thread_count, task_count, decode_batch_task, &b);
+    free(task_start);
+    size_t failure_count = 0;
+    for (size_t i = 0; i < clip_count; i++) {
+        if (clips[i].error != 0) {
+            failure_count++;
+        }
+    }
+    return failure_count;
+}
@@ -11,6 +11,49 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Calculate the state for a loop by decoding everything up to and including the
+// frame which contains the start of the loop. Returns 0 on success.
+static int audio_loop_state(const struct aiff_data *restrict aiff,
+                            struct vadpcm_loop *restrict loop) {
+    enum {
+        kChunkFrames = 256,
+    };
+    struct vadpcm_decoder decoder;
+    vadpcm_error err =
+        vadpcm_decoder_prepare(&decoder, aiff->codebook.predictor_count,
+                               aiff->codebook.order, aiff->codebook.vector);
+    if (err != 0) {
+        LOG_ERROR("invalid codebook: %s", vadpcm_error_name(err));
+        return -1;
+    }
+    int16_t *pcm = XMALLOC(kChunkFrames * kVADPCMFrameSampleCount,
+                           sizeof(*pcm));
+    struct vadpcm_vector state;
+    memset(&state, 0, sizeof(state));
+    const uint8_t *src = aiff->audio.ptr;
+    size_t frame_count = loop->start / kVADPCMFrameSampleCount + 1;
+    for (size_t pos = 0; pos < frame_count;) {
+        size_t n = frame_count - pos;
+        if (n > kChunkFrames) {
+            n = kChunkFrames;
+        }
+        err = vadpcm_decoder_decode(&decoder, &state, n, pcm,
+                                    src + pos * kVADPCMFrameByteSize);
+        if (err != 0) {
+            LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
+            free(pcm);
+            return -1;
+        }
+        pos += n;
+        if (pos == frame_count) {
+            memcpy(loop->state, pcm + (n - 1) * kVADPCMFrameSampleCount,
+                   sizeof(loop->state));
+        }
+    }
+    free(pcm);
+    return 0;
+}
+
 int audio_read_vadpcm(struct audio_vadpcm *restrict audio,
                       const char *filename) {
     struct input_file input;
@@ -25,23 +68,23 @@ int audio_read_vadpcm(struct audio_vadpcm *restrict audio,
     }
     if (aiff.codec != kAIFFCodecVADPCM) {
         LOG_ERROR("file does not contain VADPCM data");
-        goto error;
+        goto error_aiff;
     }
     if (aiff.num_channels != 1) {
         LOG_ERROR("only mono files are supported; channels=%" PRIu32,
                   aiff.num_channels);
-        goto error;
+        goto error_aiff;
     }
     if (aiff.sample_size != 16) {
         LOG_ERROR("only 16-bit samples are supported; bits=%" PRIu32,
                   aiff.sample_size);
-        goto error;
+        goto error_aiff;
     }
     if (aiff.num_sample_frames > MAX_INPUT_LENGTH) {
         LOG_ERROR("audio file is too long; length=%" PRIu32
                   ", maximum=%" PRIu32,
                   aiff.num_sample_frames, MAX_INPUT_LENGTH);
-        goto error;
+        goto error_aiff;
     }
     uint32_t frame_count =
         (aiff.num_sample_frames + kVADPCMFrameSampleCount - 1) /
@@ -50,11 +93,31 @@ int audio_read_vadpcm(struct audio_vadpcm *restrict audio,
     if (aiff.audio.size < size) {
         LOG_ERROR("audio data is too short; size=%zu, expected=%" PRIu32,
                   aiff.audio.size, size);
-        goto error;
+        goto error_aiff;
+    }
+    struct vadpcm_seek_table *seek_table = &aiff.seek_table;
+    if (seek_table->entry_count > 0 &&
+        seek_table->entry_count !=
+            vadpcm_seek_table_size(frame_count, seek_table->interval)) {
+        LOG_INFO("seek table does not match audio length, ignoring; "
+                 "entries=%zu, frames=%" PRIu32,
+                 seek_table->entry_count, frame_count);
+        free(seek_table->state);
+        *seek_table = (struct vadpcm_seek_table){0, 0, NULL};
+    }
+    struct vadpcm_loop loop = aiff.loop;
+    if (loop.end != 0) {
+        if (loop.start >= loop.end || loop.end > aiff.num_sample_frames) {
+            LOG_INFO("invalid loop, ignoring; start=%" PRIu32 ", end=%" PRIu32
+                     ", length=%" PRIu32,
+                     loop.start, loop.end, aiff.num_sample_frames);
+            memset(&loop, 0, sizeof(loop));
+        } else if (!aiff.has_loop_state) {
+            if (audio_loop_state(&aiff, &loop) != 0) {
+                goto error_aiff;
+            }
+        }
     }
-    // TODO: No copy, just keep input file mapped.
-    uint8_t *encoded_data = XMALLOC(size, 1);
-    memcpy(encoded_data, aiff.audio.ptr, size);
     *audio = (struct audio_vadpcm){
         .meta =
             {
@@ -63,16 +126,22 @@ int audio_read_vadpcm(struct audio_vadpcm *restrict audio,
                 .sample_rate = aiff.sample_rate,
             },
         .codebook = aiff.codebook,
-        .encoded_data = encoded_data,
+        .seek_table = *seek_table,
+        .loop = loop,
+        .encoded_data = aiff.audio.ptr,
+        .input = input,
     };
-    input_file_destroy(&input);
     return 0;
 
+error_aiff:
+    // The parser allocates the seek table.
+    free(aiff.seek_table.state);
 error:
     input_file_destroy(&input);
     return -1;
 }
 
 void audio_vadpcm_destroy(struct audio_vadpcm *restrict audio) {
-    free(audio->encoded_data);
+    free(audio->seek_table.state);
+    input_file_destroy(&audio->input);
 }
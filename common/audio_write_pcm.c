@@ -9,61 +9,291 @@
 #include "common/util.h"
 #include "common/wave.h"
 
-static int audio_write_aiff(struct audio_pcm *restrict audio,
-                            const char *filename, aiff_version version) {
-    swap16be_inplace(audio->sample_data, audio->meta.padded_sample_count);
-    struct aiff_data aiff = {
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Get the AIFF metadata for 16-bit PCM audio. The audio pointer is set to
+// NULL.
+static struct aiff_data audio_aiff_data(const struct audio_meta *restrict meta,
+                                        aiff_version version) {
+    return (struct aiff_data){
         .version = version,
         .version_timestamp = kAIFCVersion1,
         .num_channels = 1,
-        .num_sample_frames = audio->meta.original_sample_count,
+        .num_sample_frames = meta->original_sample_count,
         .sample_size = 16,
-        .sample_rate = audio->meta.sample_rate,
+        .sample_rate = meta->sample_rate,
         .codec = kAIFFCodecPCM,
         .audio =
             {
-                .ptr = audio->sample_data,
-                .size = sizeof(*audio->sample_data) *
-                        audio->meta.original_sample_count,
+                .ptr = NULL,
+                .size = sizeof(int16_t) * meta->original_sample_count,
             },
     };
-    return aiff_write(&aiff, filename);
 }
 
-static int audio_write_wave(struct audio_pcm *restrict audio,
-                            const char *filename) {
-    uint32_t sample_rate = uint32_from_extended(&audio->meta.sample_rate);
-    swap16le_inplace(audio->sample_data, audio->meta.padded_sample_count);
-    struct wave_data wave = {
-        .codec = kWAVECodecPCM,
+// Get the WAVE metadata for 16-bit PCM or 32-bit floating-point audio. The
+// audio pointer is set to NULL.
+static struct wave_data audio_wave_data(const struct audio_meta *restrict meta,
+                                        bool use_float) {
+    uint32_t sample_rate = uint32_from_extended(&meta->sample_rate);
+    uint32_t sample_size = use_float ? 4 : 2;
+    return (struct wave_data){
+        .codec = use_float ? kWAVECodecFloat : kWAVECodecPCM,
         .channel_count = 1,
         .sample_rate = sample_rate,
-        .bytes_per_second = 2 * sample_rate,
-        .block_align = 2,
-        .bits_per_sample = 16,
+        .bytes_per_second = sample_size * sample_rate,
+        .block_align = sample_size,
+        .bits_per_sample = 8 * sample_size,
         .audio =
             {
-                .ptr = audio->sample_data,
-                .size = sizeof(*audio->sample_data) *
-                        audio->meta.original_sample_count,
+                .ptr = NULL,
+                .size = sample_size * meta->original_sample_count,
             },
     };
-    return wave_write(&wave, filename);
 }
 
-int audio_write_pcm(struct audio_pcm *restrict audio, const char *filename,
-                    file_format format) {
+size_t sample_format_size(sample_format format) {
+    return format == kSampleFloat ? sizeof(float) : sizeof(int16_t);
+}
+
+sample_format sample_format_for_file(file_format format) {
     switch (format) {
     case kFormatAIFF:
-        return audio_write_aiff(audio, filename, kAIFF);
     case kFormatAIFC:
-        return audio_write_aiff(audio, filename, kAIFFC);
+        return kSampleBigEndian;
     case kFormatWAVE:
-        return audio_write_wave(audio, filename);
+        return kSampleLittleEndian;
+    default:
+        return kSampleNative;
+    }
+}
+
+// Convert native samples to the given format, in place.
+static void audio_swap_samples(int16_t *samples, size_t count,
+                               sample_format format) {
+    switch (format) {
+    case kSampleNative:
+    case kSampleFloat:
+        break;
+    case kSampleBigEndian:
+        swap16be_inplace(samples, count);
+        break;
+    case kSampleLittleEndian:
+        swap16le_inplace(samples, count);
+        break;
+    }
+}
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+// Convert native floating-point samples to little-endian, in place.
+static void audio_float_to_le(void *samples, size_t count) {
+    uint8_t *ptr = samples;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value;
+        memcpy(&value, ptr + 4 * i, 4);
+        write32le(ptr + 4 * i, value);
+    }
+}
+#endif
+
+// Check that a file format can store the given sample format.
+static bool audio_check_samples(sample_format samples, file_format format) {
+    if (samples == kSampleFloat && format != kFormatWAVE) {
+        LOG_ERROR("floating-point output is only supported for WAVE files");
+        return false;
+    }
+    return true;
+}
+
+int audio_write_pcm_raw(const struct audio_meta *restrict meta,
+                        const void *sample_data, sample_format samples,
+                        const char *filename, file_format format) {
+    if (!audio_check_samples(samples, format)) {
         return -1;
+    }
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if (samples == kSampleFloat) {
+        audio_float_to_le((void *)sample_data, meta->original_sample_count);
+    }
+#endif
+    switch (format) {
+    case kFormatAIFF:
+    case kFormatAIFC: {
+        struct aiff_data aiff =
+            audio_aiff_data(meta, format == kFormatAIFF ? kAIFF : kAIFFC);
+        aiff.audio.ptr = sample_data;
+        return aiff_write(&aiff, filename);
+    }
+    case kFormatWAVE: {
+        struct wave_data wave = audio_wave_data(meta, samples == kSampleFloat);
+        wave.audio.ptr = sample_data;
+        return wave_write(&wave, filename);
+    }
     default:
         LOG_ERROR("unknown format");
         return -1;
     }
+}
+
+int audio_write_pcm(struct audio_pcm *restrict audio, const char *filename,
+                    file_format format) {
+    sample_format samples = sample_format_for_file(format);
+    audio_swap_samples(audio->sample_data, audio->meta.padded_sample_count,
+                       samples);
+    return audio_write_pcm_raw(&audio->meta, audio->sample_data, samples,
+                               filename, format);
+}
+
+// Create the part of a PCM audio file which comes before the sample data,
+// using the final sizes. The header is either allocated with malloc, or stored
+// in wave_header. Returns 0 on success.
+static int audio_pcm_header(const struct audio_meta *restrict meta,
+                            file_format format, bool use_float,
+                            uint8_t **header, size_t *header_size,
+                            uint8_t *wave_header) {
+    switch (format) {
+    case kFormatAIFF:
+    case kFormatAIFC: {
+        struct aiff_data aiff =
+            audio_aiff_data(meta, format == kFormatAIFF ? kAIFF : kAIFFC);
+        return aiff_write_header(&aiff, header, header_size);
+    }
+    case kFormatWAVE: {
+        struct wave_data wave = audio_wave_data(meta, use_float);
+        *header = wave_header;
+        *header_size = kWAVEHeaderSize;
+        return wave_write_header(&wave, wave_header);
+    }
+    default:
+        LOG_ERROR("unknown format");
+        return -1;
+    }
+}
+
+int audio_pcm_writer_open(struct audio_pcm_writer *restrict writer,
+                          const char *filename, file_format format,
+                          const struct audio_meta *restrict meta,
+                          bool use_float) {
+    sample_format samples =
+        use_float ? kSampleFloat : sample_format_for_file(format);
+    if (!audio_check_samples(samples, format)) {
+        return -1;
+    }
+    // The sample count is known in advance, so the header is written with the
+    // final sizes and does not need to be patched. This works with pipes.
+    uint8_t *header;
+    size_t header_size;
+    uint8_t wave_header[kWAVEHeaderSize];
+    int r = audio_pcm_header(meta, format, use_float, &header, &header_size,
+                             wave_header);
+    if (r != 0) {
+        return -1;
+    }
+    r = output_stream_open(&writer->stream, filename);
+    if (r == 0) {
+        r = output_stream_write(&writer->stream, header, header_size);
+        if (r != 0) {
+            output_stream_close(&writer->stream);
+        }
+    }
+    if (header != wave_header) {
+        free(header);
+    }
+    if (r != 0) {
+        return -1;
+    }
+    writer->samples = samples;
+    writer->remaining = meta->original_sample_count;
     return 0;
 }
+
+int audio_pcm_writer_write(struct audio_pcm_writer *restrict writer,
+                           int16_t *samples, size_t count) {
+    if (writer->samples == kSampleFloat) {
+        LOG_ERROR("cannot write 16-bit samples to floating-point file");
+        return -1;
+    }
+    if (count > writer->remaining) {
+        count = writer->remaining;
+    }
+    audio_swap_samples(samples, count, writer->samples);
+    return audio_pcm_writer_write_raw(writer, samples, count);
+}
+
+int audio_pcm_writer_write_raw(struct audio_pcm_writer *restrict writer,
+                               const void *samples, size_t count) {
+    if (count > writer->remaining) {
+        count = writer->remaining;
+    }
+    writer->remaining -= count;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if (writer->samples == kSampleFloat) {
+        audio_float_to_le((void *)samples, count);
+    }
+#endif
+    return output_stream_write(&writer->stream, samples,
+                               sample_format_size(writer->samples) * count);
+}
+
+int audio_pcm_writer_close(struct audio_pcm_writer *restrict writer) {
+    // 16-bit and 32-bit samples never need a pad byte.
+    if (writer->remaining != 0) {
+        LOG_ERROR("output is incomplete; missing samples=%" PRIu32,
+                  writer->remaining);
+        output_stream_close(&writer->stream);
+        return -1;
+    }
+    return output_stream_close(&writer->stream);
+}
+
+int audio_vadpcm_decode_file(const struct audio_vadpcm *restrict audio,
+                             const char *filename, file_format format,
+                             bool use_float, int thread_count) {
+    sample_format samples =
+        use_float ? kSampleFloat : sample_format_for_file(format);
+    if (!audio_check_samples(samples, format)) {
+        return -1;
+    }
+    uint8_t *header;
+    size_t header_size;
+    uint8_t wave_header[kWAVEHeaderSize];
+    int r = audio_pcm_header(&audio->meta, format, use_float, &header,
+                             &header_size, wave_header);
+    if (r != 0) {
+        return -1;
+    }
+
+    // The decoder writes the padding at the end of the last frame, so the file
+    // is mapped with room for it, and truncated afterwards. 16-bit and 32-bit
+    // samples never need a pad byte.
+    size_t sample_size = sample_format_size(samples);
+    size_t file_size =
+        header_size + sample_size * audio->meta.original_sample_count;
+    struct output_map map;
+    r = output_map_open(
+        &map, filename,
+        header_size + sample_size * audio->meta.padded_sample_count);
+    if (r == 0) {
+        uint8_t *sample_data = (uint8_t *)map.data + header_size;
+        memcpy(map.data, header, header_size);
+        r = audio_vadpcm_decode(audio, sample_data, samples, thread_count);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        if (r == 0 && samples == kSampleFloat) {
+            audio_float_to_le(sample_data, audio->meta.original_sample_count);
+        }
+#endif
+        // Do not leave a partial file behind if decoding failed.
+        if (r == 0) {
+            r = output_map_close(&map, file_size);
+        } else {
+            output_map_abort(&map);
+        }
+    }
+    if (header != wave_header) {
+        free(header);
+    }
+    return r;
+}
@@ -0,0 +1,76 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/audio.h"
+
+#include "codec/vadpcm.h"
+#include "common/aiff.h"
+#include "common/util.h"
+
+#include <stdlib.h>
+
+bool parse_seek_interval(const char *arg, uint32_t *interval) {
+    char *end;
+    unsigned long value = strtoul(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0') {
+        LOG_ERROR("invalid value for --seek-interval");
+        return false;
+    }
+    if (value < 1 || 0xffffffff < value) {
+        LOG_ERROR("seek interval must be positive");
+        return false;
+    }
+    *interval = (uint32_t)value;
+    return true;
+}
+
+int audio_write_vadpcm(const struct audio_meta *restrict meta,
+                       const struct vadpcm_codebook *restrict codebook,
+                       const void *encoded_data, uint32_t seek_interval,
+                       const char *filename) {
+    size_t frame_count = meta->padded_sample_count / kVADPCMFrameSampleCount;
+
+    // Build the seek table by decoding the encoded data.
+    struct vadpcm_seek_table seek_table = {0, 0, NULL};
+    if (seek_interval > 0) {
+        struct vadpcm_decoder decoder;
+        vadpcm_error err =
+            vadpcm_decoder_prepare(&decoder, codebook->predictor_count,
+                                   codebook->order, codebook->vector);
+        if (err == 0) {
+            seek_table.interval = seek_interval;
+            seek_table.entry_count =
+                vadpcm_seek_table_size(frame_count, seek_interval);
+            seek_table.state =
+                XMALLOC(seek_table.entry_count, sizeof(*seek_table.state));
+            err = vadpcm_seek_table_build(&seek_table, &decoder, frame_count,
+                                          encoded_data);
+        }
+        if (err != 0) {
+            LOG_ERROR("could not create seek table: %s",
+                      vadpcm_error_name(err));
+            free(seek_table.state);
+            return -1;
+        }
+    }
+
+    struct aiff_data aiff = {
+        .version = kAIFFC,
+        .version_timestamp = kAIFCVersion1,
+        .num_channels = 1,
+        .num_sample_frames = meta->original_sample_count,
+        .sample_size = 16,
+        .sample_rate = meta->sample_rate,
+        .codec = kAIFFCodecVADPCM,
+        .audio =
+            {
+                .ptr = encoded_data,
+                .size = frame_count * kVADPCMFrameByteSize,
+            },
+        .codebook = *codebook,
+        .seek_table = seek_table,
+    };
+    int r = aiff_write(&aiff, filename);
+    free(seek_table.state);
+    return r;
+}
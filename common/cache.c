@@ -0,0 +1,221 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/cache.h"
+
+#include "codec/vadpcm.h"
+#include "common/util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    // Number of entries in each set.
+    kCacheWays = 4,
+
+    // Number of words in a decoder state.
+    kCacheStateWords = sizeof(struct vadpcm_vector) / sizeof(size_t),
+};
+
+// Metadata for one cache entry. Each field is accessed atomically. Writers
+// must first change the sequence number from even to odd, so only one thread
+// writes to an entry at a time. Readers check that the sequence number is the
+// same before and after reading an entry, and otherwise discard what they
+// read.
+struct block_cache_entry {
+    // Sequence number. Odd while the entry is being written.
+    size_t seq;
+    // Clip and block index. The clip is zero if the entry is empty.
+    size_t clip;
+    size_t block;
+    // Value of the cache clock when the entry was last inserted or found.
+    size_t last_use;
+};
+
+struct block_cache {
+    size_t block_frames;
+    size_t set_count;
+    // Number of words of data for each entry. The decoded samples come first,
+    // followed by the decoder state.
+    size_t entry_words;
+    struct block_cache_entry *entries;
+    size_t *data;
+    // Incremented each time an entry is used, to find the least recently used
+    // entry.
+    size_t clock;
+    size_t hit_count;
+    size_t miss_count;
+    size_t insert_count;
+    size_t eviction_count;
+};
+
+// Return the number of words in the given number of decoded frames.
+static size_t block_cache_words(size_t frame_count) {
+    return frame_count * kVADPCMFrameSampleCount * sizeof(int16_t) /
+           sizeof(size_t);
+}
+
+// Return the first entry in the set for a block.
+static size_t block_cache_set(const struct block_cache *cache, size_t clip,
+                              size_t block) {
+    // Mix the bits, so that neighboring blocks are in different sets.
+    uint64_t hash = (uint64_t)clip * 0x9e3779b97f4a7c15u + block;
+    hash ^= hash >> 29;
+    hash *= 0xbf58476d1ce4e5b9u;
+    hash ^= hash >> 32;
+    return (size_t)(hash % cache->set_count) * kCacheWays;
+}
+
+struct block_cache *block_cache_create(size_t memory_budget,
+                                       size_t block_frames) {
+    size_t frames = 1;
+    while (frames < block_frames) {
+        frames <<= 1;
+    }
+    size_t entry_words = block_cache_words(frames) + kCacheStateWords;
+    size_t entry_size =
+        sizeof(struct block_cache_entry) + sizeof(size_t) * entry_words;
+    size_t set_count = memory_budget / (entry_size * kCacheWays);
+    if (set_count < 1) {
+        set_count = 1;
+    }
+    struct block_cache *cache = XMALLOC(1, sizeof(*cache));
+    memset(cache, 0, sizeof(*cache));
+    cache->block_frames = frames;
+    cache->set_count = set_count;
+    cache->entry_words = entry_words;
+    cache->entries =
+        XCALLOC(set_count * kCacheWays, sizeof(struct block_cache_entry));
+    cache->data = XMALLOC(set_count * kCacheWays * entry_words, sizeof(size_t));
+    // Zero is the last use of empty entries.
+    cache->clock = 1;
+    return cache;
+}
+
+void block_cache_destroy(struct block_cache *cache) {
+    free(cache->entries);
+    free(cache->data);
+    free(cache);
+}
+
+size_t block_cache_block_frames(const struct block_cache *cache) {
+    return cache->block_frames;
+}
+
+bool block_cache_lookup(struct block_cache *cache, const void *clip,
+                        size_t block, size_t frame_count, int16_t *dest,
+                        struct vadpcm_vector *state) {
+    size_t key = (size_t)(uintptr_t)clip;
+    size_t first = block_cache_set(cache, key, block);
+    for (int way = 0; way < kCacheWays; way++) {
+        struct block_cache_entry *entry = &cache->entries[first + way];
+        size_t seq = thread_load_acquire(&entry->seq);
+        if ((seq & 1) != 0 || thread_load_acquire(&entry->clip) != key ||
+            thread_load_acquire(&entry->block) != block) {
+            continue;
+        }
+        const size_t *data = cache->data + cache->entry_words * (first + way);
+        thread_load_words(dest, data, block_cache_words(frame_count));
+        thread_load_words(state, data + cache->entry_words - kCacheStateWords,
+                          kCacheStateWords);
+        if (thread_load_acquire(&entry->seq) != seq) {
+            // The entry was replaced while it was copied.
+            break;
+        }
+        thread_store_release(&entry->last_use,
+                             thread_fetch_add(&cache->clock, 1));
+        thread_fetch_add(&cache->hit_count, 1);
+        return true;
+    }
+    thread_fetch_add(&cache->miss_count, 1);
+    return false;
+}
+
+void block_cache_insert(struct block_cache *cache, const void *clip,
+                        size_t block, size_t frame_count, const int16_t *pcm,
+                        const struct vadpcm_vector *state) {
+    size_t key = (size_t)(uintptr_t)clip;
+    size_t first = block_cache_set(cache, key, block);
+
+    // Choose the least recently used entry in the set. Entries which are
+    // being written are skipped.
+    int victim = -1;
+    size_t victim_seq = 0, oldest = 0;
+    for (int way = 0; way < kCacheWays; way++) {
+        struct block_cache_entry *entry = &cache->entries[first + way];
+        size_t seq = thread_load_acquire(&entry->seq);
+        if ((seq & 1) != 0) {
+            continue;
+        }
+        if (thread_load_acquire(&entry->clip) == key &&
+            thread_load_acquire(&entry->block) == block) {
+            // Another thread already inserted this block.
+            return;
+        }
+        size_t last_use = thread_load_acquire(&entry->last_use);
+        if (victim < 0 || last_use < oldest) {
+            victim = way;
+            victim_seq = seq;
+            oldest = last_use;
+        }
+    }
+    if (victim < 0) {
+        return;
+    }
+    struct block_cache_entry *entry = &cache->entries[first + victim];
+    if (!thread_compare_exchange(&entry->seq, victim_seq, victim_seq + 1)) {
+        return;
+    }
+    bool evicted = thread_load_acquire(&entry->clip) != 0;
+    size_t *data = cache->data + cache->entry_words * (first + victim);
+    thread_store_release(&entry->clip, key);
+    thread_store_release(&entry->block, block);
+    thread_store_words(data, pcm, block_cache_words(frame_count));
+    thread_store_words(data + cache->entry_words - kCacheStateWords, state,
+                       kCacheStateWords);
+    thread_store_release(&entry->last_use,
+                         thread_fetch_add(&cache->clock, 1));
+    thread_store_release(&entry->seq, victim_seq + 2);
+    thread_fetch_add(&cache->insert_count, 1);
+    if (evicted) {
+        thread_fetch_add(&cache->eviction_count, 1);
+    }
+}
+
+void block_cache_invalidate(struct block_cache *cache, const void *clip) {
+    size_t key = (size_t)(uintptr_t)clip;
+    size_t entry_count = cache->set_count * kCacheWays;
+    for (size_t i = 0; i < entry_count; i++) {
+        struct block_cache_entry *entry = &cache->entries[i];
+        for (;;) {
+            size_t seq = thread_load_acquire(&entry->seq);
+            if ((seq & 1) == 0 && thread_load_acquire(&entry->clip) != key) {
+                break;
+            }
+            // An entry being written may be an insert for another clip, so
+            // try again once it is finished.
+            if ((seq & 1) != 0 ||
+                !thread_compare_exchange(&entry->seq, seq, seq + 1)) {
+                continue;
+            }
+            // Empty entries are replaced first.
+            thread_store_release(&entry->clip, 0);
+            thread_store_release(&entry->block, 0);
+            thread_store_release(&entry->last_use, 0);
+            thread_store_release(&entry->seq, seq + 2);
+            break;
+        }
+    }
+}
+
+void block_cache_get_stats(struct block_cache *cache,
+                           struct block_cache_stats *stats) {
+    *stats = (struct block_cache_stats){
+        .hit_count = thread_load_acquire(&cache->hit_count),
+        .miss_count = thread_load_acquire(&cache->miss_count),
+        .insert_count = thread_load_acquire(&cache->insert_count),
+        .eviction_count = thread_load_acquire(&cache->eviction_count),
+        .entry_count = cache->set_count * kCacheWays,
+        .block_frames = cache->block_frames,
+    };
+}
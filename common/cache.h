@@ -0,0 +1,79 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct vadpcm_vector;
+
+// A cache of decoded audio, so clips which are played repeatedly do not have
+// to be decoded each time. Each entry holds one block of frames from a clip,
+// and the decoder state at the end of the block. Entries are identified by the
+// clip's encoded data pointer and the block index. The cache assumes that each
+// clip is always decoded from the beginning, so the decoder state at the start
+// of a block is always the same. Before a clip's encoded data is freed or
+// changed, its blocks must be removed with block_cache_invalidate(), or a clip
+// which later uses the same memory would find the old blocks.
+//
+// The cache is set-associative, and the least recently used entry in a set is
+// replaced when a new entry is inserted. Any number of threads may use the
+// cache at the same time. Lookups do not lock or wait. If a lookup races with
+// an insert into the same entry, the lookup is a miss.
+struct block_cache;
+
+// Cache telemetry.
+struct block_cache_stats {
+    // Number of lookups which found the block, and which did not.
+    size_t hit_count;
+    size_t miss_count;
+
+    // Number of blocks inserted, and the number of blocks which were replaced
+    // by an insert.
+    size_t insert_count;
+    size_t eviction_count;
+
+    // Number of entries in the cache, and the number of frames in each block.
+    size_t entry_count;
+    size_t block_frames;
+};
+
+// Create a cache which uses at most memory_budget bytes for its entries. Each
+// entry holds block_frames frames, rounded up to a power of two. The cache
+// always has room for at least a few entries, even if they exceed the budget.
+struct block_cache *block_cache_create(size_t memory_budget,
+                                       size_t block_frames);
+
+// Free a cache. No other threads may be using it.
+void block_cache_destroy(struct block_cache *cache);
+
+// Return the number of frames in each block.
+size_t block_cache_block_frames(const struct block_cache *cache);
+
+// Look up a block in the cache. The frame count is the number of frames in the
+// block, which is less than the block size only for the last block of a clip.
+// On a hit, copies the decoded samples to dest and the decoder state at the
+// end of the block to state, and returns true. On a miss, returns false, and
+// dest and state may have been modified.
+bool block_cache_lookup(struct block_cache *cache, const void *clip,
+                        size_t block, size_t frame_count, int16_t *dest,
+                        struct vadpcm_vector *state);
+
+// Insert a decoded block into the cache, with the decoder state at the end of
+// the block. The insert is skipped if another thread is inserting into the same
+// entry at the same time.
+void block_cache_insert(struct block_cache *cache, const void *clip,
+                        size_t block, size_t frame_count, const int16_t *pcm,
+                        const struct vadpcm_vector *state);
+
+// Remove all blocks for a clip from the cache. This checks every entry, so it
+// takes time proportional to the size of the cache. Lookups may run at the
+// same time, but no other thread may insert blocks for the clip until this
+// returns.
+void block_cache_invalidate(struct block_cache *cache, const void *clip);
+
+// Get the cache telemetry. May be called from any thread.
+void block_cache_get_stats(struct block_cache *cache,
+                           struct block_cache_stats *stats);
@@ -85,6 +85,34 @@ error:
     return -1;
 }
 
+int output_map_open(struct output_map *restrict map, const char *filename,
+                    size_t size) {
+    // The data is written to the file when it is closed.
+    *map = (struct output_map){
+        .data = XMALLOC(size, 1),
+        .size = size,
+        .filename = filename,
+        .temp_filename = NULL,
+        .fd = -1,
+        .is_mapped = false,
+    };
+    return 0;
+}
+
+void output_map_abort(struct output_map *restrict map) {
+    free(map->data);
+}
+
+int output_map_close(struct output_map *restrict map, size_t size) {
+    struct byteslice data = {
+        .ptr = map->data,
+        .size = size,
+    };
+    int r = output_file_write(map->filename, &data, 1);
+    free(map->data);
+    return r;
+}
+
 #else
 
 #define _FILE_OFFSET_BITS 64
@@ -95,7 +123,9 @@ error:
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
@@ -203,4 +233,147 @@ error:
     return -1;
 }
 
-#endif
\ No newline at end of file
+// Set the size of a file which will be mapped. If possible, the space is
+// allocated now, so running out of space does not cause SIGBUS later.
+static int output_map_allocate(int fd, size_t size) {
+#if __linux__
+    int r = posix_fallocate(fd, 0, size);
+    if (r != EINVAL && r != EOPNOTSUPP) {
+        return r;
+    }
+#endif
+    return ftruncate(fd, size) == 0 ? 0 : errno;
+}
+
+// Write a buffer to a file descriptor. Returns 0 or an error code.
+static int output_write_all(int fd, const void *data, size_t size) {
+    const char *ptr = data;
+    while (size > 0) {
+        ssize_t amt = write(fd, ptr, size);
+        if (amt < 0) {
+            if (errno != EINTR) {
+                return errno;
+            }
+        } else {
+            ptr += amt;
+            size -= amt;
+        }
+    }
+    return 0;
+}
+
+// Create the temporary file for an output file, next to the output file so it
+// can be renamed over it.
+static char *output_temp_filename(const char *filename) {
+    static const char kSuffix[] = ".tmp";
+    size_t len = strlen(filename);
+    char *temp_filename = XMALLOC(len + sizeof(kSuffix), 1);
+    memcpy(temp_filename, filename, len);
+    memcpy(temp_filename + len, kSuffix, sizeof(kSuffix));
+    return temp_filename;
+}
+
+int output_map_open(struct output_map *restrict map, const char *filename,
+                    size_t size) {
+    // Devices and pipes are written directly, and cannot be mapped. Regular
+    // files are written to a temporary file which replaces the file once it is
+    // complete, so a failure does not destroy an existing file.
+    struct stat st;
+    char *temp_filename = NULL;
+    int fd;
+    if (stat(filename, &st) == 0 && !S_ISREG(st.st_mode)) {
+        fd = open(filename, O_WRONLY);
+    } else {
+        temp_filename = output_temp_filename(filename);
+        // Mapping the file for writing requires read access.
+        fd = open(temp_filename, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    }
+    if (fd == -1) {
+        LOG_ERROR_ERRNO(errno, "could not create");
+        free(temp_filename);
+        return -1;
+    }
+    *map = (struct output_map){
+        .size = size,
+        .filename = filename,
+        .temp_filename = temp_filename,
+        .fd = fd,
+        .is_mapped = temp_filename != NULL && size > 0,
+    };
+    if (!map->is_mapped) {
+        map->data = XMALLOC(size, 1);
+        return 0;
+    }
+    int errcode = output_map_allocate(fd, size);
+    if (errcode != 0) {
+        LOG_ERROR_ERRNO(errcode, "could not allocate");
+        goto error;
+    }
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR_ERRNO(errno, "could not mmap");
+        goto error;
+    }
+    map->data = ptr;
+    return 0;
+error:
+    close(fd);
+    if (temp_filename != NULL) {
+        unlink(temp_filename);
+    }
+    free(temp_filename);
+    return -1;
+}
+
+// Release the data and close the file. Returns 0 or an error code.
+static int output_map_release(struct output_map *restrict map) {
+    int errcode = 0;
+    if (map->is_mapped) {
+        if (munmap(map->data, map->size) != 0) {
+            errcode = errno;
+        }
+    } else {
+        free(map->data);
+    }
+    if (close(map->fd) != 0 && errcode == 0) {
+        errcode = errno;
+    }
+    return errcode;
+}
+
+int output_map_close(struct output_map *restrict map, size_t size) {
+    int errcode = 0;
+    if (map->is_mapped) {
+        if (size < map->size && ftruncate(map->fd, size) != 0) {
+            errcode = errno;
+        }
+    } else {
+        errcode = output_write_all(map->fd, map->data, size);
+    }
+    int r = output_map_release(map);
+    if (errcode == 0) {
+        errcode = r;
+    }
+    if (errcode == 0 && map->temp_filename != NULL &&
+        rename(map->temp_filename, map->filename) != 0) {
+        errcode = errno;
+    }
+    if (errcode != 0) {
+        LOG_ERROR_ERRNO(errcode, "could not write");
+        if (map->temp_filename != NULL) {
+            unlink(map->temp_filename);
+        }
+    }
+    free(map->temp_filename);
+    return errcode == 0 ? 0 : -1;
+}
+
+void output_map_abort(struct output_map *restrict map) {
+    output_map_release(map);
+    if (map->temp_filename != NULL) {
+        unlink(map->temp_filename);
+    }
+    free(map->temp_filename);
+}
+
+#endif
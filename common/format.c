@@ -63,6 +63,25 @@ file_format format_for_file(const char *filename) {
     return kFormatUnknown;
 }
 
+static const struct {
+    char name[5];
+    file_format format;
+} kFormatOptionNames[] = {
+    {"aifc", kFormatAIFC},
+    {"aiff", kFormatAIFF},
+    {"wav", kFormatWAVE},
+};
+
+file_format format_for_name(const char *name) {
+    for (size_t i = 0;
+         i < sizeof(kFormatOptionNames) / sizeof(*kFormatOptionNames); i++) {
+        if (strcmp(kFormatOptionNames[i].name, name) == 0) {
+            return kFormatOptionNames[i].format;
+        }
+    }
+    return kFormatUnknown;
+}
+
 static const char kFormatNames[][7] = {
     [kFormatAIFF] = "AIFF",
     [kFormatAIFC] = "AIFF-C",
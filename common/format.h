@@ -14,6 +14,10 @@ typedef enum {
 // Figure out the filetype for a file, if we can.
 file_format format_for_file(const char *filename);
 
+// Get the format with the given name, as used on the command line: "aiff",
+// "aifc", or "wav".
+file_format format_for_name(const char *name);
+
 // Return the name for a file extension.
 const char *name_for_format(file_format fmt);
 
@@ -0,0 +1,190 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/player.h"
+
+#include "codec/vadpcm.h"
+#include "common/audio.h"
+#include "common/cache.h"
+#include "common/ring.h"
+#include "common/util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    // Maximum number of frames to decode before making them available.
+    kPlayerChunkFrames = 64,
+
+    // How long the decoding thread sleeps when the buffer is full.
+    kPlayerSleepMS = 1,
+};
+
+struct player {
+    struct ring_buffer ring;
+    struct vadpcm_decoder decoder;
+    struct vadpcm_vector state;
+    const uint8_t *src;
+    size_t frame_count;
+    // Number of samples to play, without padding.
+    size_t sample_count;
+    // Cache of decoded blocks, or NULL.
+    struct block_cache *cache;
+    struct thread *thread;
+
+    // Set by the owner to stop the decoding thread.
+    size_t stop;
+    // Set by the decoding thread.
+    size_t decode_done;
+    size_t decode_error;
+    // Set by the consumer.
+    size_t position;
+    size_t min_fill;
+    size_t underrun_count;
+    size_t underrun_samples;
+};
+
+// Decode frames into the ring buffer, or copy them from the cache. With a
+// cache, the frames must be exactly one block, starting at a block boundary.
+static void player_decode_frames(struct player *restrict player, size_t frame,
+                                 size_t frame_count, int16_t *dest) {
+    size_t block = 0;
+    if (player->cache != NULL) {
+        block = frame / block_cache_block_frames(player->cache);
+        if (block_cache_lookup(player->cache, player->src, block, frame_count,
+                               dest, &player->state)) {
+            return;
+        }
+    }
+    vadpcm_error err = vadpcm_decoder_decode(
+        &player->decoder, &player->state, frame_count, dest,
+        player->src + frame * kVADPCMFrameByteSize);
+    if (err != 0) {
+        thread_store_release(&player->decode_error, 1);
+    } else if (player->cache != NULL) {
+        block_cache_insert(player->cache, player->src, block, frame_count,
+                           dest, &player->state);
+    }
+}
+
+// Decoding thread. Decodes frames into the ring buffer as space is available.
+static void player_decode(void *ctx) {
+    struct player *restrict player = ctx;
+    size_t chunk_frames = kPlayerChunkFrames;
+    if (player->cache != NULL) {
+        chunk_frames = block_cache_block_frames(player->cache);
+    }
+    size_t frame = 0;
+    while (frame < player->frame_count &&
+           thread_load_acquire(&player->stop) == 0) {
+        int16_t *ptr;
+        size_t space = ring_buffer_write_space(&player->ring, &ptr) /
+                       kVADPCMFrameSampleCount;
+        size_t n = chunk_frames;
+        if (n > player->frame_count - frame) {
+            n = player->frame_count - frame;
+        }
+        if (player->cache == NULL && n > space) {
+            n = space;
+        }
+        // Cached blocks are written all at once, so wait until there is room
+        // for the entire block.
+        if (n == 0 || n > space) {
+            thread_sleep(kPlayerSleepMS);
+            continue;
+        }
+        player_decode_frames(player, frame, n, ptr);
+        ring_buffer_commit(&player->ring, n * kVADPCMFrameSampleCount);
+        frame += n;
+    }
+    thread_store_release(&player->decode_done, 1);
+}
+
+struct player *player_create(const struct audio_vadpcm *audio,
+                             size_t buffer_size, struct block_cache *cache) {
+    struct player *player = XMALLOC(1, sizeof(*player));
+    memset(player, 0, sizeof(*player));
+    vadpcm_error err = vadpcm_decoder_prepare(
+        &player->decoder, audio->codebook.predictor_count,
+        audio->codebook.order, audio->codebook.vector);
+    if (err != 0) {
+        LOG_ERROR("invalid codebook: %s", vadpcm_error_name(err));
+        free(player);
+        return NULL;
+    }
+    // The decoding thread writes whole frames, so the buffer must hold at
+    // least one. Because the capacity is a power of two, free space at the
+    // write position is then always a whole number of frames.
+    if (buffer_size < kVADPCMFrameSampleCount) {
+        buffer_size = kVADPCMFrameSampleCount;
+    }
+    // Likewise, with a cache, the buffer must hold at least one block. The
+    // block size is also a power of two, so the free space at the write
+    // position is eventually large enough for a block.
+    if (cache != NULL) {
+        size_t block_size =
+            block_cache_block_frames(cache) * kVADPCMFrameSampleCount;
+        if (buffer_size < block_size) {
+            buffer_size = block_size;
+        }
+    }
+    ring_buffer_init(&player->ring, buffer_size);
+    player->src = audio->encoded_data;
+    player->frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    player->sample_count = audio->meta.original_sample_count;
+    player->cache = cache;
+    player->min_fill = player->ring.capacity;
+    player->thread = thread_create(player_decode, player);
+    if (player->thread == NULL) {
+        LOG_ERROR("could not create decoding thread");
+        ring_buffer_destroy(&player->ring);
+        free(player);
+        return NULL;
+    }
+    return player;
+}
+
+size_t player_read(struct player *player, int16_t *dest, size_t count) {
+    // Check for the end of decoding before reading, so that if decoding is
+    // done, all of the audio is already in the buffer.
+    bool decode_done = thread_load_acquire(&player->decode_done) != 0;
+    size_t fill = ring_buffer_fill(&player->ring);
+    if (fill < player->min_fill) {
+        thread_store_release(&player->min_fill, fill);
+    }
+    size_t want = player->sample_count - player->position;
+    if (want > count) {
+        want = count;
+    }
+    size_t n = ring_buffer_read(&player->ring, dest, want);
+    thread_store_release(&player->position, player->position + n);
+    if (n < want && !decode_done) {
+        thread_store_release(&player->underrun_count,
+                             player->underrun_count + 1);
+        thread_store_release(&player->underrun_samples,
+                             player->underrun_samples + (want - n));
+    }
+    memset(dest + n, 0, sizeof(*dest) * (count - n));
+    return n;
+}
+
+void player_get_stats(struct player *player, struct player_stats *stats) {
+    *stats = (struct player_stats){
+        .underrun_count = thread_load_acquire(&player->underrun_count),
+        .underrun_samples = thread_load_acquire(&player->underrun_samples),
+        .fill = ring_buffer_fill(&player->ring),
+        .min_fill = thread_load_acquire(&player->min_fill),
+        .capacity = player->ring.capacity,
+        .position = thread_load_acquire(&player->position),
+        .decode_done = thread_load_acquire(&player->decode_done) != 0,
+        .decode_error = thread_load_acquire(&player->decode_error) != 0,
+    };
+}
+
+void player_destroy(struct player *player) {
+    thread_store_release(&player->stop, 1);
+    thread_join(player->thread);
+    ring_buffer_destroy(&player->ring);
+    free(player);
+}
@@ -0,0 +1,59 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct audio_vadpcm;
+struct block_cache;
+
+// A player decodes VADPCM audio on a background thread into a ring buffer. The
+// consumer, such as an audio callback, reads blocks of samples from the buffer
+// without locking or waiting. If the buffer does not have enough samples, the
+// rest of the block is filled with silence and counted as an underrun.
+struct player;
+
+// Player telemetry.
+struct player_stats {
+    // Number of reads which were filled with silence because the buffer did
+    // not have enough samples, and the total number of silent samples.
+    size_t underrun_count;
+    size_t underrun_samples;
+
+    // Number of samples in the buffer, the lowest number seen at the start of
+    // a read, and the buffer capacity.
+    size_t fill;
+    size_t min_fill;
+    size_t capacity;
+
+    // Number of audio samples read, not counting silence.
+    size_t position;
+
+    // True if the background thread has decoded all of the audio.
+    bool decode_done;
+
+    // True if any of the audio could not be decoded.
+    bool decode_error;
+};
+
+// Create a player and start decoding. The buffer holds at least buffer_size
+// samples. If cache is not NULL, decoded blocks are copied from the cache when
+// they are present, and added to the cache when they are not. The audio and
+// cache must not be modified or destroyed until the player is destroyed.
+// Returns NULL on failure.
+struct player *player_create(const struct audio_vadpcm *audio,
+                             size_t buffer_size, struct block_cache *cache);
+
+// Read count samples. Returns the number of audio samples read. The rest of
+// dest is filled with silence, which is an underrun unless the end of the
+// audio was reached. Only one thread may read from a player.
+size_t player_read(struct player *player, int16_t *dest, size_t count);
+
+// Get the player telemetry. May be called from any thread.
+void player_get_stats(struct player *player, struct player_stats *stats);
+
+// Stop decoding and free the player.
+void player_destroy(struct player *player);
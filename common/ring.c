@@ -0,0 +1,69 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/ring.h"
+
+#include "common/util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void ring_buffer_init(struct ring_buffer *restrict ring, size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    ring->data = XMALLOC(size, sizeof(*ring->data));
+    ring->capacity = size;
+    ring->write_pos = 0;
+    ring->read_pos = 0;
+}
+
+void ring_buffer_destroy(struct ring_buffer *restrict ring) {
+    free(ring->data);
+}
+
+size_t ring_buffer_fill(const struct ring_buffer *restrict ring) {
+    // Load the read position first, so the write position is never behind it.
+    // On a third thread, both may move in between, so the result is clamped.
+    size_t read_pos = thread_load_acquire(&ring->read_pos);
+    size_t write_pos = thread_load_acquire(&ring->write_pos);
+    size_t fill = write_pos - read_pos;
+    return fill < ring->capacity ? fill : ring->capacity;
+}
+
+size_t ring_buffer_write_space(struct ring_buffer *restrict ring,
+                               int16_t **ptr) {
+    // The consumer releases read_pos after copying out the samples, so the
+    // space is free once the new position is visible.
+    size_t read_pos = thread_load_acquire(&ring->read_pos);
+    size_t write_pos = ring->write_pos;
+    size_t free_space = ring->capacity - (write_pos - read_pos);
+    size_t offset = write_pos & (ring->capacity - 1);
+    size_t contiguous = ring->capacity - offset;
+    *ptr = ring->data + offset;
+    return free_space < contiguous ? free_space : contiguous;
+}
+
+void ring_buffer_commit(struct ring_buffer *restrict ring, size_t count) {
+    thread_store_release(&ring->write_pos, ring->write_pos + count);
+}
+
+size_t ring_buffer_read(struct ring_buffer *restrict ring,
+                        int16_t *restrict dest, size_t count) {
+    size_t write_pos = thread_load_acquire(&ring->write_pos);
+    size_t read_pos = ring->read_pos;
+    size_t available = write_pos - read_pos;
+    if (count > available) {
+        count = available;
+    }
+    size_t offset = read_pos & (ring->capacity - 1);
+    size_t first = ring->capacity - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(dest, ring->data + offset, sizeof(*dest) * first);
+    memcpy(dest + first, ring->data, sizeof(*dest) * (count - first));
+    thread_store_release(&ring->read_pos, read_pos + count);
+    return count;
+}
@@ -0,0 +1,46 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A lock-free ring buffer of 16-bit samples, with one producer thread and one
+// consumer thread. Neither side ever blocks. The read and write positions count
+// samples since the buffer was created, and only the low bits are used to
+// index the buffer.
+struct ring_buffer {
+    int16_t *data;
+    // Number of samples in the buffer. A power of two.
+    size_t capacity;
+    // Total number of samples written. Only modified by the producer.
+    size_t write_pos;
+    // Total number of samples read. Only modified by the consumer.
+    size_t read_pos;
+};
+
+// Initialize a ring buffer with room for at least the given number of
+// samples. The capacity is rounded up to a power of two.
+void ring_buffer_init(struct ring_buffer *restrict ring, size_t capacity);
+
+// Free the memory used by a ring buffer.
+void ring_buffer_destroy(struct ring_buffer *restrict ring);
+
+// Return the number of samples available to read. May be called from any
+// thread, but the result is only exact on the consumer thread.
+size_t ring_buffer_fill(const struct ring_buffer *restrict ring);
+
+// Get the contiguous free space at the write position. Returns the number of
+// samples which may be written to *ptr. Producer only.
+size_t ring_buffer_write_space(struct ring_buffer *restrict ring,
+                               int16_t **ptr);
+
+// Make samples written to the free space available to the consumer. Producer
+// only.
+void ring_buffer_commit(struct ring_buffer *restrict ring, size_t count);
+
+// Read up to count samples into dest. Returns the number of samples read.
+// Consumer only.
+size_t ring_buffer_read(struct ring_buffer *restrict ring,
+                        int16_t *restrict dest, size_t count);
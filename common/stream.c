@@ -0,0 +1,68 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/util.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+int output_stream_open(struct output_stream *restrict stream,
+                       const char *filename) {
+    if (strcmp(filename, "-") == 0) {
+#if _WIN32
+        if (_setmode(_fileno(stdout), _O_BINARY) == -1) {
+            LOG_ERROR_ERRNO(errno, "could not set standard output to binary");
+            return -1;
+        }
+#endif
+        *stream = (struct output_stream){
+            .file = stdout,
+            .is_stdout = true,
+        };
+        return 0;
+    }
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) {
+        LOG_ERROR_ERRNO(errno, "could not open");
+        return -1;
+    }
+    *stream = (struct output_stream){
+        .file = file,
+        .is_stdout = false,
+    };
+    return 0;
+}
+
+int output_stream_write(struct output_stream *restrict stream,
+                        const void *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    size_t amt = fwrite(data, 1, size, stream->file);
+    if (amt != size) {
+        LOG_ERROR_ERRNO(errno, "could not write");
+        return -1;
+    }
+    return 0;
+}
+
+int output_stream_close(struct output_stream *restrict stream) {
+    int r;
+    if (stream->is_stdout) {
+        r = fflush(stream->file);
+    } else {
+        r = fclose(stream->file);
+    }
+    stream->file = NULL;
+    if (r != 0) {
+        LOG_ERROR_ERRNO(errno, "could not write");
+        return -1;
+    }
+    return 0;
+}
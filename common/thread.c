@@ -0,0 +1,266 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+
+#if _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+
+#include "common/util.h"
+
+#include <Windows.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef HANDLE thread_handle;
+
+#else
+
+#define _DEFAULT_SOURCE 1
+
+#include "common/util.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef pthread_t thread_handle;
+
+#endif
+
+struct thread {
+    thread_handle handle;
+    thread_func func;
+    void *ctx;
+};
+
+#if _WIN32
+
+size_t thread_load_acquire(const size_t *ptr) {
+    size_t value = *(const volatile size_t *)ptr;
+    MemoryBarrier();
+    return value;
+}
+
+void thread_store_release(size_t *ptr, size_t value) {
+    MemoryBarrier();
+    *(volatile size_t *)ptr = value;
+}
+
+size_t thread_fetch_add(size_t *ptr, size_t value) {
+#if _WIN64
+    return (size_t)InterlockedExchangeAdd64((volatile LONG64 *)ptr,
+                                            (LONG64)value);
+#else
+    return (size_t)InterlockedExchangeAdd((volatile LONG *)ptr, (LONG)value);
+#endif
+}
+
+bool thread_compare_exchange(size_t *ptr, size_t expected, size_t desired) {
+#if _WIN64
+    return (size_t)InterlockedCompareExchange64(
+               (volatile LONG64 *)ptr, (LONG64)desired, (LONG64)expected) ==
+           expected;
+#else
+    return (size_t)InterlockedCompareExchange(
+               (volatile LONG *)ptr, (LONG)desired, (LONG)expected) ==
+           expected;
+#endif
+}
+
+void thread_load_words(void *restrict dest, const size_t *src, size_t count) {
+    unsigned char *ptr = dest;
+    for (size_t i = 0; i < count; i++) {
+        size_t value = ((const volatile size_t *)src)[i];
+        memcpy(ptr + sizeof(size_t) * i, &value, sizeof(size_t));
+    }
+    MemoryBarrier();
+}
+
+void thread_store_words(size_t *dest, const void *restrict src, size_t count) {
+    const unsigned char *ptr = src;
+    MemoryBarrier();
+    for (size_t i = 0; i < count; i++) {
+        size_t value;
+        memcpy(&value, ptr + sizeof(size_t) * i, sizeof(size_t));
+        ((volatile size_t *)dest)[i] = value;
+    }
+}
+
+static DWORD WINAPI thread_main(LPVOID arg) {
+    struct thread *thread = arg;
+    thread->func(thread->ctx);
+    return 0;
+}
+
+int thread_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+static int thread_start(struct thread *thread) {
+    HANDLE h = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+    if (h == NULL) {
+        return -1;
+    }
+    thread->handle = h;
+    return 0;
+}
+
+static void thread_wait(struct thread *thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void thread_sleep(int milliseconds) {
+    Sleep(milliseconds);
+}
+
+#else
+
+size_t thread_load_acquire(const size_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+void thread_store_release(size_t *ptr, size_t value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+size_t thread_fetch_add(size_t *ptr, size_t value) {
+    return __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+bool thread_compare_exchange(size_t *ptr, size_t expected, size_t desired) {
+    return __atomic_compare_exchange_n(ptr, &expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+void thread_load_words(void *restrict dest, const size_t *src, size_t count) {
+    unsigned char *ptr = dest;
+    for (size_t i = 0; i < count; i++) {
+        size_t value = __atomic_load_n(&src[i], __ATOMIC_ACQUIRE);
+        memcpy(ptr + sizeof(size_t) * i, &value, sizeof(size_t));
+    }
+}
+
+void thread_store_words(size_t *dest, const void *restrict src, size_t count) {
+    const unsigned char *ptr = src;
+    for (size_t i = 0; i < count; i++) {
+        size_t value;
+        memcpy(&value, ptr + sizeof(size_t) * i, sizeof(size_t));
+        __atomic_store_n(&dest[i], value, __ATOMIC_RELEASE);
+    }
+}
+
+static void *thread_main(void *arg) {
+    struct thread *thread = arg;
+    thread->func(thread->ctx);
+    return NULL;
+}
+
+int thread_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count < 1) {
+        return 1;
+    }
+    return count > INT32_MAX ? INT32_MAX : (int)count;
+}
+
+static int thread_start(struct thread *thread) {
+    return pthread_create(&thread->handle, NULL, thread_main, thread) == 0
+               ? 0
+               : -1;
+}
+
+static void thread_wait(struct thread *thread) {
+    pthread_join(thread->handle, NULL);
+}
+
+void thread_sleep(int milliseconds) {
+    struct timespec ts = {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = (long)(milliseconds % 1000) * 1000000,
+    };
+    // Sleep for the remaining time if interrupted by a signal. Other errors,
+    // such as an invalid time, would never succeed.
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+#endif
+
+struct thread *thread_create(thread_func func, void *ctx) {
+    struct thread *thread = XMALLOC(1, sizeof(*thread));
+    thread->func = func;
+    thread->ctx = ctx;
+    if (thread_start(thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void thread_join(struct thread *thread) {
+    thread_wait(thread);
+    free(thread);
+}
+
+// Shared state for all threads in thread_run().
+struct thread_pool {
+    size_t next;
+    size_t task_count;
+    thread_task_func func;
+    void *ctx;
+};
+
+// Run tasks until there are none left.
+static void thread_pool_work(void *arg) {
+    struct thread_pool *pool = arg;
+    for (;;) {
+        size_t task = thread_fetch_add(&pool->next, 1);
+        if (task >= pool->task_count) {
+            break;
+        }
+        pool->func(pool->ctx, task);
+    }
+}
+
+void thread_run(int thread_count, size_t task_count, thread_task_func func,
+                void *ctx) {
+    struct thread_pool pool = {
+        .next = 0,
+        .task_count = task_count,
+        .func = func,
+        .ctx = ctx,
+    };
+    // The calling thread is one of the threads, and there is no point in
+    // having more threads than tasks.
+    size_t extra = thread_count > 1 ? (size_t)thread_count - 1 : 0;
+    if (task_count == 0) {
+        extra = 0;
+    } else if (extra > task_count - 1) {
+        extra = task_count - 1;
+    }
+    struct thread **threads = NULL;
+    size_t started = 0;
+    if (extra > 0) {
+        threads = XMALLOC(extra, sizeof(*threads));
+        while (started < extra) {
+            threads[started] = thread_create(thread_pool_work, &pool);
+            if (threads[started] == NULL) {
+                break;
+            }
+            started++;
+        }
+    }
+    thread_pool_work(&pool);
+    for (size_t i = 0; i < started; i++) {
+        thread_join(threads[i]);
+    }
+    free(threads);
+}
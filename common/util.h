@@ -3,8 +3,10 @@
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #pragma once
 #include "common/defs.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 struct byteslice;
 
@@ -99,6 +101,110 @@ int input_file_read(struct input_file *file, const char *filename);
 int output_file_write(const char *filename, const struct byteslice *data,
                       size_t count);
 
+// An output file which is written in place through memory, so data can be
+// written directly into the file without a copy.
+struct output_map {
+    // Contents of the file, which are written by the caller.
+    void *data;
+    size_t size;
+    const char *filename;
+    // Temporary file which is renamed to the filename when the output is
+    // finished, or NULL if the output is written to the file directly.
+    char *temp_filename;
+    int fd;
+    // If false, the file cannot be mapped, so the data is a buffer which is
+    // written to the file when it is closed.
+    bool is_mapped;
+};
+
+// Create an output file with the given size, and map it into memory for
+// writing. Space for the file is allocated up front where supported, so
+// running out of space is reported here. An existing regular file is not
+// replaced until the output is finished.
+int output_map_open(struct output_map *restrict map, const char *filename,
+                    size_t size);
+
+// Finish writing a mapped output file and close it, truncating it to the given
+// size, which must be no larger than the mapped size.
+int output_map_close(struct output_map *restrict map, size_t size);
+
+// Close a mapped output file without finishing it. The temporary file is
+// removed, and any existing file is left unchanged.
+void output_map_abort(struct output_map *restrict map);
+
+// An output file which is written sequentially, a piece at a time. This can
+// write to a pipe.
+struct output_stream {
+    FILE *file;
+    bool is_stdout;
+};
+
+// Open an output stream. The filename "-" is standard output.
+int output_stream_open(struct output_stream *restrict stream,
+                       const char *filename);
+
+// Write data to an output stream.
+int output_stream_write(struct output_stream *restrict stream,
+                        const void *data, size_t size);
+
+// Flush and close an output stream. Returns an error if any data could not be
+// written.
+int output_stream_close(struct output_stream *restrict stream);
+
+// ============================================================================
+// Threads
+// ============================================================================
+
+// Return the number of processors available, or 1 if it cannot be determined.
+int thread_cpu_count(void);
+
+// Atomically load a value, with acquire ordering.
+size_t thread_load_acquire(const size_t *ptr);
+
+// Atomically store a value, with release ordering.
+void thread_store_release(size_t *ptr, size_t value);
+
+// Atomically add to a value and return the previous value, with relaxed
+// ordering.
+size_t thread_fetch_add(size_t *ptr, size_t value);
+
+// Atomically replace a value if it is equal to expected, with acquire and
+// release ordering. Returns true if the value was replaced.
+bool thread_compare_exchange(size_t *ptr, size_t expected, size_t desired);
+
+// Copy count words which may be modified concurrently by another thread, with
+// acquire ordering for each load. The destination does not need to be aligned.
+void thread_load_words(void *restrict dest, const size_t *src, size_t count);
+
+// Copy count words which may be read concurrently by another thread, with
+// release ordering for each store. The source does not need to be aligned.
+void thread_store_words(size_t *dest, const void *restrict src, size_t count);
+
+// A thread started with thread_create().
+struct thread;
+
+// Function which runs on a new thread.
+typedef void (*thread_func)(void *ctx);
+
+// Start a thread which runs func(ctx). Returns NULL if the thread could not be
+// created.
+struct thread *thread_create(thread_func func, void *ctx);
+
+// Wait for a thread to finish, and free it.
+void thread_join(struct thread *thread);
+
+// Sleep the calling thread for at least the given number of milliseconds.
+void thread_sleep(int milliseconds);
+
+// Function which runs one task. The task index is passed in.
+typedef void (*thread_task_func)(void *ctx, size_t task);
+
+// Run tasks 0..task_count-1, using up to thread_count threads including the
+// calling thread, and wait for all tasks to complete. Tasks may run in any
+// order. If threads cannot be created, the remaining threads run all tasks.
+void thread_run(int thread_count, size_t task_count, thread_task_func func,
+                void *ctx);
+
 // ============================================================================
 // Misc
 // ============================================================================
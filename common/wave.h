@@ -11,6 +11,11 @@ enum {
     kWAVECodecFloat = 3,
 };
 
+enum {
+    // Size of the part of a WAVE file before the sample data.
+    kWAVEHeaderSize = 44,
+};
+
 // A parsed WAVE file.
 struct wave_data {
     // fmt chunk.
@@ -29,5 +34,10 @@ struct wave_data {
 int wave_parse(struct wave_data *restrict wave, const uint8_t *ptr,
                size_t size);
 
+// Create the part of a WAVE file which comes before the sample data. Only the
+// size of the audio data is used, not its contents. If the size is odd, a pad
+// byte must be written after the audio data. Returns 0 on success.
+int wave_write_header(const struct wave_data *restrict wave, uint8_t *hdr);
+
 // Write a WAVE file to disk. Returns 0 on success.
 int wave_write(struct wave_data *restrict wave, const char *filename);
@@ -6,7 +6,7 @@
 #include "common/binary.h"
 #include "common/wave_internal.h"
 
-int wave_write(struct wave_data *restrict wave, const char *filename) {
+int wave_write_header(const struct wave_data *restrict wave, uint8_t *hdr) {
     if (wave->audio.size > 0xffffffff - 1) {
         LOG_ERROR("audio data too large");
         return -1;
@@ -16,7 +16,6 @@ int wave_write(struct wave_data *restrict wave, const char *filename) {
     // 12 byte header
     // 8 + 16 byte fmt
     // 8 + N byte data
-    uint8_t hdr[44], zero;
     write32be(hdr, WAVE_RIFF);
     write32le(hdr + 4, data_size + 36);
     write32be(hdr + 8, WAVE_WAVE);
@@ -30,9 +29,17 @@ int wave_write(struct wave_data *restrict wave, const char *filename) {
     write16le(hdr + 34, wave->bits_per_sample);
     write32be(hdr + 36, WAVE_DATA);
     write32le(hdr + 40, data_size);
-    zero = 0;
+    return 0;
+}
+
+int wave_write(struct wave_data *restrict wave, const char *filename) {
+    uint8_t hdr[kWAVEHeaderSize], zero = 0;
+    int r = wave_write_header(wave, hdr);
+    if (r != 0) {
+        return r;
+    }
     struct byteslice chunks[3] = {
-        {.ptr = hdr, .size = 44},
+        {.ptr = hdr, .size = kWAVEHeaderSize},
         wave->audio,
         {.ptr = &zero, .size = wave->audio.size & 1},
     };
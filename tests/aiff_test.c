@@ -0,0 +1,268 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/aiff.h"
+#include "common/binary.h"
+#include "common/util.h"
+#include "tests/test.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// An AIFF-C file being built in memory.
+struct aiff_builder {
+    uint8_t data[512];
+    size_t size;
+    size_t chunk_start;
+};
+
+static void builder_u16(struct aiff_builder *b, uint16_t value) {
+    write16be(b->data + b->size, value);
+    b->size += 2;
+}
+
+static void builder_u32(struct aiff_builder *b, uint32_t value) {
+    write32be(b->data + b->size, value);
+    b->size += 4;
+}
+
+static void builder_bytes(struct aiff_builder *b, const void *ptr,
+                          size_t size) {
+    memcpy(b->data + b->size, ptr, size);
+    b->size += size;
+}
+
+static void builder_begin(struct aiff_builder *b, uint32_t id) {
+    builder_u32(b, id);
+    b->chunk_start = b->size;
+    builder_u32(b, 0);
+}
+
+static void builder_end(struct aiff_builder *b) {
+    write32be(b->data + b->chunk_start,
+              (uint32_t)(b->size - b->chunk_start - 4));
+    if ((b->size & 1) != 0) {
+        b->data[b->size++] = 0;
+    }
+}
+
+// Start an AIFF-C file with uncompressed audio.
+static void builder_init(struct aiff_builder *b) {
+    static const uint8_t kRate[10] = {0x40, 0x0d, 0xfa};
+    b->size = 0;
+    builder_u32(b, FOURCC('F', 'O', 'R', 'M'));
+    builder_u32(b, 0);
+    builder_u32(b, FOURCC('A', 'I', 'F', 'C'));
+    builder_begin(b, FOURCC('C', 'O', 'M', 'M'));
+    builder_u16(b, 1);
+    builder_u32(b, 1000);
+    builder_u16(b, 16);
+    builder_bytes(b, kRate, sizeof(kRate));
+    builder_u32(b, FOURCC('N', 'O', 'N', 'E'));
+    builder_bytes(b, "\0", 2);
+    builder_end(b);
+    builder_begin(b, FOURCC('S', 'S', 'N', 'D'));
+    builder_u32(b, 0);
+    builder_u32(b, 0);
+    builder_end(b);
+}
+
+static void builder_mark(struct aiff_builder *b) {
+    builder_begin(b, FOURCC('M', 'A', 'R', 'K'));
+    builder_u16(b, 3);
+    builder_u16(b, 7);
+    builder_u32(b, 500);
+    builder_bytes(b, "\3end", 4);
+    builder_u16(b, 1);
+    builder_u32(b, 0);
+    builder_bytes(b, "\0", 2);
+    builder_u16(b, 2);
+    builder_u32(b, 123);
+    builder_bytes(b, "\5start", 6);
+    builder_end(b);
+}
+
+static void builder_inst(struct aiff_builder *b) {
+    static const uint8_t kHeader[8] = {60, 0, 0, 127, 1, 127, 0, 0};
+    builder_begin(b, FOURCC('I', 'N', 'S', 'T'));
+    builder_bytes(b, kHeader, sizeof(kHeader));
+    // Sustain loop, then release loop.
+    builder_u16(b, 1);
+    builder_u16(b, 2);
+    builder_u16(b, 7);
+    builder_u16(b, 0);
+    builder_u16(b, 0);
+    builder_u16(b, 0);
+    builder_end(b);
+}
+
+static void builder_loops(struct aiff_builder *b) {
+    static const uint8_t kName[12] = {11,  'V', 'A', 'D', 'P', 'C',
+                                      'M', 'L', 'O', 'O', 'P', 'S'};
+    builder_begin(b, FOURCC('A', 'P', 'P', 'L'));
+    builder_u32(b, FOURCC('s', 't', 'o', 'c'));
+    builder_bytes(b, kName, sizeof(kName));
+    builder_u16(b, 1);
+    builder_u16(b, 1);
+    builder_u32(b, 48);
+    builder_u32(b, 900);
+    builder_u32(b, 0xffffffff);
+    for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+        builder_u16(b, (uint16_t)(i * 1000 - 3000));
+    }
+    builder_end(b);
+}
+
+// Add a codebook with one predictor of order 2.
+static void builder_codebook(struct aiff_builder *b) {
+    static const uint8_t kName[12] = {11,  'V', 'A', 'D', 'P', 'C',
+                                      'M', 'C', 'O', 'D', 'E', 'S'};
+    builder_begin(b, FOURCC('A', 'P', 'P', 'L'));
+    builder_u32(b, FOURCC('s', 't', 'o', 'c'));
+    builder_bytes(b, kName, sizeof(kName));
+    builder_u16(b, 1);
+    builder_u16(b, 2);
+    builder_u16(b, 1);
+    for (int i = 0; i < 2 * kVADPCMVectorSampleCount; i++) {
+        builder_u16(b, (uint16_t)(i * 100));
+    }
+    builder_end(b);
+}
+
+// Add a seek table of order 2 with three entries. The first entry is normally
+// zero.
+static void builder_seek_table(struct aiff_builder *b, int16_t first) {
+    static const uint8_t kName[12] = {11,  'V', 'A', 'D', 'P', 'C',
+                                      'M', 'S', 'E', 'E', 'K', 'S'};
+    builder_begin(b, FOURCC('A', 'P', 'P', 'L'));
+    builder_u32(b, FOURCC('s', 't', 'o', 'c'));
+    builder_bytes(b, kName, sizeof(kName));
+    builder_u16(b, 1);
+    builder_u16(b, 2);
+    builder_u32(b, 16);
+    builder_u32(b, 3);
+    builder_u16(b, 0);
+    builder_u16(b, (uint16_t)first);
+    for (int i = 0; i < 4; i++) {
+        builder_u16(b, (uint16_t)(i * 10 + 5));
+    }
+    builder_end(b);
+}
+
+static void builder_finish(struct aiff_builder *b) {
+    write32be(b->data + 4, (uint32_t)(b->size - 8));
+}
+
+void test_aiff_loops(void) {
+    static const struct {
+        const char *name;
+        bool inst;
+        bool loops;
+        uint32_t start;
+        uint32_t end;
+        bool has_state;
+    } kCases[] = {
+        {"none", false, false, 0, 0, false},
+        {"inst", true, false, 123, 500, false},
+        {"vadpcm", false, true, 48, 900, true},
+        {"both", true, true, 48, 900, true},
+    };
+    bool failed = false;
+    for (size_t i = 0; i < sizeof(kCases) / sizeof(*kCases); i++) {
+        struct aiff_builder b;
+        builder_init(&b);
+        if (kCases[i].inst) {
+            builder_inst(&b);
+            builder_mark(&b);
+        }
+        if (kCases[i].loops) {
+            builder_loops(&b);
+        }
+        builder_finish(&b);
+        struct aiff_data aiff;
+        if (aiff_parse(&aiff, b.data, b.size) != 0) {
+            fprintf(stderr, "error: test_aiff_loops %s: parse failed\n",
+                    kCases[i].name);
+            failed = true;
+            continue;
+        }
+        if (aiff.loop.start != kCases[i].start ||
+            aiff.loop.end != kCases[i].end ||
+            aiff.has_loop_state != kCases[i].has_state ||
+            (aiff.loop.end != 0 && aiff.loop.count != 0xffffffff)) {
+            fprintf(stderr,
+                    "error: test_aiff_loops %s: loop = %u..%u, state = %d\n",
+                    kCases[i].name, (unsigned)aiff.loop.start,
+                    (unsigned)aiff.loop.end, aiff.has_loop_state);
+            failed = true;
+        }
+        // The state is the whole decoded frame which contains the start of
+        // the loop, as written by vadpcm_enc.
+        if (kCases[i].has_state) {
+            for (int j = 0; j < kVADPCMFrameSampleCount; j++) {
+                if (aiff.loop.state[j] != j * 1000 - 3000) {
+                    fprintf(stderr,
+                            "error: test_aiff_loops %s: state[%d] = %d\n",
+                            kCases[i].name, j, aiff.loop.state[j]);
+                    failed = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (failed) {
+        test_failure_count++;
+    }
+}
+
+void test_aiff_seek_table(void) {
+    static const struct {
+        const char *name;
+        int16_t first;
+        bool truncate;
+        int result;
+        size_t entry_count;
+    } kCases[] = {
+        {"valid", 0, false, 0, 3},
+        {"nonzero", 7, false, 0, 0},
+        // The table is freed when a later chunk fails to parse.
+        {"error", 0, true, -1, 0},
+    };
+    bool failed = false;
+    for (size_t i = 0; i < sizeof(kCases) / sizeof(*kCases); i++) {
+        struct aiff_builder b;
+        builder_init(&b);
+        builder_codebook(&b);
+        builder_seek_table(&b, kCases[i].first);
+        if (kCases[i].truncate) {
+            builder_begin(&b, FOURCC('F', 'V', 'E', 'R'));
+            builder_end(&b);
+        }
+        builder_finish(&b);
+        struct aiff_data aiff;
+        int r = aiff_parse(&aiff, b.data, b.size);
+        if (r != kCases[i].result ||
+            aiff.seek_table.entry_count != kCases[i].entry_count ||
+            (aiff.seek_table.state == NULL) != (kCases[i].entry_count == 0)) {
+            fprintf(stderr,
+                    "error: test_aiff_seek_table %s: result = %d, "
+                    "entries = %zu\n",
+                    kCases[i].name, r, aiff.seek_table.entry_count);
+            failed = true;
+        } else if (r == 0 && aiff.seek_table.entry_count > 0 &&
+                   (aiff.seek_table.state[1].v[6] != 5 ||
+                    aiff.seek_table.state[1].v[7] != 15)) {
+            fprintf(stderr, "error: test_aiff_seek_table %s: state = %d, %d\n",
+                    kCases[i].name, aiff.seek_table.state[1].v[6],
+                    aiff.seek_table.state[1].v[7]);
+            failed = true;
+        }
+        free(aiff.codebook.vector);
+        free(aiff.seek_table.state);
+    }
+    if (failed) {
+        test_failure_count++;
+    }
+}
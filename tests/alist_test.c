@@ -0,0 +1,596 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/alist.h"
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "common/util.h"
+#include "tests/test.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    kAlistRDRAMSize = 0x2000,
+    kAlistMaxCommands = 32,
+    kAlistADPCMFrames = 8,
+    kAlistSamples = 16,
+};
+
+// An interpreter and a command list under construction.
+struct alist_test {
+    const char *name;
+    struct vadpcm_alist *alist;
+    uint8_t *rdram;
+    size_t command_count;
+    uint32_t commands[kAlistMaxCommands * 2];
+};
+
+static void alist_test_init(struct alist_test *t, const char *name) {
+    t->name = name;
+    t->alist = XMALLOC(1, sizeof(*t->alist));
+    t->rdram = XCALLOC(kAlistRDRAMSize, 1);
+    t->command_count = 0;
+    vadpcm_alist_init(t->alist, t->rdram, kAlistRDRAMSize);
+}
+
+static void alist_test_destroy(struct alist_test *t) {
+    free(t->alist);
+    free(t->rdram);
+}
+
+// Append a command. The argument is the low 16 bits of the first word.
+static void alist_command(struct alist_test *t, int opcode, int flags,
+                          uint32_t arg, uint32_t w2) {
+    uint32_t *cmd = &t->commands[t->command_count * 2];
+    cmd[0] = ((uint32_t)opcode << 24) | ((uint32_t)flags << 16) |
+             (arg & 0xffff);
+    cmd[1] = w2;
+    t->command_count++;
+}
+
+// Append a SETBUFF command for the main buffers.
+static void alist_setbuff(struct alist_test *t, uint32_t in, uint32_t out,
+                          uint32_t count) {
+    alist_command(t, kVADPCMAlistSetBuff, 0, in, (out << 16) | count);
+}
+
+// Run the pending commands. Returns the number of failures.
+static int alist_exec(struct alist_test *t) {
+    vadpcm_error err =
+        vadpcm_alist_run(t->alist, t->command_count, t->commands);
+    t->command_count = 0;
+    if (err != 0) {
+        fprintf(stderr, "error: test_alist %s: command %zu: %s\n", t->name,
+                t->alist->error_command, vadpcm_error_name2(err));
+        return 1;
+    }
+    return 0;
+}
+
+// Write big-endian samples to main memory.
+static void alist_put(struct alist_test *t, uint32_t address,
+                      const int16_t *samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        t->rdram[address + i * 2] = (uint16_t)samples[i] >> 8;
+        t->rdram[address + i * 2 + 1] = (uint8_t)samples[i];
+    }
+}
+
+static int alist_get(const struct alist_test *t, uint32_t address) {
+    return (int16_t)((t->rdram[address] << 8) | t->rdram[address + 1]);
+}
+
+// Compare big-endian samples in main memory. Returns the number of failures.
+static int alist_check(const struct alist_test *t, const char *what,
+                       uint32_t address, const int16_t *expect,
+                       size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int value = alist_get(t, address + (uint32_t)i * 2);
+        if (value != expect[i]) {
+            fprintf(stderr,
+                    "error: test_alist %s: %s: index %zu = %d, expected %d\n",
+                    t->name, what, i, value, expect[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void alist_random(uint32_t *rng, int16_t *samples, size_t count) {
+    uint32_t state = *rng;
+    for (size_t i = 0; i < count; i++) {
+        state = vadpcm_rng(state);
+        samples[i] = (int16_t)(state >> 16);
+    }
+    *rng = state;
+}
+
+// Test ADPCM decoding against the codec, in two calls, with the state saved in
+// a segment.
+static int test_alist_adpcm(void) {
+    struct alist_test t;
+    alist_test_init(&t, "adpcm");
+    uint32_t rng = 4321;
+    struct vadpcm_vector codebook[4];
+    uint8_t data[kAlistADPCMFrames * kVADPCMFrameByteSize];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            rng = vadpcm_rng(rng);
+            codebook[i].v[j] = (int)(rng >> 20) - (1 << 11);
+        }
+    }
+    for (size_t i = 0; i < sizeof(data); i++) {
+        rng = vadpcm_rng(rng);
+        data[i] = rng >> 24;
+    }
+    for (int i = 0; i < kAlistADPCMFrames; i++) {
+        data[i * kVADPCMFrameByteSize] = (uint8_t)((i % 13) << 4 | (i & 1));
+    }
+    // The microcode decodes scaling factors above 12 as 12.
+    data[3 * kVADPCMFrameByteSize] = 0xe1;
+    alist_put(&t, 0, &codebook[0].v[0], 4 * kVADPCMVectorSampleCount);
+    memcpy(t.rdram + 0x100, data, sizeof(data));
+
+    uint8_t clamped[sizeof(data)];
+    memcpy(clamped, data, sizeof(data));
+    clamped[3 * kVADPCMFrameByteSize] = 0xc1;
+    int16_t expect[kAlistADPCMFrames * kVADPCMFrameSampleCount];
+    struct vadpcm_vector state = {{0}};
+    vadpcm_decode(2, 2, codebook, &state, kAlistADPCMFrames, expect, clamped);
+
+    // State is in segment 1.
+    const int half = kAlistADPCMFrames / 2;
+    const uint32_t half_bytes = half * 32;
+    alist_command(&t, kVADPCMAlistSegment, 0, 0, 0x01001000);
+    alist_command(&t, kVADPCMAlistLoadADPCM, 0, 64, 0);
+    alist_setbuff(&t, 0, 0, sizeof(data));
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x100);
+    alist_setbuff(&t, 0, 0x100, half_bytes);
+    alist_command(&t, kVADPCMAlistADPCM, kVADPCMAlistInit, 0, 0x01000200);
+    alist_setbuff(&t, half * kVADPCMFrameByteSize, 0x200, half_bytes);
+    alist_command(&t, kVADPCMAlistADPCM, 0, 0, 0x01000200);
+    alist_setbuff(&t, 0, 0x100, half_bytes + 32);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x300);
+    alist_setbuff(&t, 0, 0x200, half_bytes + 32);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x400);
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    // Each output starts with the last frame of the previous output.
+    static const int16_t kZero[kVADPCMFrameSampleCount];
+    const int16_t *second = expect + half * kVADPCMFrameSampleCount;
+    failures += alist_check(&t, "initial state", 0x300, kZero,
+                            kVADPCMFrameSampleCount);
+    failures += alist_check(&t, "first output", 0x320, expect,
+                            half * kVADPCMFrameSampleCount);
+    failures += alist_check(&t, "continued state", 0x400,
+                            second - kVADPCMFrameSampleCount,
+                            kVADPCMFrameSampleCount);
+    failures += alist_check(&t, "second output", 0x420, second,
+                            half * kVADPCMFrameSampleCount);
+    failures += alist_check(
+        &t, "saved state", 0x1200,
+        expect + (kAlistADPCMFrames - 1) * kVADPCMFrameSampleCount,
+        kVADPCMFrameSampleCount);
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// Test the mixing and buffer commands.
+static int test_alist_mix(void) {
+    struct alist_test t;
+    alist_test_init(&t, "mix");
+    uint32_t rng = 999;
+    int16_t a[kAlistSamples], b[kAlistSamples], expect[kAlistSamples * 2];
+    alist_random(&rng, a, kAlistSamples);
+    alist_random(&rng, b, kAlistSamples);
+    b[0] = 0x7ff0;
+    a[0] = 0x7fff;
+    alist_put(&t, 0x000, a, kAlistSamples);
+    alist_put(&t, 0x100, b, kAlistSamples);
+    const uint32_t size = kAlistSamples * 2;
+    alist_setbuff(&t, 0x000, 0, size);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x000);
+    alist_setbuff(&t, 0x100, 0, size);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x100);
+
+    // Move A so it is at 0x300 and 0x000.
+    alist_command(&t, kVADPCMAlistDMEMMove, 0, 0x000, (0x300 << 16) | size);
+    alist_setbuff(&t, 0, 0x300, size);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x300);
+
+    // B += A * 0.5.
+    alist_command(&t, kVADPCMAlistMixer, 0, 0x4000, 0x100);
+
+    // Interleave A and B.
+    alist_setbuff(&t, 0, 0x400, size);
+    alist_command(&t, kVADPCMAlistInterleave, 0, 0, (0x000 << 16) | 0x100);
+    alist_setbuff(&t, 0, 0x400, size * 2);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x400);
+
+    // Clear A.
+    alist_command(&t, kVADPCMAlistClearBuff, 0, 0x000, size);
+    alist_setbuff(&t, 0, 0x000, size);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x500);
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    failures += alist_check(&t, "dmemmove", 0x300, a, kAlistSamples);
+    for (int i = 0; i < kAlistSamples; i++) {
+        int value = b[i] + ((a[i] * 0x4000 + 0x4000) >> 15);
+        value = value > 0x7fff ? 0x7fff : value < -0x8000 ? -0x8000 : value;
+        expect[i * 2] = a[i];
+        expect[i * 2 + 1] = (int16_t)value;
+    }
+    failures += alist_check(&t, "interleave", 0x400, expect, kAlistSamples * 2);
+    memset(expect, 0, sizeof(expect));
+    failures += alist_check(&t, "clearbuff", 0x500, expect, kAlistSamples);
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// Test the envelope mixer with a constant volume, in two calls.
+static int test_alist_envmixer(void) {
+    struct alist_test t;
+    alist_test_init(&t, "envmixer");
+    uint32_t rng = 31337;
+    int16_t in[kAlistSamples * 2];
+    alist_random(&rng, in, kAlistSamples * 2);
+    alist_put(&t, 0x000, in, kAlistSamples * 2);
+    const uint32_t size = kAlistSamples * 2;
+    const int volume[2] = {0x4000, 0x1234};
+    const int dry = 0x7fff;
+    alist_setbuff(&t, 0, 0, size * 2);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x000);
+    for (int i = 0; i < 2; i++) {
+        int left = i == 0 ? kVADPCMAlistLeft : 0;
+        alist_command(&t, kVADPCMAlistSetVol, left | kVADPCMAlistVol,
+                      volume[i], 0);
+        alist_command(&t, kVADPCMAlistSetVol, left, volume[i], 0);
+    }
+    alist_command(&t, kVADPCMAlistSetVol, kVADPCMAlistAux, dry, 0);
+    alist_command(&t, kVADPCMAlistClearBuff, 0, 0x100, size * 2);
+    alist_command(&t, kVADPCMAlistClearBuff, 0, 0x200, size * 2);
+    alist_command(&t, kVADPCMAlistSetBuff, kVADPCMAlistAux, 0x200, 0);
+    alist_setbuff(&t, 0, 0x100, size);
+    alist_command(&t, kVADPCMAlistEnvMixer, kVADPCMAlistInit, 0, 0x1000);
+    alist_command(&t, kVADPCMAlistSetBuff, kVADPCMAlistAux, 0x200 + size, 0);
+    alist_setbuff(&t, size, 0x100 + size, size);
+    alist_command(&t, kVADPCMAlistEnvMixer, 0, 0, 0x1000);
+    alist_setbuff(&t, 0, 0x100, size * 2);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x100);
+    alist_setbuff(&t, 0, 0x200, size * 2);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x200);
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    for (int ch = 0; ch < 2; ch++) {
+        int gain = (volume[ch] * dry + 0x4000) >> 15;
+        int16_t expect[kAlistSamples * 2];
+        for (int i = 0; i < kAlistSamples * 2; i++) {
+            expect[i] = (int16_t)((in[i] * gain + 0x4000) >> 15);
+        }
+        failures += alist_check(&t, ch == 0 ? "left" : "right",
+                                0x100 + ch * 0x100, expect, kAlistSamples * 2);
+    }
+    if (alist_get(&t, 0x1004) != dry) {
+        fprintf(stderr, "error: test_alist envmixer: saved dry = %d\n",
+                alist_get(&t, 0x1004));
+        failures++;
+    }
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// Test resampling with a custom table and the pole filter, in two calls each.
+static int test_alist_filters(void) {
+    struct alist_test t;
+    alist_test_init(&t, "filters");
+    // Every phase averages the two middle samples.
+    int16_t table[kVADPCMAlistResampleTableSize];
+    for (int i = 0; i < kVADPCMAlistResampleTableSize; i++) {
+        table[i] = (i & 3) == 1 || (i & 3) == 2 ? 0x4000 : 0;
+    }
+    t.alist->resample_table = table;
+    uint32_t rng = 2024;
+    int16_t in[kAlistSamples * 2];
+    alist_random(&rng, in, kAlistSamples * 2);
+    alist_put(&t, 0x000, in, kAlistSamples);
+    alist_put(&t, 0x100, in + kAlistSamples, kAlistSamples);
+    const uint32_t size = kAlistSamples * 2;
+    alist_setbuff(&t, 0x010, 0, size);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x000);
+    alist_setbuff(&t, 0x110, 0, size);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x100);
+    // Pitch 1.0.
+    alist_setbuff(&t, 0x010, 0x200, size);
+    alist_command(&t, kVADPCMAlistResample, kVADPCMAlistInit, 0x8000,
+                  0x1000);
+    alist_setbuff(&t, 0x110, 0x200 + size, size);
+    alist_command(&t, kVADPCMAlistResample, 0, 0x8000, 0x1000);
+    alist_setbuff(&t, 0, 0x200, size * 2);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x200);
+
+    // With a zero table and unity gain, the pole filter passes its input.
+    alist_setbuff(&t, 0x010, 0x300, size);
+    alist_command(&t, kVADPCMAlistPoleF, kVADPCMAlistInit, 0x4000, 0x1100);
+    alist_setbuff(&t, 0x110, 0x300 + size, size);
+    alist_command(&t, kVADPCMAlistPoleF, 0, 0x4000, 0x1100);
+    alist_setbuff(&t, 0, 0x300, size * 2);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x300);
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    int16_t expect[kAlistSamples * 2];
+    for (int i = 0; i < kAlistSamples * 2; i++) {
+        int x0 = i >= 3 ? in[i - 3] : 0;
+        int x1 = i >= 2 ? in[i - 2] : 0;
+        expect[i] = (int16_t)((x0 * 0x4000 + x1 * 0x4000) >> 15);
+    }
+    failures += alist_check(&t, "resample", 0x200, expect, kAlistSamples * 2);
+    failures += alist_check(&t, "polef", 0x300, in, kAlistSamples * 2);
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// The expected output in the tests below was computed with a separate model of
+// the established high-level emulation of the microcode (mupen64plus-rsp-hle),
+// so it does not depend on the codec.
+
+// Test ADPCM decoding which starts from the loop state.
+static int test_alist_adpcm_loop(void) {
+    static const int16_t kCodebook[2 * 2 * kVADPCMVectorSampleCount] = {
+        -1700, -2989, -3843, -4275, -4325, -4054, -3537, -2853,
+        3600, 4628, 5146, 5204, 4876, 4251, 3425, 2491,
+        -300, -264, -189, -128, -85, -56, -37, -25,
+        1800, 1282, 863, 570, 374, 245, 160, 104,
+    };
+    static const uint8_t kControl[4] = {0x40, 0xb1, 0xe0, 0x71};
+    static const int16_t kExpect[4 * kVADPCMFrameSampleCount] = {
+        21238, 19714, 16918, 13478, 9613, 5802, 2306, -858,
+        -3327, -5024, -6166, -6573, -6340, -5769, -4814, -3611,
+        -10661, -10888, -20294, -26479, -18247, -8059, -10547, -8077,
+        -5554, -5745, -12423, -26455, -19381, 1180, -10453, -5250,
+        3544, 22880, 32767, 32767, 32767, 32767, 32767, 32767,
+        -2369, -31377, -24529, -8881, -11641, -32768, -24816, -28048,
+        -20505, -13653, -8600, -6310, -4149, -2079, -1338, -1749,
+        -1086, -570, -1237, -875, -76, 574, -252, 80,
+    };
+    struct alist_test t;
+    alist_test_init(&t, "adpcm loop");
+    uint32_t rng = 5150;
+    uint8_t data[4 * kVADPCMFrameByteSize];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        rng = vadpcm_rng(rng);
+        data[i] = rng >> 24;
+    }
+    for (int i = 0; i < 4; i++) {
+        data[i * kVADPCMFrameByteSize] = kControl[i];
+    }
+    int16_t loop[kVADPCMFrameSampleCount];
+    alist_random(&rng, loop, kVADPCMFrameSampleCount);
+    alist_put(&t, 0x000, kCodebook, sizeof(kCodebook) / 2);
+    memcpy(t.rdram + 0x100, data, sizeof(data));
+    alist_put(&t, 0x200, loop, kVADPCMFrameSampleCount);
+    // The saved state is not used when looping.
+    memset(t.rdram + 0x300, 0x55, 32);
+
+    const uint32_t size = sizeof(kExpect);
+    alist_command(&t, kVADPCMAlistLoadADPCM, 0, sizeof(kCodebook), 0x000);
+    alist_setbuff(&t, 0, 0, sizeof(data));
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x100);
+    alist_command(&t, kVADPCMAlistSetLoop, 0, 0, 0x200);
+    alist_setbuff(&t, 0, 0x100, size);
+    alist_command(&t, kVADPCMAlistADPCM, kVADPCMAlistLoop, 0, 0x300);
+    alist_setbuff(&t, 0, 0x100, size + 32);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x400);
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    failures += alist_check(&t, "loop state", 0x400, loop,
+                            kVADPCMFrameSampleCount);
+    failures += alist_check(&t, "output", 0x420, kExpect,
+                            4 * kVADPCMFrameSampleCount);
+    failures += alist_check(&t, "saved state", 0x300,
+                            kExpect + 3 * kVADPCMFrameSampleCount,
+                            kVADPCMFrameSampleCount);
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// Test the envelope mixer with volume ramps and auxiliary buffers, in two
+// calls. Both ramps reach their targets.
+static int test_alist_envmixer_ramp(void) {
+    static const int16_t kExpect[4][kAlistSamples * 2] = {
+        {
+            3041, 224, -4320, -2564, -72, -889, -2446, -4851,
+            779, -893, 3987, -5679, -7063, 650, -9375, -7337,
+            6454, -7577, -10087, -7879, 6845, 4333, -1099, 11586,
+            14339, 10606, -9912, 10072, 5318, -15837, -16018, 4287,
+        },
+        {
+            16682, 970, -14797, -6903, -150, -1405, -2811, -3773,
+            535, -540, 2122, -2650, -2878, 230, -2853, -1902,
+            1476, -1528, -1789, -1226, 930, 511, -113, 1144,
+            1333, 931, -826, 839, 443, -1320, -1335, 357,
+        },
+        {
+            1014, 75, -1440, -855, -24, -296, -815, -1617,
+            260, -298, 1329, -1893, -2354, 217, -3125, -2446,
+            2151, -2526, -3362, -2626, 2282, 1444, -366, 3862,
+            4780, 3535, -3304, 3357, 1773, -5279, -5339, 1429,
+        },
+        {
+            5561, 323, -4932, -2301, -50, -468, -937, -1258,
+            178, -180, 707, -883, -959, 77, -951, -634,
+            492, -509, -596, -409, 310, 170, -38, 381,
+            444, 310, -275, 280, 148, -440, -445, 119,
+        },
+    };
+    static const char *const kNames[4] = {
+        "dry left",
+        "dry right",
+        "wet left",
+        "wet right",
+    };
+    struct alist_test t;
+    alist_test_init(&t, "envmixer ramp");
+    uint32_t rng = 2718;
+    int16_t in[kAlistSamples * 2];
+    alist_random(&rng, in, kAlistSamples * 2);
+    alist_put(&t, 0x000, in, kAlistSamples * 2);
+    const uint32_t size = kAlistSamples * 2;
+    alist_setbuff(&t, 0, 0, size * 2);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x000);
+    alist_command(&t, kVADPCMAlistSetVol, kVADPCMAlistLeft | kVADPCMAlistVol,
+                  0x1000, 0);
+    alist_command(&t, kVADPCMAlistSetVol, kVADPCMAlistLeft, 0x6000, 0x18000);
+    alist_command(&t, kVADPCMAlistSetVol, kVADPCMAlistVol, 0x7000, 0);
+    alist_command(&t, kVADPCMAlistSetVol, 0, 0x0800, 0x8000);
+    alist_command(&t, kVADPCMAlistSetVol, kVADPCMAlistAux, 0x6000, 0x2000);
+    for (uint32_t i = 0; i < 4; i++) {
+        alist_command(&t, kVADPCMAlistClearBuff, 0, 0x100 * (i + 1), size * 2);
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        uint32_t offset = size * i;
+        alist_command(&t, kVADPCMAlistSetBuff, kVADPCMAlistAux,
+                      0x200 + offset,
+                      ((0x300 + offset) << 16) | (0x400 + offset));
+        alist_setbuff(&t, offset, 0x100 + offset, size);
+        alist_command(&t, kVADPCMAlistEnvMixer,
+                      (i == 0 ? kVADPCMAlistInit : 0) | kVADPCMAlistAux, 0,
+                      0x1000);
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        alist_setbuff(&t, 0, 0x100 * (i + 1), size * 2);
+        alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x100 * (i + 1));
+    }
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        failures += alist_check(&t, kNames[i], 0x100 * (i + 1), kExpect[i],
+                                kAlistSamples * 2);
+    }
+    // Integer part of each saved volume, which is the target.
+    static const int16_t kVolume[2] = {0x6000, 0x0800};
+    failures += alist_check(&t, "saved volume", 0x1020, kVolume, 1);
+    failures += alist_check(&t, "saved volume", 0x1024, kVolume + 1, 1);
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// Test resampling with the default table, in two calls with different pitches.
+static int test_alist_resample(void) {
+    static const int16_t kExpect[kAlistSamples * 2] = {
+        0, 0, -1434, 1286, 29223, 15823, -16059, -19131,
+        -29017, -24247, 15847, 10399, -193, 6686, 24139, 31815,
+        23781, 3515, 4553, 17255, 22779, -2409, -14239, 4685,
+        24730, -7056, -32768, 21877, -12198, 16194, -10367, 23334,
+    };
+    // Four samples of history, followed by the accumulator.
+    static const int16_t kState[5] = {21949, 16227, 4332, -4826, -0x8000};
+    struct alist_test t;
+    alist_test_init(&t, "resample");
+    uint32_t rng = 8080;
+    int16_t in[kAlistSamples * 3];
+    alist_random(&rng, in, kAlistSamples * 3);
+    alist_put(&t, 0x000, in, kAlistSamples);
+    alist_put(&t, 0x100, in + kAlistSamples, kAlistSamples * 2);
+    const uint32_t size = kAlistSamples * 2;
+    alist_setbuff(&t, 0x010, 0, size);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x000);
+    alist_setbuff(&t, 0x110, 0, size * 2);
+    alist_command(&t, kVADPCMAlistLoadBuff, 0, 0, 0x100);
+    // Pitch 0.6875, then 1.28125.
+    alist_setbuff(&t, 0x010, 0x200, size);
+    alist_command(&t, kVADPCMAlistResample, kVADPCMAlistInit, 0x5800,
+                  0x1000);
+    alist_setbuff(&t, 0x110, 0x200 + size, size);
+    alist_command(&t, kVADPCMAlistResample, 0, 0xa400, 0x1000);
+    alist_setbuff(&t, 0, 0x200, size * 2);
+    alist_command(&t, kVADPCMAlistSaveBuff, 0, 0, 0x200);
+    int failures = alist_exec(&t);
+    if (failures != 0) {
+        goto done;
+    }
+
+    failures += alist_check(&t, "output", 0x200, kExpect, kAlistSamples * 2);
+    failures += alist_check(&t, "saved state", 0x1000, kState, 5);
+done:
+    alist_test_destroy(&t);
+    return failures;
+}
+
+// Test that invalid commands are reported.
+static int test_alist_errors(void) {
+    static const struct {
+        uint32_t w1;
+        uint32_t w2;
+    } kCases[] = {
+        // Unknown opcode.
+        {0x10000000, 0},
+        // Data memory out of range.
+        {(kVADPCMAlistClearBuff << 24) | 0xa00, 0x100},
+        // Main memory out of range.
+        {(kVADPCMAlistLoadADPCM << 24) | 32, kAlistRDRAMSize - 16},
+        // Codebook too large.
+        {(kVADPCMAlistLoadADPCM << 24) | 1024, 0},
+    };
+    struct alist_test t;
+    alist_test_init(&t, "errors");
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(kCases) / sizeof(*kCases); i++) {
+        const uint32_t commands[4] = {0, 0, kCases[i].w1, kCases[i].w2};
+        vadpcm_error err = vadpcm_alist_run(t.alist, 2, commands);
+        if (err != kVADPCMErrInvalidData || t.alist->error_command != 1) {
+            fprintf(stderr,
+                    "error: test_alist errors: case %zu: err = %s, "
+                    "command = %zu\n",
+                    i, vadpcm_error_name2(err), t.alist->error_command);
+            failures++;
+        }
+    }
+    alist_test_destroy(&t);
+    return failures;
+}
+
+void test_alist(void) {
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        int failures = test_alist_adpcm() + test_alist_adpcm_loop() +
+                       test_alist_mix() + test_alist_envmixer() +
+                       test_alist_envmixer_ramp() + test_alist_filters() +
+                       test_alist_resample() + test_alist_errors();
+        if (failures > 0) {
+            fprintf(stderr, "test_alist failures (%s): %d\n",
+                    vadpcm_isa_name(isa), failures);
+            test_failure_count++;
+        }
+    }
+    vadpcm_set_isa(saved_isa);
+}
@@ -0,0 +1,416 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#if !_WIN32
+#define _DEFAULT_SOURCE 1
+#endif
+
+#include "common/audio.h"
+#include "common/binary.h"
+#include "common/util.h"
+#include "tests/test.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !_WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Get the path for a temporary file used by a test.
+static void test_temp_path(char *buf, size_t size, const char *name) {
+    static const char *const kVars[] = {"TEST_TMPDIR", "TMPDIR", "TEMP"};
+#if _WIN32
+    const char *dir = ".";
+#else
+    const char *dir = "/tmp";
+#endif
+    for (size_t i = 0; i < sizeof(kVars) / sizeof(*kVars); i++) {
+        const char *value = getenv(kVars[i]);
+        if (value != NULL && *value != '\0') {
+            dir = value;
+            break;
+        }
+    }
+    snprintf(buf, size, "%s/vadpcm_test_%s", dir, name);
+}
+
+// Return true if the file contents are equal to the expected data.
+static bool test_file_equal(const char *test, const char *path,
+                            const void *data, size_t size) {
+    struct input_file file;
+    if (input_file_read(&file, path) != 0) {
+        fprintf(stderr, "error: %s: could not read %s\n", test, path);
+        return false;
+    }
+    bool equal = file.size == size && memcmp(file.data, data, size) == 0;
+    if (!equal) {
+        fprintf(stderr, "error: %s: %s does not match; size=%zu, expect=%zu\n",
+                test, path, file.size, size);
+    }
+    input_file_destroy(&file);
+    return equal;
+}
+
+#if !_WIN32
+
+// Reads everything written to a pipe.
+struct pipe_reader {
+    const char *path;
+    uint8_t *data;
+    size_t size;
+};
+
+static void pipe_reader_run(void *ctx) {
+    struct pipe_reader *restrict reader = ctx;
+    int fd = open(reader->path, O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    size_t capacity = 0;
+    for (;;) {
+        if (reader->size == capacity) {
+            capacity = capacity == 0 ? 4096 : capacity * 2;
+            reader->data = realloc(reader->data, capacity);
+            if (reader->data == NULL) {
+                abort();
+            }
+        }
+        ssize_t amt = read(fd, reader->data + reader->size,
+                           capacity - reader->size);
+        if (amt <= 0) {
+            break;
+        }
+        reader->size += (size_t)amt;
+    }
+    close(fd);
+}
+
+// Test decoding to a pipe, which cannot be mapped and is written directly.
+static void test_decode_pipe(const char *name,
+                             const struct audio_vadpcm *restrict audio,
+                             const char *ref_path) {
+    char path[256];
+    test_temp_path(path, sizeof(path), "pipe.wav");
+    unlink(path);
+    if (mkfifo(path, 0600) != 0) {
+        fprintf(stderr, "error: test_decode_pipe (%s): could not create %s\n",
+                name, path);
+        test_failure_count++;
+        return;
+    }
+    struct pipe_reader reader = {.path = path};
+    struct thread *thread = thread_create(pipe_reader_run, &reader);
+    if (thread == NULL) {
+        fprintf(stderr, "error: test_decode_pipe (%s): no thread\n", name);
+        test_failure_count++;
+        unlink(path);
+        return;
+    }
+    int r = audio_vadpcm_decode_file(audio, path, kFormatWAVE, false, 2);
+    if (r != 0) {
+        // Unblock the reader.
+        close(open(path, O_WRONLY));
+    }
+    thread_join(thread);
+    if (r != 0) {
+        fprintf(stderr, "error: test_decode_pipe (%s): decoding failed\n",
+                name);
+        test_failure_count++;
+    } else if (!test_file_equal("test_decode_pipe", ref_path, reader.data,
+                                reader.size)) {
+        test_failure_count++;
+    }
+    free(reader.data);
+    unlink(path);
+}
+
+#endif
+
+// Test that a failed decode leaves an existing file unchanged.
+static void test_decode_file_error(const char *name,
+                                   const struct audio_vadpcm *restrict audio,
+                                   const char *path) {
+    static const char kExisting[] = "existing file\n";
+    struct byteslice data = {.ptr = kExisting, .size = sizeof(kExisting) - 1};
+    if (output_file_write(path, &data, 1) != 0) {
+        test_failure_count++;
+        return;
+    }
+    // Corrupt the predictor index in the last frame.
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    uint8_t *encoded = XMALLOC(frame_count, kVADPCMFrameByteSize);
+    memcpy(encoded, audio->encoded_data, frame_count * kVADPCMFrameByteSize);
+    encoded[(frame_count - 1) * kVADPCMFrameByteSize] |= 0x0f;
+    struct audio_vadpcm bad = *audio;
+    bad.encoded_data = encoded;
+    int r = audio_vadpcm_decode_file(&bad, path, kFormatWAVE, false, 1);
+    free(encoded);
+    if (r == 0) {
+        fprintf(stderr,
+                "error: test_decode_file_error (%s): decoding succeeded\n",
+                name);
+        test_failure_count++;
+    }
+    if (!test_file_equal("test_decode_file_error", path, kExisting,
+                         data.size)) {
+        test_failure_count++;
+    }
+    char temp_path[264];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *fp = fopen(temp_path, "rb");
+    if (fp != NULL) {
+        fprintf(stderr,
+                "error: test_decode_file_error (%s): %s was not removed\n",
+                name, temp_path);
+        test_failure_count++;
+        fclose(fp);
+        remove(temp_path);
+    }
+}
+
+// Check that floating-point samples in a WAVE file are little-endian, and
+// equal to the decoded samples.
+static bool test_float_le(const char *path, const float *samples,
+                          size_t count) {
+    struct input_file file;
+    if (input_file_read(&file, path) != 0) {
+        return false;
+    }
+    bool ok = file.size >= 4 * count;
+    if (ok) {
+        const uint8_t *ptr = (const uint8_t *)file.data + file.size - 4 * count;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t bits;
+            memcpy(&bits, &samples[i], 4);
+            if (read32le(ptr + 4 * i) != bits) {
+                fprintf(stderr,
+                        "error: test_decode_file: sample %zu is not "
+                        "little-endian\n",
+                        i);
+                ok = false;
+                break;
+            }
+        }
+    }
+    input_file_destroy(&file);
+    return ok;
+}
+
+struct decode_file_case {
+    const char *name;
+    file_format format;
+    bool use_float;
+};
+
+static const struct decode_file_case kDecodeFileCases[] = {
+    {"out.aiff", kFormatAIFF, false},
+    {"out.aifc", kFormatAIFC, false},
+    {"out.wav", kFormatWAVE, false},
+    {"float.wav", kFormatWAVE, true},
+};
+
+// Test that decoding to a file matches decoding to memory and writing the
+// samples with audio_write_pcm_raw().
+static void test_decode_file1(const char *name,
+                              const struct audio_vadpcm *restrict audio,
+                              const struct decode_file_case *restrict c) {
+    sample_format samples =
+        c->use_float ? kSampleFloat : sample_format_for_file(c->format);
+    size_t sample_size = sample_format_size(samples);
+    void *buffer = XMALLOC(audio->meta.padded_sample_count, sample_size);
+    char ref_path[256], out_path[256];
+    test_temp_path(ref_path, sizeof(ref_path), "ref");
+    test_temp_path(out_path, sizeof(out_path), c->name);
+    if (audio_vadpcm_decode(audio, buffer, samples, 1) != 0) {
+        test_failure_count++;
+        goto done;
+    }
+    if (audio_vadpcm_decode_file(audio, out_path, c->format, c->use_float,
+                                 2) != 0) {
+        fprintf(stderr, "error: test_decode_file (%s, %s): decoding failed\n",
+                name, c->name);
+        test_failure_count++;
+        goto done;
+    }
+    if (c->use_float && !test_float_le(out_path, buffer,
+                                       audio->meta.original_sample_count)) {
+        test_failure_count++;
+    }
+    // This converts floating-point samples to little-endian in place.
+    if (audio_write_pcm_raw(&audio->meta, buffer, samples, ref_path,
+                            c->format) != 0) {
+        test_failure_count++;
+        goto done;
+    }
+    struct input_file ref;
+    if (input_file_read(&ref, ref_path) != 0) {
+        test_failure_count++;
+        goto done;
+    }
+    if (!test_file_equal("test_decode_file", out_path, ref.data, ref.size)) {
+        test_failure_count++;
+    }
+#if !_WIN32
+    if (c->format == kFormatWAVE && !c->use_float) {
+        test_decode_pipe(name, audio, ref_path);
+    }
+#endif
+    input_file_destroy(&ref);
+    if (c->format == kFormatWAVE && !c->use_float) {
+        test_decode_file_error(name, audio, out_path);
+    }
+done:
+    free(buffer);
+    remove(ref_path);
+    remove(out_path);
+}
+
+void test_decode_file(const char *name, const struct audio_vadpcm *audio) {
+    // Test with the original length, and with a length which ends in the
+    // middle of a frame, so the padding is truncated.
+    struct audio_vadpcm short_audio = *audio;
+    if (short_audio.meta.padded_sample_count >= kVADPCMFrameSampleCount) {
+        short_audio.meta.original_sample_count =
+            short_audio.meta.padded_sample_count - 5;
+    }
+    const struct audio_vadpcm *inputs[] = {audio, &short_audio};
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); i++) {
+        for (size_t j = 0;
+             j < sizeof(kDecodeFileCases) / sizeof(*kDecodeFileCases); j++) {
+            test_decode_file1(name, inputs[i], &kDecodeFileCases[j]);
+        }
+    }
+}
+
+// Write PCM audio with a writer, a few samples at a time, and read it back.
+static void test_pcm_writer1(const char *name,
+                             const struct audio_pcm *restrict pcm,
+                             file_format format, const char *file) {
+    // Chunk sizes, which are repeated. The writes past the end of the audio
+    // are discarded.
+    static const size_t kChunks[] = {1, 100, 777, 31, 4096};
+    const struct audio_meta *meta = &pcm->meta;
+    size_t total = meta->padded_sample_count;
+    int16_t *samples = XMALLOC(total, sizeof(*samples));
+    memcpy(samples, pcm->sample_data, total * sizeof(*samples));
+    char path[256];
+    test_temp_path(path, sizeof(path), file);
+    struct audio_pcm_writer writer;
+    if (audio_pcm_writer_open(&writer, path, format, meta, false) != 0) {
+        fprintf(stderr, "error: test_pcm_writer (%s, %s): open failed\n",
+                name, file);
+        test_failure_count++;
+        goto done;
+    }
+    int r = 0;
+    for (size_t pos = 0, i = 0; r == 0 && pos < total; i++) {
+        size_t n = kChunks[i % (sizeof(kChunks) / sizeof(*kChunks))];
+        if (n > total - pos) {
+            n = total - pos;
+        }
+        r = audio_pcm_writer_write(&writer, samples + pos, n);
+        pos += n;
+    }
+    if (r == 0) {
+        r = audio_pcm_writer_close(&writer);
+    } else {
+        audio_pcm_writer_close(&writer);
+    }
+    if (r != 0) {
+        fprintf(stderr, "error: test_pcm_writer (%s, %s): write failed\n",
+                name, file);
+        test_failure_count++;
+        goto done;
+    }
+    // The file is the same as one written all at once.
+    char ref_path[256];
+    test_temp_path(ref_path, sizeof(ref_path), "ref");
+    struct audio_pcm ref = {.meta = *meta, .sample_data = samples};
+    memcpy(samples, pcm->sample_data, total * sizeof(*samples));
+    if (audio_write_pcm(&ref, ref_path, format) != 0) {
+        test_failure_count++;
+        goto done;
+    }
+    struct input_file ref_file;
+    if (input_file_read(&ref_file, ref_path) != 0) {
+        test_failure_count++;
+        remove(ref_path);
+        goto done;
+    }
+    if (!test_file_equal("test_pcm_writer", path, ref_file.data,
+                         ref_file.size)) {
+        test_failure_count++;
+    }
+    input_file_destroy(&ref_file);
+    remove(ref_path);
+    struct audio_pcm result;
+    if (audio_read_pcm(&result, path, format) != 0) {
+        fprintf(stderr, "error: test_pcm_writer (%s, %s): read failed\n",
+                name, file);
+        test_failure_count++;
+        goto done;
+    }
+    size_t count = meta->original_sample_count;
+    if (result.meta.original_sample_count != count ||
+        memcmp(result.sample_data, pcm->sample_data,
+               count * sizeof(*samples)) != 0) {
+        fprintf(stderr,
+                "error: test_pcm_writer (%s, %s): samples do not match; "
+                "count=%" PRIu32 ", expect=%zu\n",
+                name, file, result.meta.original_sample_count, count);
+        test_failure_count++;
+    }
+    audio_pcm_destroy(&result);
+done:
+    free(samples);
+    remove(path);
+}
+
+void test_pcm_writer(const char *name, const struct audio_pcm *pcm) {
+    static const struct {
+        file_format format;
+        const char *file;
+    } kCases[] = {
+        {kFormatAIFF, "writer.aiff"},
+        {kFormatAIFC, "writer.aifc"},
+        {kFormatWAVE, "writer.wav"},
+    };
+    // Test with the original length, and with a length which ends in the
+    // middle of a frame.
+    struct audio_pcm short_pcm = *pcm;
+    if (short_pcm.meta.padded_sample_count >= kVADPCMFrameSampleCount) {
+        short_pcm.meta.original_sample_count =
+            short_pcm.meta.padded_sample_count - 5;
+    }
+    const struct audio_pcm *inputs[] = {pcm, &short_pcm};
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); i++) {
+        for (size_t j = 0; j < sizeof(kCases) / sizeof(*kCases); j++) {
+            test_pcm_writer1(name, inputs[i], kCases[j].format,
+                             kCases[j].file);
+        }
+    }
+
+    // Closing before every sample is written is an error.
+    char path[256];
+    test_temp_path(path, sizeof(path), "writer.wav");
+    struct audio_pcm_writer writer;
+    if (audio_pcm_writer_open(&writer, path, kFormatWAVE, &pcm->meta, false) ==
+        0) {
+        if (audio_pcm_writer_close(&writer) == 0 &&
+            pcm->meta.original_sample_count != 0) {
+            fprintf(stderr,
+                    "error: test_pcm_writer (%s): incomplete output was "
+                    "accepted\n",
+                    name);
+            test_failure_count++;
+        }
+    }
+    remove(path);
+}
@@ -0,0 +1,226 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "common/cache.h"
+#include "common/util.h"
+#include "tests/test.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+enum {
+    kCacheClipCount = 3,
+    kCacheBlockFrames = 4,
+    kCacheBlockSamples = kCacheBlockFrames * kVADPCMFrameSampleCount,
+};
+
+// Stand-ins for encoded clips. Only the addresses are used.
+static const char kCacheClips[kCacheClipCount] = {0};
+
+// Fill in the contents of a block, which are different for each block.
+static void cache_block_data(int clip, size_t block, int16_t *pcm,
+                             struct vadpcm_vector *state) {
+    for (int i = 0; i < kCacheBlockSamples; i++) {
+        pcm[i] = (int16_t)(clip * 1000 + (int)block * 37 + i * 5);
+    }
+    for (int i = 0; i < kVADPCMVectorSampleCount; i++) {
+        state->v[i] = (int16_t)(clip - (int)block * 11 + i);
+    }
+}
+
+// Insert a whole block into the cache.
+static void cache_insert(struct block_cache *cache, int clip, size_t block) {
+    int16_t pcm[kCacheBlockSamples];
+    struct vadpcm_vector state;
+    cache_block_data(clip, block, pcm, &state);
+    block_cache_insert(cache, &kCacheClips[clip], block, kCacheBlockFrames,
+                       pcm, &state);
+}
+
+// Look up a whole block in the cache. Returns 1 on a hit, 0 on a miss, and -1
+// if the cached data is wrong.
+static int cache_lookup(struct block_cache *cache, int clip, size_t block) {
+    int16_t pcm[kCacheBlockSamples], expect_pcm[kCacheBlockSamples];
+    struct vadpcm_vector state, expect_state;
+    if (!block_cache_lookup(cache, &kCacheClips[clip], block,
+                            kCacheBlockFrames, pcm, &state)) {
+        return 0;
+    }
+    cache_block_data(clip, block, expect_pcm, &expect_state);
+    if (memcmp(pcm, expect_pcm, sizeof(pcm)) != 0 ||
+        memcmp(&state, &expect_state, sizeof(state)) != 0) {
+        return -1;
+    }
+    return 1;
+}
+
+// Test that the least recently used block is replaced.
+static int test_cache_lru(void) {
+    // With no budget, the cache has a single set.
+    struct block_cache *cache = block_cache_create(0, kCacheBlockFrames - 1);
+    struct block_cache_stats stats;
+    block_cache_get_stats(cache, &stats);
+    if (stats.block_frames != kCacheBlockFrames || stats.entry_count != 4) {
+        fprintf(stderr,
+                "error: test_block_cache: block_frames = %zu, "
+                "entry_count = %zu\n",
+                stats.block_frames, stats.entry_count);
+        block_cache_destroy(cache);
+        return 1;
+    }
+    int failures = 0;
+    for (size_t block = 0; block < 4; block++) {
+        cache_insert(cache, 0, block);
+    }
+    // Use block 0, so block 1 is the least recently used. Inserting block 0
+    // again does nothing.
+    failures += cache_lookup(cache, 0, 0) != 1;
+    cache_insert(cache, 0, 0);
+    cache_insert(cache, 1, 1);
+    static const int kExpect[][3] = {
+        {0, 0, 1}, {0, 1, 0}, {0, 2, 1}, {0, 3, 1}, {1, 1, 1}, {2, 0, 0},
+    };
+    for (size_t i = 0; i < sizeof(kExpect) / sizeof(*kExpect); i++) {
+        int result = cache_lookup(cache, kExpect[i][0], kExpect[i][1]);
+        if (result != kExpect[i][2]) {
+            fprintf(stderr,
+                    "error: test_block_cache: clip %d block %d: "
+                    "lookup = %d, expected %d\n",
+                    kExpect[i][0], kExpect[i][1], result, kExpect[i][2]);
+            failures++;
+        }
+    }
+    block_cache_get_stats(cache, &stats);
+    if (stats.hit_count != 5 || stats.miss_count != 2 ||
+        stats.insert_count != 5 || stats.eviction_count != 1) {
+        fprintf(stderr,
+                "error: test_block_cache: hits = %zu, misses = %zu, "
+                "inserts = %zu, evictions = %zu\n",
+                stats.hit_count, stats.miss_count, stats.insert_count,
+                stats.eviction_count);
+        failures++;
+    }
+
+    // A partial block only copies the frames in the block.
+    int16_t pcm[kCacheBlockSamples], out[kCacheBlockSamples];
+    struct vadpcm_vector state, out_state;
+    cache_block_data(2, 7, pcm, &state);
+    block_cache_insert(cache, &kCacheClips[2], 7, 1, pcm, &state);
+    memset(out, 0, sizeof(out));
+    if (!block_cache_lookup(cache, &kCacheClips[2], 7, 1, out, &out_state) ||
+        memcmp(out, pcm, sizeof(*out) * kVADPCMFrameSampleCount) != 0 ||
+        out[kVADPCMFrameSampleCount] != 0 ||
+        memcmp(&state, &out_state, sizeof(state)) != 0) {
+        fprintf(stderr, "error: test_block_cache: partial block mismatch\n");
+        failures++;
+    }
+    block_cache_destroy(cache);
+    return failures;
+}
+
+// Test that invalidating a clip removes only its blocks, and that the entries
+// are reused before other blocks are evicted.
+static int test_cache_invalidate(void) {
+    struct block_cache *cache = block_cache_create(0, kCacheBlockFrames);
+    for (size_t block = 0; block < 2; block++) {
+        cache_insert(cache, 0, block);
+        cache_insert(cache, 1, block);
+    }
+    block_cache_invalidate(cache, &kCacheClips[0]);
+    cache_insert(cache, 2, 0);
+    static const int kExpect[][3] = {
+        {0, 0, 0}, {0, 1, 0}, {1, 0, 1}, {1, 1, 1}, {2, 0, 1},
+    };
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(kExpect) / sizeof(*kExpect); i++) {
+        int result = cache_lookup(cache, kExpect[i][0], kExpect[i][1]);
+        if (result != kExpect[i][2]) {
+            fprintf(stderr,
+                    "error: test_block_cache: invalidate: clip %d block %d: "
+                    "lookup = %d, expected %d\n",
+                    kExpect[i][0], kExpect[i][1], result, kExpect[i][2]);
+            failures++;
+        }
+    }
+    struct block_cache_stats stats;
+    block_cache_get_stats(cache, &stats);
+    if (stats.eviction_count != 0) {
+        fprintf(stderr,
+                "error: test_block_cache: invalidate: evictions = %zu\n",
+                stats.eviction_count);
+        failures++;
+    }
+    block_cache_destroy(cache);
+    return failures;
+}
+
+// Shared state for the concurrent test.
+struct cache_threads {
+    struct block_cache *cache;
+    size_t failures;
+};
+
+enum {
+    kCacheTasks = 8,
+    kCacheTaskIterations = 2000,
+    kCacheBlockCount = 16,
+};
+
+// Look up and insert random blocks, and check the blocks which are found.
+static void cache_task(void *ctx, size_t task) {
+    struct cache_threads *test = ctx;
+    uint32_t rng = (uint32_t)task * 7919 + 1;
+    for (int i = 0; i < kCacheTaskIterations; i++) {
+        rng = vadpcm_rng(rng);
+        int clip = (rng >> 16) % kCacheClipCount;
+        size_t block = (rng >> 8) % kCacheBlockCount;
+        int result = cache_lookup(test->cache, clip, block);
+        if (result < 0) {
+            thread_fetch_add(&test->failures, 1);
+        } else if (result == 0) {
+            cache_insert(test->cache, clip, block);
+        }
+    }
+}
+
+// Test that concurrent lookups and inserts never return the wrong data. The
+// cache is smaller than the set of blocks, so entries are replaced often.
+static int test_cache_threads(void) {
+    size_t entry_size = sizeof(int16_t) * kCacheBlockSamples + 64;
+    struct cache_threads test = {
+        .cache = block_cache_create(entry_size * 8, kCacheBlockFrames),
+        .failures = 0,
+    };
+    thread_run(4, kCacheTasks, cache_task, &test);
+    struct block_cache_stats stats;
+    block_cache_get_stats(test.cache, &stats);
+    block_cache_destroy(test.cache);
+    int failures = 0;
+    if (test.failures != 0) {
+        fprintf(stderr, "error: test_block_cache: %zu lookups were wrong\n",
+                test.failures);
+        failures++;
+    }
+    if (stats.hit_count + stats.miss_count !=
+        kCacheTasks * kCacheTaskIterations) {
+        fprintf(stderr,
+                "error: test_block_cache: hits = %zu, misses = %zu, "
+                "expected %d lookups\n",
+                stats.hit_count, stats.miss_count,
+                kCacheTasks * kCacheTaskIterations);
+        failures++;
+    }
+    return failures;
+}
+
+void test_block_cache(void) {
+    int failures =
+        test_cache_lru() + test_cache_invalidate() + test_cache_threads();
+    if (failures > 0) {
+        fprintf(stderr, "test_block_cache failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
@@ -1,18 +1,24 @@
 // Copyright 2022 Dietrich Epp.
 // This file is part of VADPCM. VADPCM is licensed under the terms of the
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+#include "codec/dispatch.h"
+#include "codec/random.h"
 #include "codec/vadpcm.h"
 #include "common/util.h"
 #include "tests/test.h"
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 void test_decode(const char *name, int predictor_count, int order,
                  struct vadpcm_vector *codebook, size_t frame_count,
                  const void *vadpcm, const int16_t *pcm) {
     size_t sample_count = frame_count * kVADPCMFrameSampleCount;
     int16_t *out_pcm = XMALLOC(sample_count, sizeof(*out_pcm));
+    float *out_f32 = NULL;
     struct vadpcm_vector state = {{0}};
     vadpcm_error err = vadpcm_decode(predictor_count, order, codebook, &state,
                                      frame_count, out_pcm, vadpcm);
@@ -35,6 +41,691 @@ void test_decode(const char *name, int predictor_count, int order,
             goto done;
         }
     }
+
+    // Decode to floating-point.
+    out_f32 = XMALLOC(sample_count, sizeof(*out_f32));
+    memset(&state, 0, sizeof(state));
+    err = vadpcm_decode_f32(predictor_count, order, codebook, &state,
+                            frame_count, out_f32, vadpcm);
+    if (err != 0) {
+        fprintf(stderr, "error: test_decode %s: f32: %s", name,
+                vadpcm_error_name2(err));
+        test_failure_count++;
+        goto done;
+    }
+    for (size_t i = 0; i < sample_count; i++) {
+        if (out_f32[i] != (float)pcm[i] * (1.0f / 32768.0f)) {
+            fprintf(stderr,
+                    "error: test_decode %s: f32 output does not match, "
+                    "index = %zu\n",
+                    name, i);
+            test_failure_count++;
+            goto done;
+        }
+    }
 done:
     free(out_pcm);
+    free(out_f32);
+}
+
+enum {
+    kKernelTestFrames = 64,
+};
+
+// Fill a codebook and encoded data with random values. Predictor coefficients
+// are limited to 12 bits and scaling factors to 12 so that the accumulator
+// cannot overflow.
+static void random_stream(uint32_t *rng, int predictor_count, int order,
+                          struct vadpcm_vector *codebook, uint8_t *data) {
+    uint32_t state = *rng;
+    for (int i = 0; i < predictor_count * order; i++) {
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            codebook[i].v[j] = (int)(state >> 20) - (1 << 11);
+            state = vadpcm_rng(state);
+        }
+    }
+    for (int frame = 0; frame < kKernelTestFrames; frame++) {
+        uint8_t *fptr = data + kVADPCMFrameByteSize * frame;
+        int scaling = (state >> 16) % 13;
+        state = vadpcm_rng(state);
+        int predictor = (state >> 16) % predictor_count;
+        state = vadpcm_rng(state);
+        fptr[0] = (scaling << 4) | predictor;
+        for (int i = 1; i < kVADPCMFrameByteSize; i++) {
+            fptr[i] = state >> 24;
+            state = vadpcm_rng(state);
+        }
+    }
+    *rng = state;
+}
+
+// Compare decoder output against the scalar decoder. Return the number of
+// failures.
+static int compare_decode(const char *isa_name, const char *function,
+                          int test, int order, const int16_t *out1,
+                          const int16_t *out2,
+                          const struct vadpcm_vector *state1,
+                          const struct vadpcm_vector *state2) {
+    for (int i = 0; i < kKernelTestFrames * kVADPCMFrameSampleCount; i++) {
+        if (out1[i] != out2[i]) {
+            fprintf(stderr,
+                    "error: test_decode_kernels %s %s case %d (order %d): "
+                    "output does not match, index = %d\n",
+                    isa_name, function, test, order, i);
+            int frame = i / kVADPCMFrameSampleCount;
+            show_pcm_diff(out1 + frame * kVADPCMFrameSampleCount,
+                          out2 + frame * kVADPCMFrameSampleCount);
+            return 1;
+        }
+    }
+    if (memcmp(state1, state2, sizeof(*state1)) != 0) {
+        fprintf(stderr, "error: test_decode_kernels %s %s case %d: state\n",
+                isa_name, function, test);
+        return 1;
+    }
+    return 0;
+}
+
+// Check that the decoders for the active instruction set match the scalar
+// decoder exactly. Return the number of failures.
+static int test_decode_isa(void) {
+    const struct vadpcm_kernels *kernels = vadpcm_get_kernels();
+    const char *isa_name = vadpcm_isa_name(vadpcm_get_isa());
+    struct vadpcm_vector codebook[kVADPCMMaxPredictorCount * kVADPCMMaxOrder];
+    struct vadpcm_decoder decoder;
+    uint8_t data[kKernelTestFrames * kVADPCMFrameByteSize];
+    int16_t out1[kKernelTestFrames * kVADPCMFrameSampleCount];
+    int16_t out2[kKernelTestFrames * kVADPCMFrameSampleCount];
+    float fout[kKernelTestFrames * kVADPCMFrameSampleCount];
+    uint32_t rng = 12345;
+    int failures = 0;
+    for (int test = 0; test < 200; test++) {
+        int order = 1 + test % kVADPCMMaxOrder;
+        int predictor_count = 1 + (test / kVADPCMMaxOrder) % 16;
+        random_stream(&rng, predictor_count, order, codebook, data);
+        // Some cases have an invalid predictor in the last frame.
+        int valid_count = predictor_count;
+        if (test % 5 == 4 && predictor_count > 1) {
+            valid_count = predictor_count - 1;
+            data[kVADPCMFrameByteSize * (kKernelTestFrames - 1)] =
+                predictor_count - 1;
+        }
+        struct vadpcm_vector initial, state1, state2;
+        for (int i = 0; i < kVADPCMVectorSampleCount; i++) {
+            initial.v[i] = (int)(rng >> 16) - 0x8000;
+            rng = vadpcm_rng(rng);
+        }
+        state1 = initial;
+        memset(out1, 0, sizeof(out1));
+        vadpcm_error err1 =
+            vadpcm_decode_scalar(valid_count, order, codebook, &state1,
+                                 kKernelTestFrames, out1, data);
+
+        // Decode with the codebook.
+        state2 = initial;
+        memset(out2, 0, sizeof(out2));
+        vadpcm_error err2 = kernels->decode(valid_count, order, codebook,
+                                            &state2, kKernelTestFrames, out2,
+                                            data);
+        if (err1 != err2) {
+            fprintf(stderr,
+                    "error: test_decode_kernels %s decode case %d: "
+                    "error = %s, expected %s\n",
+                    isa_name, test, vadpcm_error_name2(err2),
+                    vadpcm_error_name2(err1));
+            failures++;
+        } else {
+            failures += compare_decode(isa_name, "decode", test, order, out1,
+                                       out2, &state1, &state2);
+        }
+
+        // Decode with a prepared codebook. This decodes past invalid frames,
+        // so only the error is checked for invalid data.
+        vadpcm_error err =
+            vadpcm_decoder_prepare(&decoder, valid_count, order, codebook);
+        if (err != 0) {
+            fprintf(stderr,
+                    "error: test_decode_kernels case %d: prepare: %s\n", test,
+                    vadpcm_error_name2(err));
+            failures++;
+            continue;
+        }
+        state2 = initial;
+        memset(out2, 0, sizeof(out2));
+        err2 = kernels->decoder_decode(&decoder, &state2, kKernelTestFrames,
+                                       out2, data);
+        if (err1 != err2) {
+            fprintf(stderr,
+                    "error: test_decode_kernels %s decoder case %d: "
+                    "error = %s, expected %s\n",
+                    isa_name, test, vadpcm_error_name2(err2),
+                    vadpcm_error_name2(err1));
+            failures++;
+        } else if (err1 == 0) {
+            failures += compare_decode(isa_name, "decoder", test, order, out1,
+                                       out2, &state1, &state2);
+        }
+
+        // Decode with explicit byte order.
+        if (err1 != 0) {
+            continue;
+        }
+        for (int big_endian = 0; big_endian < 2; big_endian++) {
+            uint8_t bytes[sizeof(out2)];
+            state2 = initial;
+            memset(bytes, 0, sizeof(bytes));
+            if (big_endian) {
+                err2 = vadpcm_decoder_decode_be(&decoder, &state2,
+                                                kKernelTestFrames, out2, data);
+            } else {
+                err2 = vadpcm_decoder_decode_le(&decoder, &state2,
+                                                kKernelTestFrames, out2, data);
+            }
+            memcpy(bytes, out2, sizeof(bytes));
+            for (int i = 0; i < kKernelTestFrames * kVADPCMFrameSampleCount;
+                 i++) {
+                int hi = bytes[2 * i + (big_endian ? 0 : 1)];
+                int lo = bytes[2 * i + (big_endian ? 1 : 0)];
+                out2[i] = (int16_t)(uint16_t)((hi << 8) | lo);
+            }
+            const char *function = big_endian ? "decoder_be" : "decoder_le";
+            if (err2 != 0) {
+                fprintf(stderr,
+                        "error: test_decode_kernels %s %s case %d: "
+                        "error = %s\n",
+                        isa_name, function, test, vadpcm_error_name2(err2));
+                failures++;
+            } else {
+                failures += compare_decode(isa_name, function, test, order,
+                                           out1, out2, &state1, &state2);
+            }
+        }
+
+        // Decode without checking predictors.
+        state2 = initial;
+        memset(out2, 0, sizeof(out2));
+        kernels->decode_trusted(valid_count, order, codebook, &state2,
+                                kKernelTestFrames, out2, data);
+        failures += compare_decode(isa_name, "decode_trusted", test, order,
+                                   out1, out2, &state1, &state2);
+
+        // Decode to floating-point. The conversion is exact.
+        state2 = initial;
+        err2 = kernels->decoder_decode_f32(&decoder, &state2, kKernelTestFrames,
+                                           fout, data);
+        for (int i = 0; i < kKernelTestFrames * kVADPCMFrameSampleCount; i++) {
+            out2[i] = (int)(fout[i] * 32768.0f);
+        }
+        if (err2 != 0) {
+            fprintf(stderr,
+                    "error: test_decode_kernels %s decoder_f32 case %d: "
+                    "error = %s\n",
+                    isa_name, test, vadpcm_error_name2(err2));
+            failures++;
+        } else {
+            failures += compare_decode(isa_name, "decoder_f32", test, order,
+                                       out1, out2, &state1, &state2);
+        }
+    }
+    return failures;
+}
+
+void test_decode_kernels(void) {
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        failures += test_decode_isa();
+    }
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_decode_kernels failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
+
+void test_decode_telemetry(void) {
+    enum {
+        kPredictorCount = 4,
+        kOrder = 2,
+        kSampleCount = kKernelTestFrames * kVADPCMFrameSampleCount,
+    };
+    struct vadpcm_vector codebook[kPredictorCount * kOrder];
+    uint8_t data[kKernelTestFrames * kVADPCMFrameByteSize];
+    int16_t out1[kSampleCount], out2[kSampleCount];
+    uint32_t rng = 555;
+    random_stream(&rng, kPredictorCount, kOrder, codebook, data);
+    // Use the largest valid scaling factor, 12, so some samples are clamped.
+    for (int frame = 0; frame < kKernelTestFrames; frame++) {
+        uint8_t *control = &data[kVADPCMFrameByteSize * frame];
+        *control = (uint8_t)((*control & 0x0f) | 0xc0);
+    }
+    struct vadpcm_vector state1 = {{0}}, state2 = {{0}};
+    vadpcm_error err1 = vadpcm_decode_scalar(kPredictorCount, kOrder, codebook,
+                                             &state1, kKernelTestFrames, out1,
+                                             data);
+
+    // Decode in two pieces, which should give the same total.
+    struct vadpcm_telemetry telemetry;
+    memset(&telemetry, 0, sizeof(telemetry));
+    enum {
+        kSplit = 23,
+    };
+    vadpcm_error err2 = vadpcm_decode_telemetry(
+        kPredictorCount, kOrder, codebook, &state2, kSplit, out2, data,
+        &telemetry);
+    if (err2 == 0) {
+        err2 = vadpcm_decode_telemetry(
+            kPredictorCount, kOrder, codebook, &state2,
+            kKernelTestFrames - kSplit, out2 + kSplit * kVADPCMFrameSampleCount,
+            data + kSplit * kVADPCMFrameByteSize, &telemetry);
+    }
+    if (err1 != 0 || err2 != 0) {
+        fprintf(stderr, "error: test_decode_telemetry: error = %s, %s\n",
+                vadpcm_error_name2(err1), vadpcm_error_name2(err2));
+        test_failure_count++;
+        return;
+    }
+    if (memcmp(out1, out2, sizeof(out1)) != 0 ||
+        memcmp(&state1, &state2, sizeof(state1)) != 0) {
+        fprintf(stderr,
+                "error: test_decode_telemetry: output does not match\n");
+        test_failure_count++;
+        return;
+    }
+
+    size_t predictors[16], scaling[16];
+    memset(predictors, 0, sizeof(predictors));
+    memset(scaling, 0, sizeof(scaling));
+    for (int frame = 0; frame < kKernelTestFrames; frame++) {
+        int control = data[kVADPCMFrameByteSize * frame];
+        predictors[control & 15]++;
+        scaling[control >> 4]++;
+    }
+    // Every clamped sample is at the limit, but not every sample at the limit
+    // was clamped.
+    size_t limit_count = 0;
+    for (int i = 0; i < kSampleCount; i++) {
+        if (out1[i] == 0x7fff || out1[i] == -0x8000) {
+            limit_count++;
+        }
+    }
+    if (telemetry.frame_count != kKernelTestFrames ||
+        memcmp(telemetry.predictor_histogram, predictors,
+               sizeof(predictors)) != 0 ||
+        memcmp(telemetry.scaling_histogram, scaling, sizeof(scaling)) != 0 ||
+        telemetry.clamp_count == 0 || telemetry.clamp_count > limit_count) {
+        fprintf(stderr,
+                "error: test_decode_telemetry: frames = %zu, clamped = %zu, "
+                "samples at limit = %zu\n",
+                telemetry.frame_count, telemetry.clamp_count, limit_count);
+        test_failure_count++;
+    }
+}
+
+// Count the predictor indexes and scaling factors used by each frame.
+static void count_headers(size_t frame_count, const uint8_t *data,
+                          size_t *predictors, size_t *scaling) {
+    memset(predictors, 0, sizeof(size_t) * 16);
+    memset(scaling, 0, sizeof(size_t) * 16);
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        int control = data[kVADPCMFrameByteSize * frame];
+        predictors[control & 15]++;
+        scaling[control >> 4]++;
+    }
+}
+
+enum {
+    // Number of frames for testing the histograms from vadpcm_validate(). This
+    // is long enough that SIMD counters overflow unless they are flushed.
+    kValidateLongFrames = 16 * 600 + 7,
+};
+
+// Test that validation counts every frame, including frames after an invalid
+// frame.
+static int test_validate_histogram(const char *isa_name) {
+    static uint8_t data[kValidateLongFrames * kVADPCMFrameByteSize];
+    uint32_t rng = 1234;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = rng >> 24;
+        rng = vadpcm_rng(rng);
+    }
+    // Most frames use the same header, so the counts for one value get large.
+    for (size_t frame = 0; frame < kValidateLongFrames; frame++) {
+        if (frame % 5 != 0) {
+            data[kVADPCMFrameByteSize * frame] = 0x52;
+        }
+    }
+    size_t predictors[16], scaling[16];
+    count_headers(kValidateLongFrames, data, predictors, scaling);
+    size_t first_invalid = kValidateLongFrames;
+    for (size_t frame = 0; frame < kValidateLongFrames; frame++) {
+        if ((data[kVADPCMFrameByteSize * frame] & 15) >= 8) {
+            first_invalid = frame;
+            break;
+        }
+    }
+    struct vadpcm_validation validation;
+    vadpcm_error err =
+        vadpcm_validate(8, kValidateLongFrames, data, &validation);
+    if (err != kVADPCMErrInvalidData ||
+        validation.invalid_frame != first_invalid ||
+        memcmp(validation.predictor_histogram, predictors,
+               sizeof(predictors)) != 0 ||
+        memcmp(validation.scaling_histogram, scaling, sizeof(scaling)) != 0) {
+        fprintf(stderr,
+                "error: test_validate %s: histogram: invalid frame %zu, "
+                "expected %zu: %s\n",
+                isa_name, validation.invalid_frame, first_invalid,
+                vadpcm_error_name2(err));
+        return 1;
+    }
+    return 0;
+}
+
+void test_validate(void) {
+    static uint8_t data[kKernelTestFrames * kVADPCMFrameByteSize];
+    uint32_t rng = 999;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = rng >> 24;
+        rng = vadpcm_rng(rng);
+    }
+    for (int frame = 0; frame < kKernelTestFrames; frame++) {
+        data[kVADPCMFrameByteSize * frame] &= 0xf7;
+    }
+    size_t predictors[16], scaling[16];
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        const char *isa_name = vadpcm_isa_name(isa);
+        count_headers(kKernelTestFrames, data, predictors, scaling);
+        struct vadpcm_validation validation;
+        vadpcm_error err =
+            vadpcm_validate(8, kKernelTestFrames, data, &validation);
+        if (err != 0 || validation.invalid_frame != kKernelTestFrames ||
+            memcmp(validation.predictor_histogram, predictors,
+                   sizeof(predictors)) != 0 ||
+            memcmp(validation.scaling_histogram, scaling, sizeof(scaling)) !=
+                0) {
+            fprintf(stderr, "error: test_validate %s: valid data: %s\n",
+                    isa_name, vadpcm_error_name2(err));
+            failures++;
+        }
+        // Put an invalid frame at each position, and check with different
+        // lengths, so it is found at each offset within a SIMD block.
+        for (int frame = 0; frame < kKernelTestFrames; frame++) {
+            uint8_t *fptr = data + kVADPCMFrameByteSize * frame;
+            uint8_t control = fptr[0];
+            fptr[0] = (control & 0xf0) | (8 + frame % 8);
+            for (int extra = 0; extra < 20 &&
+                                frame + extra < kKernelTestFrames;
+                 extra += 3) {
+                size_t frame_count = frame + extra + 1;
+                err = vadpcm_validate(8, frame_count, data, &validation);
+                count_headers(frame_count, data, predictors, scaling);
+                if (err != kVADPCMErrInvalidData ||
+                    validation.invalid_frame != (size_t)frame ||
+                    memcmp(validation.predictor_histogram, predictors,
+                           sizeof(predictors)) != 0 ||
+                    memcmp(validation.scaling_histogram, scaling,
+                           sizeof(scaling)) != 0) {
+                    fprintf(stderr,
+                            "error: test_validate %s: invalid frame %d, "
+                            "frame count %zu: got %zu\n",
+                            isa_name, frame, frame_count,
+                            validation.invalid_frame);
+                    failures++;
+                }
+            }
+            // Frames before the invalid one are valid.
+            err = vadpcm_validate(8, frame, data, NULL);
+            if (err != 0) {
+                fprintf(stderr,
+                        "error: test_validate %s: frame count %d: %s\n",
+                        isa_name, frame, vadpcm_error_name2(err));
+                failures++;
+            }
+            fptr[0] = control;
+        }
+        failures += test_validate_histogram(isa_name);
+    }
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_validate failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
+
+void test_decode_multi(void) {
+    // Check that decoding streams together gives the same result as decoding
+    // them one at a time.
+    enum {
+        kJobCount = 9,
+    };
+    static const size_t kFrameCounts[kJobCount] = {64, 10, 0, 37, 64,
+                                                   1,  50, 64, 23};
+    static struct vadpcm_vector
+        codebook[kJobCount][kVADPCMMaxPredictorCount * kVADPCMMaxOrder];
+    static struct vadpcm_decoder decoder[kJobCount];
+    static uint8_t data[kJobCount][kKernelTestFrames * kVADPCMFrameByteSize];
+    static int16_t out1[kJobCount][kKernelTestFrames * kVADPCMFrameSampleCount];
+    static int16_t out2[kJobCount][kKernelTestFrames * kVADPCMFrameSampleCount];
+    struct vadpcm_vector initial[kJobCount], state1[kJobCount],
+        state2[kJobCount];
+    vadpcm_error err1[kJobCount];
+    struct vadpcm_decode_job jobs[kJobCount];
+    uint32_t rng = 999;
+    for (int i = 0; i < kJobCount; i++) {
+        int order = 1 + (i * 3) % kVADPCMMaxOrder;
+        int predictor_count = 2 + i;
+        random_stream(&rng, predictor_count, order, codebook[i], data[i]);
+        // Some streams have an invalid predictor in the middle.
+        int valid_count = predictor_count;
+        if (i % 3 == 1) {
+            valid_count = predictor_count - 1;
+            data[i][kVADPCMFrameByteSize * (kFrameCounts[i] / 2)] =
+                predictor_count - 1;
+        }
+        vadpcm_decoder_prepare(&decoder[i], valid_count, order, codebook[i]);
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            initial[i].v[j] = (int)(rng >> 16) - 0x8000;
+            rng = vadpcm_rng(rng);
+        }
+        state1[i] = initial[i];
+        err1[i] = vadpcm_decoder_decode_scalar(&decoder[i], &state1[i],
+                                               kFrameCounts[i], out1[i],
+                                               data[i]);
+    }
+
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        const char *isa_name = vadpcm_isa_name(isa);
+        memset(out2, 0, sizeof(out2));
+        for (int i = 0; i < kJobCount; i++) {
+            state2[i] = initial[i];
+            jobs[i] = (struct vadpcm_decode_job){
+                .decoder = &decoder[i],
+                .state = &state2[i],
+                .frame_count = kFrameCounts[i],
+                .dest = out2[i],
+                .src = data[i],
+                .error = -1,
+            };
+        }
+        vadpcm_error err = vadpcm_decode_multi(kJobCount, jobs);
+        if (err != kVADPCMErrInvalidData) {
+            fprintf(stderr, "error: test_decode_multi %s: error = %s\n",
+                    isa_name, vadpcm_error_name2(err));
+            failures++;
+        }
+        for (int i = 0; i < kJobCount; i++) {
+            if (jobs[i].error != err1[i]) {
+                fprintf(stderr,
+                        "error: test_decode_multi %s job %d: "
+                        "error = %s, expected %s\n",
+                        isa_name, i, vadpcm_error_name2(jobs[i].error),
+                        vadpcm_error_name2(err1[i]));
+                failures++;
+            } else if (err1[i] == 0) {
+                size_t size =
+                    sizeof(int16_t) * kFrameCounts[i] * kVADPCMFrameSampleCount;
+                bool same_output = memcmp(out1[i], out2[i], size) == 0;
+                bool same_state =
+                    memcmp(&state1[i], &state2[i], sizeof(state1[i])) == 0;
+                if (!same_output || !same_state) {
+                    fprintf(stderr,
+                            "error: test_decode_multi %s job %d: "
+                            "output does not match\n",
+                            isa_name, i);
+                    failures++;
+                }
+            }
+        }
+    }
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_decode_multi failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
+
+void test_decode_interleaved(void) {
+    // Check that decoding channels into an interleaved buffer gives the same
+    // result as decoding them one at a time.
+    enum {
+        kMaxChannels = 5,
+        kMaxStride = 6,
+        kSplit = 20,
+        kSamples = kKernelTestFrames * kVADPCMFrameSampleCount,
+        kSentinel = 0x5a5a,
+    };
+    static const size_t kCases[][2] = {{2, 2}, {5, 5}, {3, 4}, {1, 3}, {4, 6}};
+    enum {
+        kCaseCount = sizeof(kCases) / sizeof(*kCases),
+    };
+    static struct vadpcm_vector
+        codebook[kMaxChannels][kVADPCMMaxPredictorCount * kVADPCMMaxOrder];
+    static struct vadpcm_decoder decoder[kMaxChannels];
+    static uint8_t data[kMaxChannels][kKernelTestFrames * kVADPCMFrameByteSize];
+    static int16_t out1[kMaxChannels][kSamples];
+    static int16_t out2[kSamples * kMaxStride];
+    struct vadpcm_vector initial[kMaxChannels], state1[kMaxChannels],
+        state2[kMaxChannels];
+    vadpcm_error err1[kMaxChannels];
+    uint32_t rng = 4444;
+    for (int i = 0; i < kMaxChannels; i++) {
+        int order = 1 + (i * 5) % kVADPCMMaxOrder;
+        int predictor_count = 3 + i;
+        random_stream(&rng, predictor_count, order, codebook[i], data[i]);
+        // One channel has an invalid predictor in the middle.
+        int valid_count = predictor_count;
+        if (i == 3) {
+            valid_count = predictor_count - 1;
+            data[i][kVADPCMFrameByteSize * 30] = predictor_count - 1;
+        }
+        vadpcm_decoder_prepare(&decoder[i], valid_count, order, codebook[i]);
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            initial[i].v[j] = (int)(rng >> 16) - 0x8000;
+            rng = vadpcm_rng(rng);
+        }
+        state1[i] = initial[i];
+        err1[i] = vadpcm_decoder_decode_scalar(&decoder[i], &state1[i],
+                                               kKernelTestFrames, out1[i],
+                                               data[i]);
+    }
+
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        const char *isa_name = vadpcm_isa_name(isa);
+        for (int test = 0; test < kCaseCount; test++) {
+            size_t channel_count = kCases[test][0], stride = kCases[test][1];
+            struct vadpcm_channel channels[kMaxChannels];
+            for (size_t c = 0; c < channel_count; c++) {
+                state2[c] = initial[c];
+                channels[c] = (struct vadpcm_channel){
+                    .decoder = &decoder[c],
+                    .state = &state2[c],
+                    .src = data[c],
+                    .error = -1,
+                };
+            }
+            for (size_t i = 0; i < kSamples * stride; i++) {
+                out2[i] = kSentinel;
+            }
+            // Decode in two calls, so the state and input position are
+            // carried from the first call to the second.
+            vadpcm_error err = vadpcm_decode_interleaved(
+                channel_count, channels, kSplit, stride, out2);
+            vadpcm_error err2 = vadpcm_decode_interleaved(
+                channel_count, channels, kKernelTestFrames - kSplit, stride,
+                out2 + stride * kSplit * kVADPCMFrameSampleCount);
+            if (err2 != 0) {
+                err = err2;
+            }
+            vadpcm_error expect_err = 0;
+            for (size_t c = 0; c < channel_count; c++) {
+                if (err1[c] != 0) {
+                    expect_err = err1[c];
+                }
+                // The invalid frame is decoded by the second call.
+                if (channels[c].error != err1[c]) {
+                    fprintf(stderr,
+                            "error: test_decode_interleaved %s case %d "
+                            "channel %zu: error = %s\n",
+                            isa_name, test, c,
+                            vadpcm_error_name2(channels[c].error));
+                    failures++;
+                }
+                const uint8_t *expect_src =
+                    data[c] + kKernelTestFrames * kVADPCMFrameByteSize;
+                if (channels[c].src != expect_src ||
+                    memcmp(&state1[c], &state2[c], sizeof(state1[c])) != 0) {
+                    fprintf(stderr,
+                            "error: test_decode_interleaved %s case %d "
+                            "channel %zu: wrong state or position\n",
+                            isa_name, test, c);
+                    failures++;
+                }
+            }
+            if (err != expect_err) {
+                fprintf(stderr,
+                        "error: test_decode_interleaved %s case %d: "
+                        "error = %s\n",
+                        isa_name, test, vadpcm_error_name2(err));
+                failures++;
+            }
+            for (size_t i = 0; i < kSamples * stride; i++) {
+                size_t c = i % stride;
+                int expect =
+                    c < channel_count ? out1[c][i / stride] : kSentinel;
+                if (out2[i] != expect) {
+                    fprintf(stderr,
+                            "error: test_decode_interleaved %s case %d: "
+                            "output does not match, index = %zu, "
+                            "got %d, expected %d\n",
+                            isa_name, test, i, out2[i], expect);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_decode_interleaved failures: %d\n", failures);
+        test_failure_count++;
+    }
 }
@@ -0,0 +1,175 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/vadpcm.h"
+#include "common/audio.h"
+#include "common/binary.h"
+#include "common/util.h"
+#include "tests/test.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_decode_threads(const char *name, const struct audio_vadpcm *audio,
+                         const int16_t *pcm) {
+    size_t sample_count = audio->meta.padded_sample_count;
+    size_t frame_count = sample_count / kVADPCMFrameSampleCount;
+    struct vadpcm_decoder decoder;
+    vadpcm_decoder_prepare(&decoder, audio->codebook.predictor_count,
+                           audio->codebook.order, audio->codebook.vector);
+    struct audio_vadpcm copy = *audio;
+    struct vadpcm_seek_table *table = &copy.seek_table;
+    table->interval = 3;
+    table->entry_count = vadpcm_seek_table_size(frame_count, table->interval);
+    table->state = XMALLOC(table->entry_count, sizeof(*table->state));
+    vadpcm_seek_table_build(table, &decoder, frame_count, audio->encoded_data);
+    int16_t *out = XMALLOC(sample_count, sizeof(*out));
+    int failures = 0;
+    // The second to last pass uses a table with a nonzero first entry, which
+    // must be ignored. The last pass uses a corrupted seek table, which must be
+    // detected.
+    static const int kThreadCounts[] = {1, 2, 4, 7, 4, 4};
+    static const sample_format kFormats[] = {
+        kSampleNative,    kSampleBigEndian, kSampleLittleEndian,
+        kSampleBigEndian, kSampleNative,    kSampleNative,
+    };
+    enum {
+        kPassCount = sizeof(kThreadCounts) / sizeof(*kThreadCounts),
+    };
+    for (int pass = 0; pass < kPassCount; pass++) {
+        if (pass == kPassCount - 2) {
+            table->state[0].v[6] = 1000;
+            table->state[0].v[7] = -1000;
+        }
+        if (pass == kPassCount - 1) {
+            for (size_t i = 1; i < table->entry_count; i++) {
+                table->state[i].v[7] ^= 1;
+            }
+        }
+        memset(out, 0, sizeof(*out) * sample_count);
+        int r = audio_vadpcm_decode(&copy, out, kFormats[pass],
+                                    kThreadCounts[pass]);
+        if (r != 0) {
+            fprintf(stderr,
+                    "error: test_decode_threads %s: threads=%d: "
+                    "decoding failed\n",
+                    name, kThreadCounts[pass]);
+            failures++;
+            continue;
+        }
+        // Swapping is its own inverse, so this converts back to native.
+        switch (kFormats[pass]) {
+        case kSampleNative:
+        case kSampleFloat:
+            break;
+        case kSampleBigEndian:
+            swap16be_inplace(out, sample_count);
+            break;
+        case kSampleLittleEndian:
+            swap16le_inplace(out, sample_count);
+            break;
+        }
+        for (size_t i = 0; i < sample_count; i++) {
+            if (out[i] != pcm[i]) {
+                fprintf(stderr,
+                        "error: test_decode_threads %s: threads=%d: "
+                        "output does not match, index = %zu\n",
+                        name, kThreadCounts[pass], i);
+                failures++;
+                break;
+            }
+        }
+    }
+    free(out);
+    free(table->state);
+    if (failures > 0) {
+        test_failure_count++;
+    }
+}
+
+void test_decode_batch(const char *name, const struct audio_vadpcm *audio,
+                       const int16_t *pcm) {
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    struct vadpcm_decoder decoder;
+    vadpcm_decoder_prepare(&decoder, audio->codebook.predictor_count,
+                           audio->codebook.order, audio->codebook.vector);
+    // A bank of clips with a mix of lengths. Each clip is the start of the
+    // file, so its output is the start of the known output. The last clip uses
+    // an invalid predictor, if there is one.
+    enum {
+        kClipCount = 150,
+    };
+    struct decode_clip clips[kClipCount];
+    size_t offset[kClipCount];
+    size_t total = 0;
+    for (size_t i = 0; i < kClipCount; i++) {
+        size_t n = i % 10 == 0 ? frame_count : (i * 37) % 20 + 1;
+        if (n > frame_count) {
+            n = frame_count;
+        }
+        clips[i] = (struct decode_clip){
+            .decoder = &decoder,
+            .src = audio->encoded_data,
+            .frame_count = n,
+        };
+        offset[i] = total;
+        total += n * kVADPCMFrameSampleCount;
+    }
+    bool has_invalid = audio->codebook.predictor_count < 16;
+    uint8_t invalid[kVADPCMFrameByteSize] = {15};
+    if (has_invalid) {
+        clips[kClipCount - 1].src = invalid;
+        clips[kClipCount - 1].frame_count = 1;
+    }
+    int16_t *out = XMALLOC(total, sizeof(*out));
+    int failures = 0;
+    static const int kThreadCounts[] = {1, 3, 8};
+    for (size_t pass = 0; pass < sizeof(kThreadCounts) / sizeof(*kThreadCounts);
+         pass++) {
+        int thread_count = kThreadCounts[pass];
+        memset(out, 0, sizeof(*out) * total);
+        for (size_t i = 0; i < kClipCount; i++) {
+            clips[i].dest = out + offset[i];
+        }
+        size_t failure_count =
+            audio_decode_batch(kClipCount, clips, kSampleNative, thread_count);
+        if (failure_count != (has_invalid ? 1 : 0)) {
+            fprintf(stderr,
+                    "error: test_decode_batch %s: threads=%d: "
+                    "%zu clips failed\n",
+                    name, thread_count, failure_count);
+            failures++;
+            continue;
+        }
+        for (size_t i = 0; i < kClipCount; i++) {
+            if (has_invalid && i == kClipCount - 1) {
+                if (clips[i].error != kVADPCMErrInvalidData) {
+                    fprintf(stderr,
+                            "error: test_decode_batch %s: threads=%d: "
+                            "invalid clip: error = %s\n",
+                            name, thread_count,
+                            vadpcm_error_name2(clips[i].error));
+                    failures++;
+                }
+                continue;
+            }
+            size_t n = clips[i].frame_count * kVADPCMFrameSampleCount;
+            if (clips[i].error != 0 ||
+                memcmp(out + offset[i], pcm, sizeof(*out) * n) != 0) {
+                fprintf(stderr,
+                        "error: test_decode_batch %s: threads=%d: "
+                        "clip %zu does not match\n",
+                        name, thread_count, i);
+                failures++;
+                break;
+            }
+        }
+    }
+    free(out);
+    if (failures > 0) {
+        test_failure_count++;
+    }
+}
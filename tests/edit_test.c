@@ -0,0 +1,342 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "tests/test.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    kEditFrames = 96,
+    kEditSamples = kEditFrames * kVADPCMFrameSampleCount,
+    kEditPredictors = 4,
+    kEditSeekInterval = 16,
+};
+
+// An encoded test signal, and its decoded audio.
+struct edit_source {
+    struct vadpcm_vector codebook[kEditPredictors * kVADPCMEncodeOrder];
+    struct vadpcm_decoder decoder;
+    uint8_t data[kEditFrames * kVADPCMFrameByteSize];
+    int16_t pcm[kEditSamples];
+    struct vadpcm_vector seek_state[kEditFrames / kEditSeekInterval];
+    struct vadpcm_seek_table seek_table;
+};
+
+static bool edit_source_init(struct edit_source *src) {
+    // A few decaying tones, with some noise.
+    static int16_t input[kEditSamples];
+    uint32_t rng = 77;
+    for (int i = 0; i < kEditSamples; i++) {
+        double t = (double)i;
+        double x = 9000.0 * sin(t * 0.031) * exp(t * -0.0007) +
+                   5000.0 * sin(t * 0.23 + 1.0) + 3000.0 * sin(t * 0.71);
+        rng = vadpcm_rng(rng);
+        input[i] = (int16_t)(x + (double)((int)(rng >> 24) - 128) * 4.0);
+    }
+    struct vadpcm_params params = {.predictor_count = kEditPredictors};
+    vadpcm_error err = vadpcm_encode(&params, src->codebook, kEditFrames,
+                                     src->data, input, NULL);
+    if (err == 0) {
+        err = vadpcm_decoder_prepare(&src->decoder, kEditPredictors,
+                                     kVADPCMEncodeOrder, src->codebook);
+    }
+    if (err == 0) {
+        struct vadpcm_vector state = {{0}};
+        err = vadpcm_decoder_decode(&src->decoder, &state, kEditFrames,
+                                    src->pcm, src->data);
+    }
+    if (err == 0) {
+        src->seek_table = (struct vadpcm_seek_table){
+            .interval = kEditSeekInterval,
+            .entry_count = kEditFrames / kEditSeekInterval,
+            .state = src->seek_state,
+        };
+        err = vadpcm_seek_table_build(&src->seek_table, &src->decoder,
+                                      kEditFrames, src->data);
+    }
+    if (err != 0) {
+        fprintf(stderr, "error: test_splice: setup: %s\n",
+                vadpcm_error_name2(err));
+        return false;
+    }
+    return true;
+}
+
+// Create a segment for a range of frames in the source.
+static struct vadpcm_splice_segment edit_segment(const struct edit_source *src,
+                                                 size_t start, size_t end) {
+    struct vadpcm_splice_segment segment = {
+        .src = src->data + start * kVADPCMFrameByteSize,
+        .frame_count = end - start,
+    };
+    vadpcm_seek_state(&src->decoder, &src->seek_table, kEditFrames, src->data,
+                      start, &segment.state);
+    vadpcm_seek_state(&src->decoder, &src->seek_table, kEditFrames, src->data,
+                      end, &segment.end_state);
+    return segment;
+}
+
+// Test that the seek state matches the state from decoding the whole stream.
+static int test_seek_state(const struct edit_source *src) {
+    struct vadpcm_vector state = {{0}};
+    int16_t scratch[kVADPCMFrameSampleCount];
+    for (size_t frame = 0; frame <= kEditFrames; frame++) {
+        for (int use_table = 0; use_table < 2; use_table++) {
+            struct vadpcm_vector seek;
+            vadpcm_error err = vadpcm_seek_state(
+                &src->decoder, use_table ? &src->seek_table : NULL,
+                kEditFrames, src->data, frame, &seek);
+            if (err != 0 || memcmp(&seek, &state, sizeof(state)) != 0) {
+                fprintf(stderr,
+                        "error: test_splice: seek state, frame %zu, "
+                        "table = %d\n",
+                        frame, use_table);
+                return 1;
+            }
+        }
+        if (frame < kEditFrames) {
+            vadpcm_decoder_decode(&src->decoder, &state, 1, scratch,
+                                  src->data + frame * kVADPCMFrameByteSize);
+        }
+    }
+    struct vadpcm_vector seek;
+    if (vadpcm_seek_state(&src->decoder, NULL, kEditFrames, src->data,
+                          kEditFrames + 1, &seek) != kVADPCMErrInvalidParams) {
+        fprintf(stderr, "error: test_splice: seek state out of range\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Join two ranges of the source. Returns the number of failures.
+static int test_splice_case(const struct edit_source *src, size_t end1,
+                            size_t start2, size_t max_frames,
+                            bool expect_converged) {
+    struct vadpcm_splice_segment segments[2] = {
+        edit_segment(src, 0, end1),
+        edit_segment(src, start2, kEditFrames),
+    };
+    size_t frame_count = end1 + kEditFrames - start2;
+    uint8_t out[kEditFrames * kVADPCMFrameByteSize];
+    struct vadpcm_vector state = {{0}};
+    struct vadpcm_splice_stats stats;
+    vadpcm_error err = vadpcm_splice(kEditPredictors, src->codebook,
+                                     max_frames, 2, segments, out, &state,
+                                     &stats);
+    if (err != 0) {
+        fprintf(stderr, "error: test_splice: %zu..%zu: %s\n", end1, start2,
+                vadpcm_error_name2(err));
+        return 1;
+    }
+    if (stats.unconverged_count != !expect_converged ||
+        stats.reencode_count > max_frames ||
+        (end1 != start2 && max_frames > 0 && stats.reencode_count == 0)) {
+        fprintf(stderr,
+                "error: test_splice: %zu..%zu: reencode = %zu, "
+                "unconverged = %zu\n",
+                end1, start2, stats.reencode_count, stats.unconverged_count);
+        return 1;
+    }
+
+    // Only the frames after the edit point, up to the limit, are changed.
+    size_t changed = 0, last_changed = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        size_t src_frame = i < end1 ? i : i - end1 + start2;
+        if (memcmp(out + i * kVADPCMFrameByteSize,
+                   src->data + src_frame * kVADPCMFrameByteSize,
+                   kVADPCMFrameByteSize) != 0) {
+            changed++;
+            last_changed = i;
+        }
+    }
+    if (changed != stats.reencode_count ||
+        (changed > 0 &&
+         (last_changed < end1 || last_changed >= end1 + max_frames))) {
+        fprintf(stderr,
+                "error: test_splice: %zu..%zu: %zu frames changed, "
+                "last = %zu\n",
+                end1, start2, changed, last_changed);
+        return 1;
+    }
+
+    // Once the state converges, the decoded audio is the same as the
+    // original.
+    static int16_t pcm[kEditSamples];
+    struct vadpcm_vector dstate = {{0}};
+    vadpcm_decoder_decode(&src->decoder, &dstate, frame_count, pcm, out);
+    if (memcmp(&dstate, &state, sizeof(state)) != 0) {
+        fprintf(stderr, "error: test_splice: %zu..%zu: final state differs\n",
+                end1, start2);
+        return 1;
+    }
+    size_t exact_start = end1 + (expect_converged ? max_frames : frame_count);
+    for (size_t i = exact_start * kVADPCMFrameSampleCount;
+         i < frame_count * kVADPCMFrameSampleCount; i++) {
+        int16_t expect =
+            src->pcm[i + (start2 - end1) * kVADPCMFrameSampleCount];
+        if (pcm[i] != expect) {
+            fprintf(stderr,
+                    "error: test_splice: %zu..%zu: sample %zu = %d, "
+                    "expected %d\n",
+                    end1, start2, i, pcm[i], expect);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Test that frames after the state converges are copied without decoding them,
+// by putting an invalid frame at the end, which fails if it is decoded.
+static int test_splice_copy(const struct edit_source *src) {
+    static uint8_t data[kEditFrames * kVADPCMFrameByteSize];
+    memcpy(data, src->data, sizeof(data));
+    data[(kEditFrames - 1) * kVADPCMFrameByteSize] |= 15;
+    struct vadpcm_splice_segment segments[2] = {
+        edit_segment(src, 0, 40),
+        edit_segment(src, 40, kEditFrames),
+    };
+    segments[0].src = data;
+    segments[1].src = data + 40 * kVADPCMFrameByteSize;
+    uint8_t out[kEditFrames * kVADPCMFrameByteSize];
+    struct vadpcm_vector state = {{0}};
+    struct vadpcm_splice_stats stats;
+    vadpcm_error err = vadpcm_splice(kEditPredictors, src->codebook, 16, 2,
+                                     segments, out, &state, &stats);
+    if (err != 0 || stats.reencode_count != 0 ||
+        memcmp(out, data, sizeof(out)) != 0 ||
+        memcmp(&state, &segments[1].end_state, sizeof(state)) != 0) {
+        fprintf(stderr, "error: test_splice: copied frames were decoded: %s\n",
+                vadpcm_error_name2(err));
+        return 1;
+    }
+    return 0;
+}
+
+enum {
+    kSilenceFrames = 40,
+    kSilenceMaxRuns = kSilenceFrames,
+};
+
+// Test finding silent runs in a stream with silence at the start, middle, and
+// end.
+static int test_scan_silence(void) {
+    // Frame ranges which contain a tone. The rest is zero.
+    static const int kTones[][2] = {{5, 15}, {23, 29}};
+    static int16_t input[kSilenceFrames * kVADPCMFrameSampleCount];
+    memset(input, 0, sizeof(input));
+    for (size_t i = 0; i < sizeof(kTones) / sizeof(*kTones); i++) {
+        for (int j = kTones[i][0] * kVADPCMFrameSampleCount;
+             j < kTones[i][1] * kVADPCMFrameSampleCount; j++) {
+            input[j] = (int16_t)(8000.0 * sin((double)j * 0.1));
+        }
+    }
+    struct vadpcm_params params = {.predictor_count = 2};
+    struct vadpcm_vector codebook[2 * kVADPCMEncodeOrder];
+    uint8_t data[kSilenceFrames * kVADPCMFrameByteSize];
+    struct vadpcm_decoder decoder;
+    vadpcm_error err = vadpcm_encode(&params, codebook, kSilenceFrames, data,
+                                     input, NULL);
+    if (err == 0) {
+        err = vadpcm_decoder_prepare(&decoder, 2, kVADPCMEncodeOrder,
+                                     codebook);
+    }
+    struct vadpcm_silence runs[kSilenceMaxRuns];
+    size_t run_count = 0;
+    if (err == 0) {
+        err = vadpcm_scan_silence(&decoder, kSilenceFrames, data,
+                                  kSilenceMaxRuns, runs, &run_count);
+    }
+    if (err != 0) {
+        fprintf(stderr, "error: test_scan_silence: %s\n",
+                vadpcm_error_name2(err));
+        return 1;
+    }
+
+    // Find the silent frames by decoding one frame at a time.
+    bool expect[kSilenceFrames], actual[kSilenceFrames];
+    struct vadpcm_vector state = {{0}};
+    for (int frame = 0; frame < kSilenceFrames; frame++) {
+        const uint8_t *fptr = data + frame * kVADPCMFrameByteSize;
+        bool flat = true;
+        for (int i = 1; i < kVADPCMFrameByteSize; i++) {
+            flat = flat && fptr[i] == 0;
+        }
+        expect[frame] = flat && state.v[6] == 0 && state.v[7] == 0;
+        int16_t pcm[kVADPCMFrameSampleCount];
+        vadpcm_decoder_decode(&decoder, &state, 1, pcm, fptr);
+        for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+            if (expect[frame] && pcm[i] != 0) {
+                fprintf(stderr,
+                        "error: test_scan_silence: frame %d is not silent\n",
+                        frame);
+                return 1;
+            }
+        }
+        actual[frame] = false;
+    }
+    for (size_t i = 0; i < run_count; i++) {
+        for (size_t j = 0; j < runs[i].frame_count; j++) {
+            actual[runs[i].start + j] = true;
+        }
+    }
+    if (memcmp(expect, actual, sizeof(expect)) != 0) {
+        fprintf(stderr, "error: test_scan_silence: wrong frames\n");
+        return 1;
+    }
+    if (run_count != 3 || runs[0].start != 0 || runs[0].frame_count != 5 ||
+        runs[2].start + runs[2].frame_count != kSilenceFrames) {
+        fprintf(stderr, "error: test_scan_silence: run count = %zu\n",
+                run_count);
+        return 1;
+    }
+
+    // Only as many runs as fit are written.
+    struct vadpcm_silence first = {0, 0};
+    size_t count = 0;
+    vadpcm_scan_silence(&decoder, kSilenceFrames, data, 1, &first, &count);
+    if (count != run_count || first.frame_count != runs[0].frame_count) {
+        fprintf(stderr, "error: test_scan_silence: limited scan\n");
+        return 1;
+    }
+
+    // A flat frame with an invalid predictor index is decoded, which reports
+    // the error, and it is not part of a run.
+    data[0] |= 0x0f;
+    err = vadpcm_scan_silence(&decoder, kSilenceFrames, data, kSilenceMaxRuns,
+                              runs, &run_count);
+    if (err != kVADPCMErrInvalidData || run_count != 3 || runs[0].start != 1) {
+        fprintf(stderr,
+                "error: test_scan_silence: invalid predictor: error = %s\n",
+                vadpcm_error_name2(err));
+        return 1;
+    }
+    return 0;
+}
+
+void test_splice(void) {
+    static struct edit_source src;
+    if (!edit_source_init(&src)) {
+        test_failure_count++;
+        return;
+    }
+    int failures = test_seek_state(&src);
+    // Contiguous ranges need no work.
+    failures += test_splice_case(&src, 40, 40, 0, true);
+    // A cut converges after a few frames.
+    failures += test_splice_case(&src, 30, 50, 16, true);
+    failures += test_splice_case(&src, 20, 70, 16, true);
+    // With no frames encoded again, the data is only concatenated.
+    failures += test_splice_case(&src, 30, 50, 0, false);
+    failures += test_splice_copy(&src);
+    failures += test_scan_silence();
+    if (failures > 0) {
+        fprintf(stderr, "test_splice failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
@@ -1,11 +1,14 @@
 // Copyright 2023 Dietrich Epp.
 // This file is part of VADPCM. VADPCM is licensed under the terms of the
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/dispatch.h"
 #include "codec/encode.h"
+#include "codec/random.h"
 #include "codec/vadpcm.h"
 #include "common/util.h"
 #include "tests/test.h"
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -170,3 +173,133 @@ void test_encode_1(void) {
         fputc('\n', stderr);
     }
 }
+
+enum {
+    kEncodeTestFrames = 256,
+};
+
+// Fill a buffer with random audio. The amplitude and smoothness change from
+// frame to frame, so the encoder chooses a variety of scaling factors.
+static void random_audio(uint32_t *rng, int16_t *data) {
+    uint32_t state = *rng;
+    int x = 0;
+    for (int frame = 0; frame < kEncodeTestFrames; frame++) {
+        int amplitude = (state >> 16) % 17;
+        state = vadpcm_rng(state);
+        int smooth = (state >> 16) % 4;
+        state = vadpcm_rng(state);
+        for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+            int noise = ((int)(state >> 16) - 0x8000) >> (16 - amplitude);
+            state = vadpcm_rng(state);
+            x = x - (x >> smooth) + noise;
+            if (x > 0x7fff) {
+                x = 0x7fff;
+            } else if (x < -0x8000) {
+                x = -0x8000;
+            }
+            data[frame * kVADPCMFrameSampleCount + i] = x;
+        }
+    }
+    *rng = state;
+}
+
+void test_encode_kernels(void) {
+    // Check that the SIMD encoders match the scalar encoder exactly.
+    enum {
+        kPredictorCount = 4,
+    };
+    int16_t pcm[kEncodeTestFrames * kVADPCMFrameSampleCount];
+    uint8_t predictors[kEncodeTestFrames];
+    struct vadpcm_vector codebook[kPredictorCount * 2];
+    uint8_t out1[kEncodeTestFrames * kVADPCMFrameByteSize];
+    uint8_t out2[kEncodeTestFrames * kVADPCMFrameByteSize];
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    uint32_t rng = 54321;
+    int failures = 0;
+    for (int test = 0; test < 20; test++) {
+        random_audio(&rng, pcm);
+        for (int i = 0; i < kPredictorCount; i++) {
+            // Choose the poles of the predictor inside a circle with radius
+            // kMaxPole, so the predictor is stable and the vectors are small
+            // enough that the encoder's accumulators cannot overflow.
+            const double kMaxPole = 0.9;
+            double u = (double)(rng >> 16) * (1.0 / 65536.0);
+            rng = vadpcm_rng(rng);
+            double v = (double)(rng >> 16) * (1.0 / 65536.0);
+            rng = vadpcm_rng(rng);
+            double coeff[2];
+            if (i % 2 == 0) {
+                // Complex conjugate poles.
+                double r = kMaxPole * u, theta = 3.14159265358979 * v;
+                coeff[0] = 2.0 * r * cos(theta);
+                coeff[1] = -r * r;
+            } else {
+                // Real poles.
+                double p1 = kMaxPole * (2.0 * u - 1.0);
+                double p2 = kMaxPole * (2.0 * v - 1.0);
+                coeff[0] = p1 + p2;
+                coeff[1] = -p1 * p2;
+            }
+            vadpcm_make_vectors(coeff, codebook + 2 * i);
+        }
+        for (int i = 0; i < kEncodeTestFrames; i++) {
+            predictors[i] = (rng >> 16) % kPredictorCount;
+            rng = vadpcm_rng(rng);
+        }
+        struct vadpcm_encoder_state initial = {
+            {(int)(rng >> 16) - 0x8000, 0},
+            rng,
+        };
+        rng = vadpcm_rng(rng);
+        struct vadpcm_stats stats1, stats2;
+        struct vadpcm_encoder_state state1 = initial, state2;
+        vadpcm_encode_data_scalar(kEncodeTestFrames, out1, pcm, predictors,
+                                  codebook, &stats1, &state1);
+        for (int isa = kVADPCMISAScalar + 1; vadpcm_isa_name(isa) != NULL;
+             isa++) {
+            if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+                continue;
+            }
+            state2 = initial;
+            memset(out2, 0, sizeof(out2));
+            vadpcm_encode_data(kEncodeTestFrames, out2, pcm, predictors,
+                               codebook, &stats2, &state2);
+            const char *name = vadpcm_isa_name(isa);
+            for (int frame = 0; frame < kEncodeTestFrames; frame++) {
+                size_t offset = frame * kVADPCMFrameByteSize;
+                if (memcmp(out1 + offset, out2 + offset,
+                           kVADPCMFrameByteSize) != 0) {
+                    fprintf(stderr,
+                            "error: test_encode_kernels %s case %d: "
+                            "output does not match, frame = %d\n",
+                            name, test, frame);
+                    show_raw("ref", out1 + offset);
+                    show_raw("out", out2 + offset);
+                    failures++;
+                    break;
+                }
+            }
+            if (stats1.signal_mean_square != stats2.signal_mean_square ||
+                stats1.error_mean_square != stats2.error_mean_square) {
+                fprintf(stderr,
+                        "error: test_encode_kernels %s case %d: "
+                        "stats do not match\n",
+                        name, test);
+                failures++;
+            }
+            if (state1.data[0] != state2.data[0] ||
+                state1.data[1] != state2.data[1] || state1.rng != state2.rng) {
+                fprintf(stderr,
+                        "error: test_encode_kernels %s case %d: "
+                        "state does not match\n",
+                        name, test);
+                failures++;
+            }
+        }
+    }
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_encode_kernels failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
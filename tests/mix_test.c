@@ -0,0 +1,243 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/decode.h"
+#include "codec/dispatch.h"
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "tests/test.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+enum {
+    kMixVoiceCount = 5,
+    kMixFrames = 32,
+    kMixSamples = kMixFrames * kVADPCMFrameSampleCount,
+    // Mix the first part in one call, and the rest in another.
+    kMixSplit = 20,
+};
+
+// Test data for one voice.
+struct mix_voice {
+    struct vadpcm_vector codebook[kVADPCMMaxPredictorCount * kVADPCMMaxOrder];
+    struct vadpcm_decoder decoder;
+    uint8_t data[kMixFrames * kVADPCMFrameByteSize];
+    int16_t pcm[kMixSamples];
+};
+
+// Fill a voice with a random codebook and data, and decode it. Coefficients
+// and scaling factors are limited so the accumulator cannot overflow.
+static void mix_random_voice(uint32_t *rng, struct mix_voice *restrict voice,
+                             int order) {
+    enum {
+        kPredictorCount = 4,
+    };
+    uint32_t state = *rng;
+    for (int i = 0; i < kPredictorCount * order; i++) {
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            voice->codebook[i].v[j] = (int)(state >> 20) - (1 << 11);
+            state = vadpcm_rng(state);
+        }
+    }
+    for (int frame = 0; frame < kMixFrames; frame++) {
+        uint8_t *fptr = voice->data + kVADPCMFrameByteSize * frame;
+        int scaling = (state >> 16) % 13;
+        state = vadpcm_rng(state);
+        fptr[0] = (scaling << 4) | ((state >> 16) % kPredictorCount);
+        state = vadpcm_rng(state);
+        for (int i = 1; i < kVADPCMFrameByteSize; i++) {
+            fptr[i] = state >> 24;
+            state = vadpcm_rng(state);
+        }
+    }
+    *rng = state;
+    vadpcm_decoder_prepare(&voice->decoder, kPredictorCount, order,
+                           voice->codebook);
+    struct vadpcm_vector vstate = {{0}};
+    vadpcm_decoder_decode_scalar(&voice->decoder, &vstate, kMixFrames,
+                                 voice->pcm, voice->data);
+}
+
+// Mix the voices with the active kernels, in two calls. Returns the number of
+// failures.
+static int mix_run(const char *isa_name, struct mix_voice *restrict test,
+                   const size_t *frame_counts, const float *gain,
+                   const float *pan, float *fmix, int32_t *imix) {
+    int failures = 0;
+    for (int use_float = 0; use_float < 2; use_float++) {
+        struct vadpcm_vector state[kMixVoiceCount];
+        struct vadpcm_voice voices[kMixVoiceCount];
+        for (int i = 0; i < kMixVoiceCount; i++) {
+            memset(&state[i], 0, sizeof(state[i]));
+            voices[i] = (struct vadpcm_voice){
+                .decoder = &test[i].decoder,
+                .state = &state[i],
+                .src = test[i].data,
+                .frame_count = frame_counts[i],
+                .gain = gain[i],
+                .pan = pan[i],
+                .error = -1,
+            };
+        }
+        static const size_t kCalls[2][2] = {
+            {0, kMixSplit},
+            {kMixSplit, kMixFrames},
+        };
+        for (int call = 0; call < 2; call++) {
+            size_t start = kCalls[call][0] * 2 * kVADPCMFrameSampleCount;
+            size_t n = kCalls[call][1] - kCalls[call][0];
+            vadpcm_error err =
+                use_float ? vadpcm_mix_f32(kMixVoiceCount, voices, n,
+                                           fmix + start)
+                          : vadpcm_mix_s32(kMixVoiceCount, voices, n,
+                                           imix + start);
+            if (err != 0) {
+                fprintf(stderr, "error: test_mix %s: error = %s\n", isa_name,
+                        vadpcm_error_name2(err));
+                failures++;
+            }
+        }
+        for (int i = 0; i < kMixVoiceCount; i++) {
+            size_t expect = frame_counts[i] < kMixFrames
+                                ? 0
+                                : frame_counts[i] - kMixFrames;
+            if (voices[i].frame_count != expect) {
+                fprintf(stderr,
+                        "error: test_mix %s voice %d: frame_count = %zu, "
+                        "expected %zu\n",
+                        isa_name, i, voices[i].frame_count, expect);
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+// Test that scaled samples outside the 32-bit range saturate, and that every
+// kernel gives the same integer mix. Returns the number of failures.
+static int test_mix_saturate(const struct mix_voice *restrict test) {
+    static int32_t imix[2 * kMixSamples], scalar[2 * kMixSamples];
+    const float gain = 1.0e6f;
+    // Well outside the range, so rounding in the gain does not matter.
+    const double limit = 2.2e9;
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        const char *isa_name = vadpcm_isa_name(isa);
+        struct vadpcm_vector state = {{0}};
+        struct vadpcm_voice voice = {
+            .decoder = &test->decoder,
+            .state = &state,
+            .src = test->data,
+            .frame_count = kMixFrames,
+            .gain = gain,
+            .pan = 0.0f,
+        };
+        memset(imix, 0, sizeof(imix));
+        vadpcm_error err = vadpcm_mix_s32(1, &voice, kMixFrames, imix);
+        if (err != 0) {
+            fprintf(stderr, "error: test_mix saturate %s: error = %s\n",
+                    isa_name, vadpcm_error_name2(err));
+            failures++;
+            continue;
+        }
+        if (isa == kVADPCMISAScalar) {
+            memcpy(scalar, imix, sizeof(scalar));
+        }
+        int saturated = 0;
+        for (int i = 0; i < 2 * kMixSamples; i++) {
+            double x = test->pcm[i / 2] * (double)gain * sqrt(0.5);
+            int32_t expect = imix[i];
+            if (x > limit) {
+                expect = 2147483520;
+                saturated++;
+            } else if (x < -limit) {
+                expect = INT32_MIN;
+                saturated++;
+            }
+            if (imix[i] != expect || imix[i] != scalar[i]) {
+                fprintf(stderr,
+                        "error: test_mix saturate %s: index = %d, got %d, "
+                        "expected %d, scalar %d\n",
+                        isa_name, i, imix[i], expect, scalar[i]);
+                failures++;
+                break;
+            }
+        }
+        if (saturated == 0) {
+            fprintf(stderr, "error: test_mix saturate %s: no samples\n",
+                    isa_name);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+void test_mix(void) {
+    static struct mix_voice test[kMixVoiceCount];
+    static const size_t kFrameCounts[kMixVoiceCount] = {32, 10, 0, 40, 17};
+    static const float kGain[kMixVoiceCount] = {1.0f, 0.5f, 1.0f, 2.0f, 0.25f};
+    static const float kPan[kMixVoiceCount] = {0.0f, -1.0f, 0.5f, 1.0f, -0.3f};
+    uint32_t rng = 4321;
+    for (int i = 0; i < kMixVoiceCount; i++) {
+        mix_random_voice(&rng, &test[i], 1 + i % kVADPCMMaxOrder);
+    }
+
+    // Calculate the expected mix, using an equal-power pan law.
+    static double expect_f[2 * kMixSamples];
+    static double expect_i[2 * kMixSamples];
+    memset(expect_f, 0, sizeof(expect_f));
+    memset(expect_i, 0, sizeof(expect_i));
+    for (int v = 0; v < kMixVoiceCount; v++) {
+        double angle = ((double)kPan[v] + 1.0) * (3.14159265358979 / 4.0);
+        double gain[2] = {(double)kGain[v] * cos(angle),
+                          (double)kGain[v] * sin(angle)};
+        size_t n = kFrameCounts[v] < kMixFrames ? kFrameCounts[v] : kMixFrames;
+        for (size_t i = 0; i < n * kVADPCMFrameSampleCount; i++) {
+            for (int c = 0; c < 2; c++) {
+                double x = test[v].pcm[i] * gain[c];
+                expect_f[2 * i + c] += x / 32768.0;
+                expect_i[2 * i + c] += nearbyint(x);
+            }
+        }
+    }
+
+    static float fmix[2 * kMixSamples];
+    static int32_t imix[2 * kMixSamples];
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        const char *isa_name = vadpcm_isa_name(isa);
+        memset(fmix, 0, sizeof(fmix));
+        memset(imix, 0, sizeof(imix));
+        failures += mix_run(isa_name, test, kFrameCounts, kGain, kPan, fmix,
+                            imix);
+        // Rounding can differ from the reference by one for each voice.
+        for (int i = 0; i < 2 * kMixSamples; i++) {
+            if (fabs((double)fmix[i] - expect_f[i]) > 1e-5 ||
+                fabs(imix[i] - expect_i[i]) > kMixVoiceCount) {
+                fprintf(stderr,
+                        "error: test_mix %s: output does not match, "
+                        "index = %d, got %f %d, expected %f %f\n",
+                        isa_name, i, (double)fmix[i], imix[i], expect_f[i],
+                        expect_i[i]);
+                failures++;
+                break;
+            }
+        }
+    }
+    failures += test_mix_saturate(&test[0]);
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_mix failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
@@ -0,0 +1,171 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "common/audio.h"
+#include "common/cache.h"
+#include "common/player.h"
+#include "common/ring.h"
+#include "common/util.h"
+#include "tests/test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_ring(void) {
+    // Write and read in pieces of different sizes, so both positions wrap
+    // around the end of the buffer at different offsets.
+    struct ring_buffer ring;
+    ring_buffer_init(&ring, 100);
+    if (ring.capacity != 128) {
+        fprintf(stderr, "error: test_ring: capacity = %zu, expected 128\n",
+                ring.capacity);
+        test_failure_count++;
+        ring_buffer_destroy(&ring);
+        return;
+    }
+    static const size_t kWriteSizes[] = {48, 80, 16, 112, 32};
+    static const size_t kReadSizes[] = {30, 77, 1, 128, 50, 19};
+    int16_t buf[128];
+    int next_write = 0, next_read = 0;
+    int failures = 0;
+    for (int iter = 0; iter < 40 && failures == 0; iter++) {
+        int16_t *ptr;
+        size_t space = ring_buffer_write_space(&ring, &ptr);
+        size_t n = kWriteSizes[iter % 5];
+        if (n > space) {
+            n = space;
+        }
+        for (size_t i = 0; i < n; i++) {
+            ptr[i] = next_write++;
+        }
+        ring_buffer_commit(&ring, n);
+        size_t fill = ring_buffer_fill(&ring);
+        if (fill != (size_t)(next_write - next_read)) {
+            fprintf(stderr, "error: test_ring: fill = %zu, expected %d\n", fill,
+                    next_write - next_read);
+            failures++;
+        }
+        n = ring_buffer_read(&ring, buf, kReadSizes[iter % 6]);
+        for (size_t i = 0; i < n; i++) {
+            if (buf[i] != next_read) {
+                fprintf(stderr,
+                        "error: test_ring: read %d, expected %d, "
+                        "iteration %d\n",
+                        buf[i], next_read, iter);
+                failures++;
+                break;
+            }
+            next_read++;
+        }
+    }
+    if (next_read < 1000) {
+        fprintf(stderr, "error: test_ring: only read %d samples\n", next_read);
+        failures++;
+    }
+    ring_buffer_destroy(&ring);
+    if (failures > 0) {
+        test_failure_count++;
+    }
+}
+
+// Play a file and check that the output matches the known output. Returns the
+// number of failures.
+static int player_run(const char *name, const struct audio_vadpcm *audio,
+                      const int16_t *pcm, struct block_cache *cache) {
+    enum {
+        kBufferSize = 1000,
+        kBlockSize = 300,
+    };
+    struct player *player = player_create(audio, kBufferSize, cache);
+    if (player == NULL) {
+        return 1;
+    }
+    // This consumer waits until a block is available, so there must be no
+    // underruns.
+    int16_t block[kBlockSize];
+    size_t sample_count = audio->meta.original_sample_count;
+    size_t pos = 0;
+    struct player_stats stats;
+    bool ok = true;
+    while (ok) {
+        for (;;) {
+            player_get_stats(player, &stats);
+            if (stats.fill >= kBlockSize || stats.decode_done) {
+                break;
+            }
+            thread_sleep(1);
+        }
+        size_t n = player_read(player, block, kBlockSize);
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < kBlockSize; i++) {
+            int expect = i < n ? pcm[pos + i] : 0;
+            if (block[i] != expect) {
+                fprintf(stderr,
+                        "error: test_player %s: output does not match, "
+                        "index = %zu\n",
+                        name, pos + i);
+                ok = false;
+                break;
+            }
+        }
+        pos += n;
+    }
+    player_get_stats(player, &stats);
+    player_destroy(player);
+    if (!ok) {
+        return 1;
+    }
+    int failures = 0;
+    if (pos != sample_count || stats.position != sample_count) {
+        fprintf(stderr,
+                "error: test_player %s: read %zu samples, expected %zu\n",
+                name, pos, sample_count);
+        failures++;
+    }
+    if (stats.underrun_count != 0 || stats.decode_error ||
+        stats.capacity != 1024) {
+        fprintf(stderr,
+                "error: test_player %s: underruns = %zu, decode_error = %d, "
+                "capacity = %zu\n",
+                name, stats.underrun_count, stats.decode_error,
+                stats.capacity);
+        failures++;
+    }
+    return failures;
+}
+
+void test_player(const char *name, const struct audio_vadpcm *audio,
+                 const int16_t *pcm) {
+    enum {
+        kCacheFrames = 16,
+    };
+    int failures = player_run(name, audio, pcm, NULL);
+
+    // Play twice with a cache. The second time, blocks come from the cache,
+    // and the output must be the same.
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    size_t block_count = (frame_count + kCacheFrames - 1) / kCacheFrames;
+    struct block_cache *cache = block_cache_create(1 << 20, kCacheFrames);
+    failures += player_run(name, audio, pcm, cache);
+    failures += player_run(name, audio, pcm, cache);
+    struct block_cache_stats stats;
+    block_cache_get_stats(cache, &stats);
+    block_cache_destroy(cache);
+    if (stats.hit_count + stats.miss_count != 2 * block_count ||
+        stats.insert_count != stats.miss_count ||
+        (block_count > 0 && stats.hit_count == 0)) {
+        fprintf(stderr,
+                "error: test_player %s: cache hits = %zu, misses = %zu, "
+                "inserts = %zu, blocks = %zu\n",
+                name, stats.hit_count, stats.miss_count, stats.insert_count,
+                block_count);
+        failures++;
+    }
+    if (failures > 0) {
+        test_failure_count++;
+    }
+}
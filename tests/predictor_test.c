@@ -3,6 +3,7 @@
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #include "codec/predictor.h"
 #include "codec/autocorr.h"
+#include "codec/dispatch.h"
 #include "codec/encode.h"
 #include "codec/random.h"
 #include "codec/vadpcm.h"
@@ -10,6 +11,7 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #pragma GCC diagnostic ignored "-Wdouble-promotion"
 
@@ -72,6 +74,42 @@ void test_autocorr(void) {
     }
 }
 
+void test_autocorr_kernels(void) {
+    // Check that the SIMD autocorrelation matches the scalar code exactly. The
+    // frame count is not a multiple of the vector width, to cover the tail.
+    enum {
+        kFrameCount = 37,
+        kSampleCount = kFrameCount * kVADPCMFrameSampleCount,
+    };
+    int16_t data[kSampleCount];
+    uint32_t state = 1;
+    for (int i = 0; i < kSampleCount; i++) {
+        data[i] = (int)(state >> 16) - 0x8000;
+        state = vadpcm_rng(state);
+    }
+    float corr1[kFrameCount][6], corr2[kFrameCount][6];
+    vadpcm_autocorr_scalar(kFrameCount, corr1, data);
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar + 1; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        memset(corr2, 0, sizeof(corr2));
+        vadpcm_autocorr(kFrameCount, corr2, data);
+        if (memcmp(corr1, corr2, sizeof(corr1)) != 0) {
+            fprintf(stderr, "test_autocorr_kernels %s: output does not match\n",
+                    vadpcm_isa_name(isa));
+            failures++;
+        }
+    }
+    vadpcm_set_isa(saved_isa);
+    if (failures > 0) {
+        fprintf(stderr, "test_autocorr_kernels failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
+
 void test_solve(void) {
     // Check that vadpcm_solve minimizes vadpcm_eval.
     static const double dcorr[][6] = {
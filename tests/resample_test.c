@@ -0,0 +1,154 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/dispatch.h"
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "tests/test.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+enum {
+    kResampleFrames = 24,
+    kResampleSamples = kResampleFrames * kVADPCMFrameSampleCount,
+    kResamplePredictors = 2,
+    kResampleOutput = 600,
+};
+
+// Return the input sample at the given index, which is silent outside the
+// stream.
+static double resample_input(const float *pcm, long index) {
+    if (index < 0 || index >= kResampleSamples) {
+        return 0.0;
+    }
+    return pcm[index];
+}
+
+// Calculate the expected output at a 16.16 fixed-point position.
+static double resample_expect(const float *pcm, uint64_t pos) {
+    long i = (long)(pos >> 16);
+    double t = (double)(pos & 0xffff) / 65536.0;
+    double x0 = resample_input(pcm, i - 1), x1 = resample_input(pcm, i),
+           x2 = resample_input(pcm, i + 1), x3 = resample_input(pcm, i + 2);
+    // Catmull-Rom spline.
+    return x1 + 0.5 * t *
+                    (x2 - x0 +
+                     t * (2.0 * x0 - 5.0 * x1 + 4.0 * x2 - x3 +
+                          t * (3.0 * (x1 - x2) + x3 - x0)));
+}
+
+void test_resample(void) {
+    struct vadpcm_vector codebook[kResamplePredictors * kVADPCMEncodeOrder];
+    uint8_t data[kResampleFrames * kVADPCMFrameByteSize];
+    static float pcm[kResampleSamples];
+    static float out[kResampleOutput];
+    uint32_t rng = 777;
+    for (int i = 0; i < kResamplePredictors * kVADPCMEncodeOrder; i++) {
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            codebook[i].v[j] = (int)(rng >> 21) - (1 << 10);
+            rng = vadpcm_rng(rng);
+        }
+    }
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = rng >> 24;
+        rng = vadpcm_rng(rng);
+    }
+    for (int frame = 0; frame < kResampleFrames; frame++) {
+        data[frame * kVADPCMFrameByteSize] &= 0x91;
+    }
+    struct vadpcm_decoder decoder;
+    vadpcm_decoder_prepare(&decoder, kResamplePredictors, kVADPCMEncodeOrder,
+                           codebook);
+    struct vadpcm_vector state = {{0}};
+    vadpcm_decoder_decode_f32(&decoder, &state, kResampleFrames, pcm, data);
+
+    // Steps to test. The step changes between calls, and calls have different
+    // lengths, so the state is carried across calls.
+    static const uint32_t kSteps[] = {0x10000, 0x8000,  0x18000, 0x23456,
+                                      0x0ffff, 0x10001, 0x7fffe, 0x100000};
+    enum {
+        kStepCount = sizeof(kSteps) / sizeof(*kSteps),
+    };
+    static const size_t kCallSizes[] = {1, 7, 64, 3, 100, 25};
+    enum {
+        kCallCount = sizeof(kCallSizes) / sizeof(*kCallSizes),
+    };
+
+    vadpcm_isa saved_isa = vadpcm_get_isa();
+    int failures = 0;
+    for (int isa = kVADPCMISAScalar; vadpcm_isa_name(isa) != NULL; isa++) {
+        if (vadpcm_set_isa(isa) != (vadpcm_isa)isa) {
+            continue;
+        }
+        const char *isa_name = vadpcm_isa_name(isa);
+        for (int step_index = 0; step_index < kStepCount; step_index++) {
+            struct vadpcm_resampler resampler;
+            vadpcm_error err = vadpcm_resampler_init(&resampler, &decoder,
+                                                     kResampleFrames, data);
+            uint64_t pos = 0;
+            size_t call = 0;
+            bool match = true;
+            for (size_t n = 0; err == 0 && match && n < kResampleOutput;) {
+                uint32_t step = kSteps[(step_index + call) % kStepCount];
+                size_t count = kCallSizes[call % kCallCount];
+                if (count > kResampleOutput - n) {
+                    count = kResampleOutput - n;
+                }
+                err = vadpcm_resample(&resampler, step, count, out);
+                for (size_t i = 0; err == 0 && match && i < count; i++) {
+                    double expect = resample_expect(pcm, pos);
+                    // At the original pitch, the output is exact.
+                    double tolerance = (pos & 0xffff) == 0 ? 0.0 : 1e-5;
+                    if (fabs((double)out[i] - expect) > tolerance) {
+                        fprintf(stderr,
+                                "error: test_resample %s step case %d: "
+                                "output does not match, index = %zu, "
+                                "got %f, expected %f\n",
+                                isa_name, step_index, n + i, (double)out[i],
+                                expect);
+                        failures++;
+                        match = false;
+                    }
+                    pos += step;
+                }
+                n += count;
+                call++;
+            }
+            if (err != 0) {
+                fprintf(stderr, "error: test_resample %s: error = %s\n",
+                        isa_name, vadpcm_error_name2(err));
+                failures++;
+            }
+        }
+    }
+    vadpcm_set_isa(saved_isa);
+
+    // A step above the maximum is rejected, without changing the resampler or
+    // writing any output. The maximum step is allowed.
+    struct vadpcm_resampler resampler, saved;
+    vadpcm_resampler_init(&resampler, &decoder, kResampleFrames, data);
+    memcpy(&saved, &resampler, sizeof(saved));
+    out[0] = -2.0f;
+    vadpcm_error err =
+        vadpcm_resample(&resampler, kVADPCMResampleMaxStep + 1, 1, out);
+    if (err != kVADPCMErrInvalidParams || out[0] != -2.0f ||
+        memcmp(&resampler, &saved, sizeof(resampler)) != 0) {
+        fprintf(stderr,
+                "error: test_resample: step above maximum: error = %s\n",
+                vadpcm_error_name2(err));
+        failures++;
+    }
+    err = vadpcm_resample(&resampler, kVADPCMResampleMaxStep, 1, out);
+    if (err != 0) {
+        fprintf(stderr, "error: test_resample: maximum step: error = %s\n",
+                vadpcm_error_name2(err));
+        failures++;
+    }
+    if (failures > 0) {
+        fprintf(stderr, "test_resample failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
@@ -0,0 +1,139 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "tests/test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+enum {
+    kSeekTestFrames = 43,
+    kSeekTestSamples = kSeekTestFrames * kVADPCMFrameSampleCount,
+    kSeekTestPredictors = 4,
+};
+
+// Check that decoding a range gives the same result as decoding the whole
+// stream. Return the number of failures.
+static int check_range(const char *name, const struct vadpcm_decoder *decoder,
+                       const struct vadpcm_seek_table *table,
+                       const uint8_t *data, const int16_t *ref, size_t start,
+                       size_t count) {
+    int16_t out[kSeekTestSamples];
+    vadpcm_error err = vadpcm_decode_range(decoder, table, kSeekTestFrames,
+                                           data, start, count, out);
+    if (err != 0) {
+        fprintf(stderr,
+                "error: test_seek %s: start=%zu count=%zu: error = %s\n",
+                name, start, count, vadpcm_error_name2(err));
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (out[i] != ref[start + i]) {
+            fprintf(stderr,
+                    "error: test_seek %s: start=%zu count=%zu: "
+                    "output does not match, index = %zu\n",
+                    name, start, count, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void test_seek(void) {
+    static uint8_t data[kSeekTestFrames * kVADPCMFrameByteSize];
+    static int16_t ref[kSeekTestSamples];
+    struct vadpcm_vector codebook[kSeekTestPredictors * kVADPCMMaxOrder];
+    struct vadpcm_vector state_buf[kSeekTestFrames];
+    uint32_t rng = 1234;
+    int failures = 0;
+    for (int order = 1; order <= kVADPCMMaxOrder; order++) {
+        // Random codebook and frames.
+        for (int i = 0; i < kSeekTestPredictors * order; i++) {
+            for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+                codebook[i].v[j] = (int)(rng >> 20) - (1 << 11);
+                rng = vadpcm_rng(rng);
+            }
+        }
+        for (int i = 0; i < kSeekTestFrames * kVADPCMFrameByteSize; i++) {
+            data[i] = rng >> 24;
+            rng = vadpcm_rng(rng);
+        }
+        for (int frame = 0; frame < kSeekTestFrames; frame++) {
+            uint8_t *fptr = data + kVADPCMFrameByteSize * frame;
+            fptr[0] = ((fptr[0] >> 4) % 13) << 4 |
+                      (fptr[0] & 15) % kSeekTestPredictors;
+        }
+        struct vadpcm_decoder decoder;
+        vadpcm_decoder_prepare(&decoder, kSeekTestPredictors, order, codebook);
+        struct vadpcm_vector state;
+        memset(&state, 0, sizeof(state));
+        vadpcm_decoder_decode(&decoder, &state, kSeekTestFrames, ref, data);
+
+        // Only the last order elements of the state are used by the decoder,
+        // so the seek table is saved with the others cleared, the same way it
+        // is stored in the file.
+        static const uint32_t kIntervals[] = {1, 5, 16, 64};
+        for (size_t n = 0; n < sizeof(kIntervals) / sizeof(*kIntervals);
+             n++) {
+            struct vadpcm_seek_table table = {
+                .interval = kIntervals[n],
+                .entry_count =
+                    vadpcm_seek_table_size(kSeekTestFrames, kIntervals[n]),
+                .state = state_buf,
+            };
+            vadpcm_error err = vadpcm_seek_table_build(&table, &decoder,
+                                                       kSeekTestFrames, data);
+            if (err != 0) {
+                fprintf(stderr, "error: test_seek: build: error = %s\n",
+                        vadpcm_error_name2(err));
+                failures++;
+                continue;
+            }
+            for (size_t i = 0; i < table.entry_count; i++) {
+                for (int j = 0; j < kVADPCMVectorSampleCount - order; j++) {
+                    table.state[i].v[j] = 0;
+                }
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "order=%d interval=%u", order,
+                     (unsigned)kIntervals[n]);
+            for (size_t start = 0; start <= kSeekTestSamples; start += 7) {
+                size_t remaining = kSeekTestSamples - start;
+                static const size_t kCounts[] = {0, 1, 9, 16, 33, 100};
+                for (size_t k = 0; k < sizeof(kCounts) / sizeof(*kCounts);
+                     k++) {
+                    size_t count = kCounts[k];
+                    if (count > remaining) {
+                        count = remaining;
+                    }
+                    failures += check_range(name, &decoder, &table, data, ref,
+                                            start, count);
+                }
+            }
+            failures += check_range(name, &decoder, &table, data, ref, 0,
+                                    kSeekTestSamples);
+        }
+        failures += check_range("no table", &decoder, NULL, data, ref, 100,
+                                kSeekTestSamples - 200);
+
+        // Out of range.
+        int16_t out[kVADPCMFrameSampleCount];
+        vadpcm_error err = vadpcm_decode_range(
+            &decoder, NULL, kSeekTestFrames, data, kSeekTestSamples - 1, 2,
+            out);
+        if (err != kVADPCMErrInvalidParams) {
+            fprintf(stderr,
+                    "error: test_seek: out of range: error = %s, "
+                    "expected %s\n",
+                    vadpcm_error_name2(err),
+                    vadpcm_error_name2(kVADPCMErrInvalidParams));
+            failures++;
+        }
+    }
+    if (failures > 0) {
+        fprintf(stderr, "test_seek failures: %d\n", failures);
+        test_failure_count++;
+    }
+}
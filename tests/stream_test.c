@@ -0,0 +1,227 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/random.h"
+#include "codec/vadpcm.h"
+#include "tests/test.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+enum {
+    kStreamFrames = 200,
+    kStreamPredictors = 4,
+    // The last frame is partly padding.
+    kStreamSamples = kStreamFrames * kVADPCMFrameSampleCount - 5,
+    // Maximum length of expected output.
+    kStreamMaxOutput = 4 * kStreamSamples,
+};
+
+// Read a stream until it ends or the expected output is exhausted, with
+// reads that do not line up with frames. Return true if the output matches.
+static bool stream_check(const char *name, struct vadpcm_stream *stream,
+                         const int16_t *expect, size_t expect_count,
+                         bool at_end) {
+    static const size_t kReadSizes[] = {1, 7, 441, 16, 0, 1024, 33, 15, 2};
+    enum {
+        kReadCount = sizeof(kReadSizes) / sizeof(*kReadSizes),
+    };
+    static int16_t out[kStreamMaxOutput + 1024];
+    size_t pos = 0;
+    for (int i = 0; pos < expect_count; i++) {
+        size_t count = kReadSizes[i % kReadCount];
+        size_t n;
+        vadpcm_error err = vadpcm_stream_read(stream, count, out + pos, &n);
+        if (err != 0) {
+            fprintf(stderr, "error: test_stream %s: error = %s\n", name,
+                    vadpcm_error_name2(err));
+            return false;
+        }
+        pos += n;
+        if (n < count) {
+            break;
+        }
+    }
+    if (at_end ? pos != expect_count : pos < expect_count) {
+        fprintf(stderr,
+                "error: test_stream %s: read %zu samples, expected %zu\n",
+                name, pos, expect_count);
+        return false;
+    }
+    for (size_t i = 0; i < expect_count; i++) {
+        if (out[i] != expect[i]) {
+            fprintf(stderr,
+                    "error: test_stream %s: output does not match, "
+                    "index = %zu\n",
+                    name, i);
+            return false;
+        }
+    }
+    if (at_end) {
+        // Reading past the end returns nothing.
+        size_t n;
+        vadpcm_stream_read(stream, 10, out, &n);
+        if (n != 0) {
+            fprintf(stderr, "error: test_stream %s: read %zu samples at end\n",
+                    name, n);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Get the state for a loop the same way as vadpcm_enc in libultra: decode
+// frames until the position is past the start of the loop, and keep the last
+// decoded frame.
+static void stream_loop_state(const struct vadpcm_decoder *decoder,
+                              const uint8_t *data,
+                              struct vadpcm_loop *restrict loop) {
+    struct vadpcm_vector state = {{0}};
+    uint32_t position = 0;
+    while (position <= loop->start) {
+        vadpcm_decoder_decode(
+            decoder, &state, 1, loop->state,
+            data + (position / kVADPCMFrameSampleCount) * kVADPCMFrameByteSize);
+        position += kVADPCMFrameSampleCount;
+    }
+}
+
+// Loops to test.
+static const struct {
+    uint32_t start;
+    uint32_t end;
+    uint32_t count;
+} kStreamLoops[] = {
+    {0, kStreamSamples, 1},
+    {160, 960, 2},
+    {37, 1000, 1},
+    {500, 517, 3},
+    {1234, kStreamSamples, 2},
+    {2000, 2900, UINT32_MAX},
+};
+
+void test_stream(void) {
+    struct vadpcm_vector codebook[kStreamPredictors * kVADPCMEncodeOrder];
+    static uint8_t data[kStreamFrames * kVADPCMFrameByteSize];
+    static int16_t pcm[kStreamFrames * kVADPCMFrameSampleCount];
+    static int16_t expect[kStreamMaxOutput];
+    uint32_t rng = 1234;
+    for (int i = 0; i < kStreamPredictors * kVADPCMEncodeOrder; i++) {
+        for (int j = 0; j < kVADPCMVectorSampleCount; j++) {
+            codebook[i].v[j] = (int)(rng >> 21) - (1 << 10);
+            rng = vadpcm_rng(rng);
+        }
+    }
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = rng >> 24;
+        rng = vadpcm_rng(rng);
+    }
+    for (int frame = 0; frame < kStreamFrames; frame++) {
+        data[frame * kVADPCMFrameByteSize] &= 0xf3;
+    }
+    struct vadpcm_decoder decoder;
+    vadpcm_decoder_prepare(&decoder, kStreamPredictors, kVADPCMEncodeOrder,
+                           codebook);
+    struct vadpcm_vector state = {{0}};
+    vadpcm_decoder_decode(&decoder, &state, kStreamFrames, pcm, data);
+
+    int failures = 0;
+    struct vadpcm_stream stream;
+    vadpcm_stream_init(&stream, &decoder, kStreamSamples, data);
+    if (!stream_check("no loop", &stream, pcm, kStreamSamples, true)) {
+        failures++;
+    }
+
+    for (size_t i = 0; i < sizeof(kStreamLoops) / sizeof(*kStreamLoops);
+         i++) {
+        struct vadpcm_loop loop = {
+            .start = kStreamLoops[i].start,
+            .end = kStreamLoops[i].end,
+            .count = kStreamLoops[i].count,
+        };
+        stream_loop_state(&decoder, data, &loop);
+        // Play up to the end of the loop, repeat the loop, then play the rest.
+        size_t n = 0;
+        memcpy(expect, pcm, sizeof(*pcm) * loop.end);
+        n += loop.end;
+        size_t loop_length = loop.end - loop.start;
+        bool forever = loop.count == UINT32_MAX;
+        for (uint32_t j = 0; forever ? n + loop_length <= kStreamMaxOutput
+                                     : j < loop.count;
+             j++) {
+            memcpy(expect + n, pcm + loop.start, sizeof(*pcm) * loop_length);
+            n += loop_length;
+        }
+        if (!forever) {
+            memcpy(expect + n, pcm + loop.end,
+                   sizeof(*pcm) * (kStreamSamples - loop.end));
+            n += kStreamSamples - loop.end;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "loop %zu", i);
+        vadpcm_stream_init(&stream, &decoder, kStreamSamples, data);
+        vadpcm_error err = vadpcm_stream_set_loop(&stream, &loop);
+        if (err != 0) {
+            fprintf(stderr, "error: test_stream %s: set_loop: %s\n", name,
+                    vadpcm_error_name2(err));
+            failures++;
+        } else if (!stream_check(name, &stream, expect, n, !forever)) {
+            failures++;
+        }
+    }
+
+    // After the jump, the rest of the stored frame is played, then decoding
+    // continues from the next frame, using the stored frame as the state. This
+    // uses a stored frame which does not match the audio, so the stream must
+    // not decode the frame which contains the start of the loop.
+    {
+        enum {
+            kStart = 1000 + 5,
+            kEnd = 1200,
+            kFrame = kStart / kVADPCMFrameSampleCount,
+        };
+        struct vadpcm_loop loop = {.start = kStart, .end = kEnd, .count = 1};
+        for (int i = 0; i < kVADPCMFrameSampleCount; i++) {
+            loop.state[i] = (int16_t)(i * 700 - 5000);
+        }
+        size_t n = 0;
+        memcpy(expect, pcm, sizeof(*pcm) * kEnd);
+        n += kEnd;
+        int offset = kStart % kVADPCMFrameSampleCount;
+        memcpy(expect + n, loop.state + offset,
+               sizeof(*pcm) * (kVADPCMFrameSampleCount - offset));
+        n += kVADPCMFrameSampleCount - offset;
+        struct vadpcm_vector lstate;
+        memcpy(lstate.v,
+               loop.state + kVADPCMFrameSampleCount - kVADPCMVectorSampleCount,
+               sizeof(lstate.v));
+        size_t rest = kStreamFrames - kFrame - 1;
+        vadpcm_decoder_decode(&decoder, &lstate, rest, expect + n,
+                              data + (kFrame + 1) * kVADPCMFrameByteSize);
+        n += kEnd - (kFrame + 1) * kVADPCMFrameSampleCount;
+        // The rest of the stream after the loop is decoded from the state at
+        // the end of the last pass, so only check up to the loop end.
+        vadpcm_stream_init(&stream, &decoder, kStreamSamples, data);
+        vadpcm_stream_set_loop(&stream, &loop);
+        if (!stream_check("stored frame", &stream, expect, n, false)) {
+            failures++;
+        }
+    }
+
+    // Invalid loops.
+    struct vadpcm_loop loop = {.start = 100, .end = 100, .count = 1};
+    if (vadpcm_stream_set_loop(&stream, &loop) != kVADPCMErrInvalidParams) {
+        fprintf(stderr, "error: test_stream: empty loop accepted\n");
+        failures++;
+    }
+    loop.end = kStreamSamples + 1;
+    if (vadpcm_stream_set_loop(&stream, &loop) != kVADPCMErrInvalidParams) {
+        fprintf(stderr, "error: test_stream: loop past end accepted\n");
+        failures++;
+    }
+
+    if (failures > 0) {
+        test_failure_count++;
+    }
+}
@@ -87,6 +87,11 @@ static void test_file(const char *name) {
     test_decode(name, vadpcm.codebook.predictor_count, vadpcm.codebook.order,
                 vadpcm.codebook.vector, frame_count, vadpcm.encoded_data,
                 pcm.sample_data);
+    test_decode_threads(name, &vadpcm, pcm.sample_data);
+    test_decode_batch(name, &vadpcm, pcm.sample_data);
+    test_decode_file(name, &vadpcm);
+    test_pcm_writer(name, &pcm);
+    test_player(name, &vadpcm, pcm.sample_data);
     test_reencode(name, vadpcm.codebook.predictor_count, vadpcm.codebook.order,
                   vadpcm.codebook.vector, frame_count, vadpcm.encoded_data);
 
@@ -100,12 +105,29 @@ int main(int argc, char **argv) {
     (void)argv;
 
     test_autocorr();
+    test_autocorr_kernels();
     test_solve();
     test_stability();
     test_extensions();
     test_extended();
     test_wave();
     test_encode_1();
+    test_encode_kernels();
+    test_decode_kernels();
+    test_decode_telemetry();
+    test_validate();
+    test_decode_multi();
+    test_decode_interleaved();
+    test_mix();
+    test_resample();
+    test_seek();
+    test_stream();
+    test_aiff_loops();
+    test_aiff_seek_table();
+    test_ring();
+    test_block_cache();
+    test_alist();
+    test_splice();
     for (int i = 0; kAIFFNames[i] != NULL; i++) {
         test_file(kAIFFNames[i]);
     }
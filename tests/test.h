@@ -8,6 +8,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct audio_pcm;
+struct audio_vadpcm;
+
 extern int test_failure_count;
 
 // Return the name of the error, or "unknown error".
@@ -22,6 +25,72 @@ void test_decode(const char *name, int predictor_count, int order,
                  struct vadpcm_vector *codebook, size_t frame_count,
                  const void *vadpcm, const int16_t *pcm);
 
+// Test that the SIMD decoders produce the same output as the scalar decoder.
+void test_decode_kernels(void);
+
+// Test that the instrumented decoder counts frames and clamped samples.
+void test_decode_telemetry(void);
+
+// Test that validation finds the first invalid frame.
+void test_validate(void);
+
+// Test that decoding multiple streams matches decoding them separately.
+void test_decode_multi(void);
+
+// Test that interleaved decoding matches decoding channels separately.
+void test_decode_interleaved(void);
+
+// Test that mixing voices matches decoding and mixing them separately.
+void test_mix(void);
+
+// Test reading loops from AIFF-C files.
+void test_aiff_loops(void);
+
+// Test reading seek tables from AIFF-C files.
+void test_aiff_seek_table(void);
+
+// Test that resampling matches interpolating the decoded audio.
+void test_resample(void);
+
+// Test that decoding a range with a seek table matches a full decode.
+void test_seek(void);
+
+// Test decoding a stream with reads that do not line up with frames.
+void test_stream(void);
+
+// Test that decoding a file with multiple threads matches the known output.
+void test_decode_threads(const char *name, const struct audio_vadpcm *audio,
+                         const int16_t *pcm);
+
+// Test that decoding a bank of clips with multiple threads matches the known
+// output.
+void test_decode_batch(const char *name, const struct audio_vadpcm *audio,
+                       const int16_t *pcm);
+
+// Test that decoding to a file matches decoding to memory and writing the
+// samples to a file.
+void test_decode_file(const char *name, const struct audio_vadpcm *audio);
+
+// Test that writing PCM audio in pieces with a writer gives a file which reads
+// back as the same audio.
+void test_pcm_writer(const char *name, const struct audio_pcm *pcm);
+
+// Test reading and writing a ring buffer, including wrapping around.
+void test_ring(void);
+
+// Test cache lookups, replacement, invalidation, and concurrent use.
+void test_block_cache(void);
+
+// Test the audio command list interpreter.
+void test_alist(void);
+
+// Test joining ranges of encoded audio, and finding silence.
+void test_splice(void);
+
+// Test that playing a file through the ring buffer matches the known output.
+void test_player(const char *name, const struct audio_vadpcm *audio,
+                 const int16_t *pcm);
+
 // Test that re-encoding the VADPCM doesn't change the decoded audio.
 void test_reencode(const char *name, int predictor_count, int order,
                    struct vadpcm_vector *codebook, size_t frame_count,
@@ -30,9 +99,15 @@ void test_reencode(const char *name, int predictor_count, int order,
 // Test for specific encoding problems.
 void test_encode_1(void);
 
+// Test that the SIMD encoders produce the same output as the scalar encoder.
+void test_encode_kernels(void);
+
 // Autocorrelation test.
 void test_autocorr(void);
 
+// Test that the SIMD autocorrelation matches the scalar code.
+void test_autocorr_kernels(void);
+
 // Predictor solver test.
 void test_solve(void);
 
@@ -8,10 +8,18 @@
 #include "common/util.h"
 #include "vadpcm/commands.h"
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+enum {
+    kMaxThreads = 256,
+
+    // Number of frames to decode at a time when streaming.
+    kStreamFrameCount = 1024,
+};
+
 // clang-format off: let this be wide
 static const char HELP[] =
     "Usage: vadpcm decode [options...] input_file output_file\n"
@@ -20,32 +28,202 @@ static const char HELP[] =
     "\n"
     "Options:\n"
     "  --debug             Print debug messages\n"
+    "  -f, --format fmt    Output format: aiff, aifc, or wav (default: from extension)\n"
+    "  --float             Write 32-bit floating-point samples (WAVE only)\n"
     "  -h, --help          Show this help text\n"
-    "  -q, --quiet         Only print warnings and errors\n";
+    "  -j, --threads n     Number of threads to use (default: number of CPUs)\n"
+    "  -q, --quiet         Only print warnings and errors\n"
+    "  --report            Print clamped samples, and predictor and scaling factor usage\n"
+    "  --stream            Decode and write a block at a time, using less memory\n"
+    "\n"
+    "Decoding uses multiple threads only if the file has a seek table.\n"
+    "If the output file is \"-\", output is streamed to standard output.\n";
 // clang-format on
 
+// Decode the audio one block at a time, writing each block to the output as
+// it is decoded. Memory usage does not depend on the length of the audio.
+static int decode_stream(const struct audio_vadpcm *restrict audio,
+                         const char *output_file, file_format output_format,
+                         bool use_float) {
+    struct vadpcm_decoder decoder;
+    vadpcm_error err = vadpcm_decoder_prepare(
+        &decoder, audio->codebook.predictor_count, audio->codebook.order,
+        audio->codebook.vector);
+    if (err != 0) {
+        LOG_ERROR("invalid codebook: %s", vadpcm_error_name(err));
+        return -1;
+    }
+    struct audio_pcm_writer writer;
+    log_context("write", output_file);
+    int r = audio_pcm_writer_open(&writer, output_file, output_format,
+                                  &audio->meta, use_float);
+    if (r != 0) {
+        return -1;
+    }
+    void *pcm_data = XMALLOC(kStreamFrameCount * kVADPCMFrameSampleCount,
+                             sample_format_size(writer.samples));
+    struct vadpcm_vector state;
+    memset(&state, 0, sizeof(state));
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    for (size_t pos = 0; pos < frame_count;) {
+        size_t n = frame_count - pos;
+        if (n > kStreamFrameCount) {
+            n = kStreamFrameCount;
+        }
+        // Decode directly into the sample format used by the file.
+        const uint8_t *src = audio->encoded_data + pos * kVADPCMFrameByteSize;
+        switch (writer.samples) {
+        case kSampleBigEndian:
+            err = vadpcm_decoder_decode_be(&decoder, &state, n, pcm_data, src);
+            break;
+        case kSampleFloat:
+            err = vadpcm_decoder_decode_f32(&decoder, &state, n, pcm_data, src);
+            break;
+        default:
+            err = vadpcm_decoder_decode_le(&decoder, &state, n, pcm_data, src);
+            break;
+        }
+        if (err != 0) {
+            LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
+            goto error;
+        }
+        r = audio_pcm_writer_write_raw(&writer, pcm_data,
+                                       n * kVADPCMFrameSampleCount);
+        if (r != 0) {
+            goto error;
+        }
+        pos += n;
+    }
+    free(pcm_data);
+    return audio_pcm_writer_close(&writer);
+
+error:
+    free(pcm_data);
+    output_stream_close(&writer.stream);
+    return -1;
+}
+
+// Print a histogram, skipping entries which are zero.
+static void print_histogram(FILE *out, const char *name, const size_t *counts,
+                            size_t total) {
+    fprintf(out, "  %s usage:\n", name);
+    for (int i = 0; i < 16; i++) {
+        if (counts[i] != 0) {
+            fprintf(out, "    %2d: %zu (%.1f%%)\n", i, counts[i],
+                    100.0 * (double)counts[i] / (double)total);
+        }
+    }
+}
+
+// Decode the audio with the instrumented decoder, and print the counters.
+static int decode_report(const struct audio_vadpcm *restrict audio,
+                         const char *input_file, FILE *out) {
+    struct vadpcm_telemetry telemetry;
+    memset(&telemetry, 0, sizeof(telemetry));
+    int16_t *pcm_data =
+        XMALLOC(kStreamFrameCount * kVADPCMFrameSampleCount, sizeof(int16_t));
+    struct vadpcm_vector state;
+    memset(&state, 0, sizeof(state));
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    for (size_t pos = 0; pos < frame_count;) {
+        size_t n = frame_count - pos;
+        if (n > kStreamFrameCount) {
+            n = kStreamFrameCount;
+        }
+        vadpcm_error err = vadpcm_decode_telemetry(
+            audio->codebook.predictor_count, audio->codebook.order,
+            audio->codebook.vector, &state, n, pcm_data,
+            audio->encoded_data + pos * kVADPCMFrameByteSize, &telemetry);
+        if (err != 0) {
+            LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
+            free(pcm_data);
+            return -1;
+        }
+        pos += n;
+    }
+    free(pcm_data);
+
+    size_t sample_count = telemetry.frame_count * kVADPCMFrameSampleCount;
+    fprintf(out, "%s:\n", input_file);
+    fprintf(out, "  frames: %zu\n", telemetry.frame_count);
+    fprintf(out, "  clamped samples: %zu (%.3f%%)\n", telemetry.clamp_count,
+            sample_count == 0 ? 0.0
+                              : 100.0 * (double)telemetry.clamp_count /
+                                    (double)sample_count);
+    print_histogram(out, "predictor", telemetry.predictor_histogram,
+                    telemetry.frame_count);
+    print_histogram(out, "scaling factor", telemetry.scaling_histogram,
+                    telemetry.frame_count);
+    return 0;
+}
+
 int cmd_decode(int argc, char **argv) {
     // Parse command-line.
     enum {
         opt_debug = 1,
+        opt_float,
+        opt_report,
+        opt_stream,
     };
     static const struct option long_options[] = {
         {"debug", no_argument, 0, opt_debug},
+        {"float", no_argument, 0, opt_float},
+        {"format", required_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"quiet", no_argument, 0, 'q'},
+        {"report", no_argument, 0, opt_report},
+        {"stream", no_argument, 0, opt_stream},
+        {"threads", required_argument, 0, 'j'},
         {0, 0, 0, 0},
     };
     int opt, option_index;
+    int thread_count = 0;
+    file_format output_format = kFormatUnknown;
+    bool stream = false;
+    bool use_float = false;
+    bool report = false;
     optind = 2;
-    while ((opt = getopt_long(argc, argv, "h", long_options, &option_index)) !=
-           -1) {
+    while ((opt = getopt_long(argc, argv, "f:hj:q", long_options,
+                              &option_index)) != -1) {
         switch (opt) {
         case opt_debug:
             g_log_level = LEVEL_DEBUG;
             break;
+        case opt_float:
+            use_float = true;
+            break;
+        case opt_report:
+            report = true;
+            break;
+        case opt_stream:
+            stream = true;
+            break;
+        case 'f':
+            output_format = format_for_name(optarg);
+            if (output_format == kFormatUnknown) {
+                LOG_ERROR("unknown format: %s", optarg);
+                return 2;
+            }
+            break;
         case 'h':
             fputs(HELP, stdout);
             return 0;
+        case 'j': {
+            char *end;
+            unsigned long value = strtoul(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0') {
+                LOG_ERROR("invalid value for --threads");
+                return 2;
+            }
+            if (value < 1 || kMaxThreads < value) {
+                LOG_ERROR("thread count must be in the range 1..%d",
+                          kMaxThreads);
+                return 2;
+            }
+            thread_count = value;
+        } break;
         case 'q':
             g_log_level = LEVEL_QUIET;
             break;
@@ -64,11 +242,27 @@ int cmd_decode(int argc, char **argv) {
     const char *input_file = argv[optind];
     const char *output_file = argv[optind + 1];
     file_format input_format = format_for_file(input_file);
-    file_format output_format = format_for_file(output_file);
+    if (strcmp(output_file, "-") == 0) {
+        stream = true;
+    }
+    if (output_format == kFormatUnknown) {
+        output_format = format_for_file(output_file);
+    }
     if (!check_format_vadpcm(input_file, input_format) ||
         !check_format_pcm_output(output_file, output_format)) {
         return 1;
     }
+    if (use_float && output_format != kFormatWAVE) {
+        LOG_ERROR("--float requires WAVE output");
+        return 2;
+    }
+
+    if (thread_count == 0) {
+        thread_count = thread_cpu_count();
+        if (thread_count > kMaxThreads) {
+            thread_count = kMaxThreads;
+        }
+    }
 
     // Read input.
     log_context("read", input_file);
@@ -79,36 +273,34 @@ int cmd_decode(int argc, char **argv) {
     }
     LOG_INFO("sample rate: %f", double_from_extended(&audio.meta.sample_rate));
 
-    // Decode.
-    log_context("decode", input_file);
-    int16_t *pcm_data =
-        XMALLOC(audio.meta.padded_sample_count, sizeof(*pcm_data));
-    struct vadpcm_vector state;
-    memset(&state, 0, sizeof(state));
-    vadpcm_error err =
-        vadpcm_decode(audio.codebook.predictor_count, audio.codebook.order,
-                      audio.codebook.vector, &state,
-                      audio.meta.padded_sample_count / kVADPCMFrameSampleCount,
-                      pcm_data, audio.encoded_data);
-    if (err != 0) {
-        LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
-        return 1;
+    if (report) {
+        // Keep the report out of the audio when writing to standard output.
+        log_context("decode", input_file);
+        FILE *out = strcmp(output_file, "-") == 0 ? stderr : stdout;
+        r = decode_report(&audio, input_file, out);
+        if (r != 0) {
+            audio_vadpcm_destroy(&audio);
+            return 1;
+        }
+    }
+
+    if (stream) {
+        log_context("decode", input_file);
+        r = decode_stream(&audio, output_file, output_format, use_float);
+        audio_vadpcm_destroy(&audio);
+        log_context_clear();
+        return r == 0 ? 0 : 1;
     }
 
-    // Write output.
+    // Decode directly into the output file, in the sample format it uses.
     log_context("write", output_file);
-    r = audio_write_pcm(
-        &(struct audio_pcm){
-            .meta = audio.meta,
-            .sample_data = pcm_data,
-        },
-        output_file, output_format);
+    r = audio_vadpcm_decode_file(&audio, output_file, output_format, use_float,
+                                 thread_count);
+    audio_vadpcm_destroy(&audio);
     if (r != 0) {
         return 1;
     }
 
-    free(pcm_data);
-    audio_vadpcm_destroy(&audio);
     log_context_clear();
     return 0;
 }
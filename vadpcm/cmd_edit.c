@@ -0,0 +1,364 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/vadpcm.h"
+#include "common/audio.h"
+#include "common/format.h"
+#include "common/getopt.h"
+#include "common/util.h"
+#include "vadpcm/commands.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    // Default number of frames to process after each edit point.
+    kDefaultMaxFrames = 64,
+};
+
+// clang-format off: let this be wide
+static const char HELP[] =
+    "Usage: vadpcm edit [options...] -o output_file input_file[@start-end]...\n"
+    "\n"
+    "Cut and join VADPCM-encoded audio files, without decoding and encoding them.\n"
+    "\n"
+    "Options:\n"
+    "  --debug             Print debug messages\n"
+    "  -h, --help          Show this help text\n"
+    "  --max-frames n      Frames to encode again after each edit point (default 64)\n"
+    "  -o, --output file   Output file\n"
+    "  -q, --quiet         Only print warnings and errors\n"
+    "  --seek-interval n   Write a seek table with an entry every n frames\n"
+    "\n"
+    "The inputs are joined in order. Each input can be followed by a range of\n"
+    "samples to use, like \"sound.aifc@1600-3200\". Either end of the range can be\n"
+    "omitted. The start and end must be multiples of 16 samples, which is the size\n"
+    "of a VADPCM frame, except that the last range can end at the end of its file.\n"
+    "All inputs must use the same codebook. Loops are not copied. Seek tables in\n"
+    "the inputs are used to find the decoder state at each end of a range.\n";
+// clang-format on
+
+// An input file and the range of frames to use from it.
+struct edit_input {
+    const char *filename;
+    struct audio_vadpcm audio;
+    size_t start;
+    size_t end;
+    // Number of samples in the range. This is less than the number of samples
+    // in the frames if the range ends at the end of the audio, which is not a
+    // multiple of the frame size.
+    uint32_t sample_count;
+};
+
+// Parse a sample position in a range. An empty string is the default value.
+static bool parse_position(const char *str, size_t length,
+                           uint32_t default_value, uint32_t *value) {
+    if (length == 0) {
+        *value = default_value;
+        return true;
+    }
+    uint32_t result = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (str[i] < '0' || '9' < str[i] ||
+            result > (MAX_INPUT_LENGTH - (str[i] - '0')) / 10) {
+            return false;
+        }
+        result = result * 10 + (uint32_t)(str[i] - '0');
+    }
+    *value = result;
+    return true;
+}
+
+// Read an input file and parse its range.
+static int edit_input_read(struct edit_input *restrict input, char *arg) {
+    char *range = strrchr(arg, '@');
+    if (range != NULL) {
+        *range++ = '\0';
+    }
+    input->filename = arg;
+    log_context("read", arg);
+    if (!check_format_vadpcm(arg, format_for_file(arg))) {
+        return -1;
+    }
+    int r = audio_read_vadpcm(&input->audio, arg);
+    if (r != 0) {
+        return -1;
+    }
+    uint32_t length = input->audio.meta.original_sample_count;
+    uint32_t start = 0, end = length;
+    if (range != NULL) {
+        const char *dash = strchr(range, '-');
+        if (dash == NULL ||
+            !parse_position(range, (size_t)(dash - range), 0, &start) ||
+            !parse_position(dash + 1, strlen(dash + 1), length, &end)) {
+            LOG_ERROR("invalid range: '%s'", range);
+            goto error;
+        }
+        if (start % kVADPCMFrameSampleCount != 0 ||
+            (end % kVADPCMFrameSampleCount != 0 && end != length)) {
+            LOG_ERROR("range must start and end on a multiple of %d samples, "
+                      "or end at the end of the audio",
+                      kVADPCMFrameSampleCount);
+            goto error;
+        }
+        if (start > end || end > length) {
+            LOG_ERROR("range %" PRIu32 "-%" PRIu32
+                      " is outside the audio, which has %" PRIu32 " samples",
+                      start, end, length);
+            goto error;
+        }
+    }
+    input->start = start / kVADPCMFrameSampleCount;
+    input->end = (end + kVADPCMFrameSampleCount - 1) / kVADPCMFrameSampleCount;
+    input->sample_count = end - start;
+    return 0;
+
+error:
+    audio_vadpcm_destroy(&input->audio);
+    return -1;
+}
+
+// Return true if two files use the same codebook.
+static bool codebook_equal(const struct vadpcm_codebook *restrict x,
+                           const struct vadpcm_codebook *restrict y) {
+    return x->order == y->order && x->predictor_count == y->predictor_count &&
+           memcmp(x->vector, y->vector,
+                  sizeof(*x->vector) * x->order * x->predictor_count) == 0;
+}
+
+// Find the decoder state at the start and end of an input's range. The seek
+// table in the file is used, so this decodes at most one seek interval to
+// find each state, or the range itself if that is shorter.
+static vadpcm_error edit_input_state(
+    const struct vadpcm_decoder *restrict decoder,
+    const struct edit_input *restrict input,
+    struct vadpcm_splice_segment *restrict segment) {
+    const struct audio_vadpcm *audio = &input->audio;
+    const struct vadpcm_seek_table *table = &audio->seek_table;
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    vadpcm_error err =
+        vadpcm_seek_state(decoder, table, frame_count, audio->encoded_data,
+                          input->start, &segment->state);
+    if (err != 0) {
+        return err;
+    }
+    if (table->entry_count > 0) {
+        size_t entry = input->end / table->interval;
+        if (entry >= table->entry_count) {
+            entry = table->entry_count - 1;
+        }
+        if (entry * table->interval > input->start) {
+            return vadpcm_seek_state(decoder, table, frame_count,
+                                     audio->encoded_data, input->end,
+                                     &segment->end_state);
+        }
+    }
+    // Otherwise, continue decoding from the start of the range. The range is
+    // treated as its own audio, with a one-entry seek table holding the state
+    // at its start.
+    size_t range_count = input->end - input->start;
+    if (range_count == 0) {
+        segment->end_state = segment->state;
+        return 0;
+    }
+    struct vadpcm_seek_table range_table = {
+        .interval = (uint32_t)range_count,
+        .entry_count = 1,
+        .state = &segment->state,
+    };
+    return vadpcm_seek_state(
+        decoder, &range_table, range_count,
+        audio->encoded_data + input->start * kVADPCMFrameByteSize, range_count,
+        &segment->end_state);
+}
+
+// Join the inputs and write the output. Returns 0 on success.
+static int edit_write(size_t input_count, struct edit_input *restrict inputs,
+                      size_t max_frames, uint32_t seek_interval,
+                      const char *output_file) {
+    const struct audio_vadpcm *first = &inputs[0].audio;
+    const struct vadpcm_codebook *codebook = &first->codebook;
+    if (codebook->order != kVADPCMEncodeOrder) {
+        LOG_ERROR("only predictor order %d is supported", kVADPCMEncodeOrder);
+        return -1;
+    }
+    struct vadpcm_decoder decoder;
+    vadpcm_error err =
+        vadpcm_decoder_prepare(&decoder, codebook->predictor_count,
+                               codebook->order, codebook->vector);
+    if (err != 0) {
+        LOG_ERROR("invalid codebook: %s", vadpcm_error_name(err));
+        return -1;
+    }
+
+    // Find the decoder state at the start and end of each range.
+    struct vadpcm_splice_segment *segments =
+        XMALLOC(input_count, sizeof(*segments));
+    size_t frame_count = 0, sample_count = 0;
+    for (size_t i = 0; i < input_count; i++) {
+        const struct edit_input *input = &inputs[i];
+        const struct audio_vadpcm *audio = &input->audio;
+        log_context("edit", input->filename);
+        // The padding at the end of a file can only go at the end.
+        if (i + 1 < input_count &&
+            input->sample_count % kVADPCMFrameSampleCount != 0) {
+            LOG_ERROR("only the last input can end at the end of audio with "
+                      "a length which is not a multiple of %d samples",
+                      kVADPCMFrameSampleCount);
+            goto error;
+        }
+        if (!codebook_equal(&audio->codebook, codebook)) {
+            LOG_ERROR("codebook does not match the codebook in %s",
+                      inputs[0].filename);
+            goto error;
+        }
+        if (memcmp(&audio->meta.sample_rate, &first->meta.sample_rate,
+                   sizeof(struct extended)) != 0) {
+            LOG_ERROR("sample rate does not match the sample rate in %s",
+                      inputs[0].filename);
+            goto error;
+        }
+        err = edit_input_state(&decoder, input, &segments[i]);
+        if (err != 0) {
+            LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
+            goto error;
+        }
+        segments[i].src =
+            audio->encoded_data + input->start * kVADPCMFrameByteSize;
+        segments[i].frame_count = input->end - input->start;
+        frame_count += segments[i].frame_count;
+        sample_count += input->sample_count;
+    }
+    if (frame_count > MAX_INPUT_LENGTH / kVADPCMFrameSampleCount) {
+        LOG_ERROR("output is too long");
+        goto error;
+    }
+
+    log_context("edit", output_file);
+    uint8_t *vadpcm_data = XMALLOC(frame_count, kVADPCMFrameByteSize);
+    struct vadpcm_vector state;
+    memset(&state, 0, sizeof(state));
+    struct vadpcm_splice_stats stats;
+    err = vadpcm_splice(codebook->predictor_count, codebook->vector,
+                        max_frames, input_count, segments, vadpcm_data, &state,
+                        &stats);
+    free(segments);
+    segments = NULL;
+    if (err != 0) {
+        LOG_ERROR("editing failed: %s", vadpcm_error_name(err));
+        free(vadpcm_data);
+        return -1;
+    }
+    LOG_INFO("frames encoded again: %zu", stats.reencode_count);
+    if (stats.unconverged_count > 0) {
+        LOG_INFO("edit points which did not converge: %zu",
+                 stats.unconverged_count);
+    }
+
+    log_context("write", output_file);
+    struct audio_meta meta = {
+        .original_sample_count = (uint32_t)sample_count,
+        .padded_sample_count =
+            (uint32_t)frame_count * kVADPCMFrameSampleCount,
+        .sample_rate = first->meta.sample_rate,
+    };
+    int r = audio_write_vadpcm(&meta, codebook, vadpcm_data, seek_interval,
+                               output_file);
+    free(vadpcm_data);
+    return r;
+
+error:
+    free(segments);
+    return -1;
+}
+
+int cmd_edit(int argc, char **argv) {
+    enum {
+        opt_debug = 1,
+        opt_max_frames,
+        opt_seek_interval,
+    };
+    static const struct option long_options[] = {
+        {"debug", no_argument, 0, opt_debug},
+        {"help", no_argument, 0, 'h'},
+        {"max-frames", required_argument, 0, opt_max_frames},
+        {"output", required_argument, 0, 'o'},
+        {"quiet", no_argument, 0, 'q'},
+        {"seek-interval", required_argument, 0, opt_seek_interval},
+        {0, 0, 0, 0},
+    };
+    int opt, option_index;
+    const char *output_file = NULL;
+    size_t max_frames = kDefaultMaxFrames;
+    uint32_t seek_interval = 0;
+    optind = 2;
+    while ((opt = getopt_long(argc, argv, "ho:q", long_options,
+                              &option_index)) != -1) {
+        switch (opt) {
+        case opt_debug:
+            g_log_level = LEVEL_DEBUG;
+            break;
+        case opt_max_frames: {
+            char *end;
+            unsigned long value = strtoul(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0') {
+                LOG_ERROR("invalid value for --max-frames");
+                return 2;
+            }
+            max_frames = value;
+        } break;
+        case opt_seek_interval:
+            if (!parse_seek_interval(optarg, &seek_interval)) {
+                return 2;
+            }
+            break;
+        case 'h':
+            fputs(HELP, stdout);
+            return 0;
+        case 'o':
+            output_file = optarg;
+            break;
+        case 'q':
+            g_log_level = LEVEL_QUIET;
+            break;
+        default:
+            return 2;
+        }
+    }
+    if (output_file == NULL) {
+        LOG_ERROR("no output file, use -o to set the output file");
+        return 2;
+    }
+    if (argc - optind < 1) {
+        LOG_ERROR("not enough arguments, expected input files");
+        return 2;
+    }
+    if (!check_format_vadpcm(output_file, format_for_file(output_file))) {
+        return 1;
+    }
+
+    size_t input_count = argc - optind;
+    struct edit_input *inputs = XMALLOC(input_count, sizeof(*inputs));
+    size_t read_count = 0;
+    int r = 0;
+    for (; read_count < input_count; read_count++) {
+        r = edit_input_read(&inputs[read_count], argv[optind + read_count]);
+        if (r != 0) {
+            break;
+        }
+    }
+    if (r == 0) {
+        r = edit_write(input_count, inputs, max_frames, seek_interval,
+                       output_file);
+    }
+    for (size_t i = 0; i < read_count; i++) {
+        audio_vadpcm_destroy(&inputs[i].audio);
+    }
+    free(inputs);
+    log_context_clear();
+    return r == 0 ? 0 : 1;
+}
@@ -2,13 +2,13 @@
 // This file is part of VADPCM. VADPCM is licensed under the terms of the
 // Mozilla Public License, version 2.0. See LICENSE.txt for details.
 #include "codec/vadpcm.h"
-#include "common/aiff.h"
 #include "common/audio.h"
 #include "common/format.h"
 #include "common/getopt.h"
 #include "common/util.h"
 #include "vadpcm/commands.h"
 
+#include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,22 +27,26 @@ static const char HELP[] =
     "  --debug             Print debug messages\n"
     "  -h, --help          Show this help text\n"
     "  -p, --predictors n  Set the number of predictors to use (1..16, default 4)\n"
-    "  -q, --quiet         Only print warnings and errors\n";
+    "  -q, --quiet         Only print warnings and errors\n"
+    "  --seek-interval n   Write a seek table with an entry every n frames\n";
 // clang-format on
 
 int cmd_encode(int argc, char **argv) {
     enum {
         opt_debug = 1,
+        opt_seek_interval,
     };
     static const struct option long_options[] = {
         {"debug", no_argument, 0, opt_debug},
         {"help", no_argument, 0, 'h'},
         {"predictors", required_argument, 0, 'p'},
         {"quiet", no_argument, 0, 'q'},
+        {"seek-interval", required_argument, 0, opt_seek_interval},
         {0, 0, 0, 0},
     };
     int opt, option_index;
     int predictor_count = kDefaultPredictorCount;
+    uint32_t seek_interval = 0;
     optind = 2;
     while ((opt = getopt_long(argc, argv, "hp:q", long_options,
                               &option_index)) != -1) {
@@ -69,6 +73,11 @@ int cmd_encode(int argc, char **argv) {
         case 'q':
             g_log_level = LEVEL_QUIET;
             break;
+        case opt_seek_interval:
+            if (!parse_seek_interval(optarg, &seek_interval)) {
+                return 2;
+            }
+            break;
         default:
             return 2;
         }
@@ -93,6 +102,7 @@ int cmd_encode(int argc, char **argv) {
         LOG_DEBUG("input: %s", input_file);
         LOG_DEBUG("output: %s", output_file);
         LOG_DEBUG("predictor count: %d", predictor_count);
+        LOG_DEBUG("seek interval: %" PRIu32, seek_interval);
     }
 
     // Read input.
@@ -130,28 +140,16 @@ int cmd_encode(int argc, char **argv) {
     LOG_INFO("SNR: %.2f dB", signal_level - error_level);
 
     log_context("write", output_file);
-    struct aiff_data aiff = {
-        .version = kAIFFC,
-        .version_timestamp = kAIFCVersion1,
-        .num_channels = 1,
-        // FIXME: use unpadded value?
-        .num_sample_frames = audio.meta.padded_sample_count,
-        .sample_size = 16,
-        .sample_rate = audio.meta.sample_rate,
-        .codec = kAIFFCodecVADPCM,
-        .audio =
-            {
-                .ptr = vadpcm_data,
-                .size = vadpcm_frame_count * kVADPCMFrameByteSize,
-            },
-        .codebook =
-            {
-                .order = kVADPCMEncodeOrder,
-                .predictor_count = predictor_count,
-                .vector = codebook,
-            },
+    struct audio_meta meta = audio.meta;
+    // FIXME: use unpadded value?
+    meta.original_sample_count = meta.padded_sample_count;
+    struct vadpcm_codebook vadpcm_codebook = {
+        .order = kVADPCMEncodeOrder,
+        .predictor_count = predictor_count,
+        .vector = codebook,
     };
-    r = aiff_write(&aiff, output_file);
+    r = audio_write_vadpcm(&meta, &vadpcm_codebook, vadpcm_data, seek_interval,
+                           output_file);
     if (r != 0) {
         return 1;
     }
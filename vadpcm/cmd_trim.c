@@ -0,0 +1,222 @@
+// Copyright 2026 Dietrich Epp.
+// This file is part of VADPCM. VADPCM is licensed under the terms of the
+// Mozilla Public License, version 2.0. See LICENSE.txt for details.
+#include "codec/vadpcm.h"
+#include "common/audio.h"
+#include "common/format.h"
+#include "common/getopt.h"
+#include "common/util.h"
+#include "vadpcm/commands.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// clang-format off: let this be wide
+static const char HELP[] =
+    "Usage: vadpcm trim [options...] input_file output_file\n"
+    "\n"
+    "Remove silence from the start and end of a VADPCM-encoded audio file, without\n"
+    "decoding and encoding it. Only whole frames of digital silence are removed, so\n"
+    "the rest of the decoded audio is unchanged.\n"
+    "\n"
+    "Options:\n"
+    "  --debug             Print debug messages\n"
+    "  -h, --help          Show this help text\n"
+    "  --inner n           Also remove silence inside the audio, in runs of at least n frames\n"
+    "  -n, --dry-run       Report silence, but do not write the output\n"
+    "  -q, --quiet         Only print warnings and errors\n"
+    "  --seek-interval n   Write a seek table with an entry every n frames\n"
+    "\n"
+    "Loops are not copied.\n";
+// clang-format on
+
+// Remove silent runs from the audio and write the output. Returns 0 on
+// success.
+static int trim_write(const struct audio_vadpcm *restrict audio,
+                      size_t min_inner, bool dry_run, uint32_t seek_interval,
+                      const char *output_file) {
+    const struct vadpcm_codebook *codebook = &audio->codebook;
+    struct vadpcm_decoder decoder;
+    vadpcm_error err =
+        vadpcm_decoder_prepare(&decoder, codebook->predictor_count,
+                               codebook->order, codebook->vector);
+    if (err != 0) {
+        LOG_ERROR("invalid codebook: %s", vadpcm_error_name(err));
+        return -1;
+    }
+    if (audio->loop.end != 0) {
+        LOG_INFO("input has a loop, which will not be copied to the output");
+    }
+    size_t frame_count =
+        audio->meta.padded_sample_count / kVADPCMFrameSampleCount;
+    // Runs are separated by at least one frame.
+    size_t max_runs = frame_count / 2 + 1;
+    struct vadpcm_silence *runs = XMALLOC(max_runs, sizeof(*runs));
+    size_t run_count;
+    err = vadpcm_scan_silence(&decoder, frame_count, audio->encoded_data,
+                              max_runs, runs, &run_count);
+    if (err != 0) {
+        LOG_ERROR("decoding failed: %s", vadpcm_error_name(err));
+        free(runs);
+        return -1;
+    }
+
+    // Choose which runs to remove.
+    size_t leading = 0, trailing = 0, inner_frames = 0, inner_runs = 0;
+    size_t keep = 0;
+    for (size_t i = 0; i < run_count; i++) {
+        const struct vadpcm_silence *run = &runs[i];
+        bool remove;
+        if (run->start == 0) {
+            leading = run->frame_count;
+            remove = true;
+        } else if (run->start + run->frame_count == frame_count) {
+            trailing = run->frame_count;
+            remove = true;
+        } else {
+            inner_frames += run->frame_count;
+            inner_runs++;
+            remove = min_inner > 0 && run->frame_count >= min_inner;
+        }
+        if (remove) {
+            runs[keep++] = *run;
+        }
+    }
+    run_count = keep;
+    LOG_INFO("frames: %zu", frame_count);
+    LOG_INFO("leading silence: %zu frames", leading);
+    LOG_INFO("trailing silence: %zu frames", trailing);
+    LOG_INFO("inner silence: %zu frames, in %zu runs", inner_frames,
+             inner_runs);
+
+    // Copy the frames between the removed runs.
+    uint8_t *vadpcm_data = XMALLOC(frame_count, kVADPCMFrameByteSize);
+    size_t out_frames = 0, pos = 0;
+    for (size_t i = 0; i <= run_count; i++) {
+        size_t end = i < run_count ? runs[i].start : frame_count;
+        memcpy(vadpcm_data + out_frames * kVADPCMFrameByteSize,
+               audio->encoded_data + pos * kVADPCMFrameByteSize,
+               (end - pos) * kVADPCMFrameByteSize);
+        out_frames += end - pos;
+        if (i < run_count) {
+            pos = runs[i].start + runs[i].frame_count;
+        }
+    }
+    free(runs);
+    size_t removed = frame_count - out_frames;
+    LOG_INFO("removed: %zu frames, %zu bytes", removed,
+             removed * kVADPCMFrameByteSize);
+
+    // The padding in the last frame is kept if the last frame is kept.
+    uint32_t sample_count = (uint32_t)out_frames * kVADPCMFrameSampleCount;
+    if (pos != frame_count) {
+        sample_count = audio->meta.original_sample_count -
+                       (uint32_t)removed * kVADPCMFrameSampleCount;
+    }
+    if (dry_run) {
+        free(vadpcm_data);
+        return 0;
+    }
+
+    log_context("write", output_file);
+    struct audio_meta meta = {
+        .original_sample_count = sample_count,
+        .padded_sample_count = (uint32_t)out_frames * kVADPCMFrameSampleCount,
+        .sample_rate = audio->meta.sample_rate,
+    };
+    int r = audio_write_vadpcm(&meta, codebook, vadpcm_data, seek_interval,
+                               output_file);
+    free(vadpcm_data);
+    return r;
+}
+
+int cmd_trim(int argc, char **argv) {
+    enum {
+        opt_debug = 1,
+        opt_inner,
+        opt_seek_interval,
+    };
+    static const struct option long_options[] = {
+        {"debug", no_argument, 0, opt_debug},
+        {"dry-run", no_argument, 0, 'n'},
+        {"help", no_argument, 0, 'h'},
+        {"inner", required_argument, 0, opt_inner},
+        {"quiet", no_argument, 0, 'q'},
+        {"seek-interval", required_argument, 0, opt_seek_interval},
+        {0, 0, 0, 0},
+    };
+    int opt, option_index;
+    size_t min_inner = 0;
+    bool dry_run = false;
+    uint32_t seek_interval = 0;
+    optind = 2;
+    while ((opt = getopt_long(argc, argv, "hnq", long_options,
+                              &option_index)) != -1) {
+        switch (opt) {
+        case opt_debug:
+            g_log_level = LEVEL_DEBUG;
+            break;
+        case opt_inner: {
+            char *end;
+            unsigned long value = strtoul(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0') {
+                LOG_ERROR("invalid value for --inner");
+                return 2;
+            }
+            if (value < 1) {
+                LOG_ERROR("inner run length must be positive");
+                return 2;
+            }
+            min_inner = value;
+        } break;
+        case opt_seek_interval:
+            if (!parse_seek_interval(optarg, &seek_interval)) {
+                return 2;
+            }
+            break;
+        case 'h':
+            fputs(HELP, stdout);
+            return 0;
+        case 'n':
+            dry_run = true;
+            break;
+        case 'q':
+            g_log_level = LEVEL_QUIET;
+            break;
+        default:
+            return 2;
+        }
+    }
+    int arg_count = dry_run ? 1 : 2;
+    const char *args_name =
+        dry_run ? "input file" : "input file and output file";
+    if (argc - optind < arg_count) {
+        LOG_ERROR("not enough arguments, expected %s", args_name);
+        return 2;
+    }
+    if (argc - optind > arg_count) {
+        LOG_ERROR("too many arguments, expected %s", args_name);
+        return 2;
+    }
+    const char *input_file = argv[optind];
+    const char *output_file = dry_run ? NULL : argv[optind + 1];
+    if (!check_format_vadpcm(input_file, format_for_file(input_file)) ||
+        (output_file != NULL &&
+         !check_format_vadpcm(output_file, format_for_file(output_file)))) {
+        return 1;
+    }
+
+    log_context("read", input_file);
+    struct audio_vadpcm audio;
+    int r = audio_read_vadpcm(&audio, input_file);
+    if (r != 0) {
+        return 1;
+    }
+    log_context("trim", input_file);
+    r = trim_write(&audio, min_inner, dry_run, seek_interval, output_file);
+    audio_vadpcm_destroy(&audio);
+    log_context_clear();
+    return r == 0 ? 0 : 1;
+}
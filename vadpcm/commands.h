@@ -4,4 +4,6 @@
 #pragma once
 
 int cmd_decode(int argc, char **argv);
+int cmd_edit(int argc, char **argv);
 int cmd_encode(int argc, char **argv);
+int cmd_trim(int argc, char **argv);
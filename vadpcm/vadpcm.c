@@ -25,8 +25,10 @@ static const char HELP[] =
     "\n"
     "Commands:\n"
     "  decode  Decode a VADPCM-encoded audio file.\n"
+    "  edit    Cut and join VADPCM-encoded audio files.\n"
     "  encode  Encode an audio file using VADPCM.\n"
-    "  help    Show help information.\n";
+    "  help    Show help information.\n"
+    "  trim    Remove silence from a VADPCM-encoded audio file.\n";
 // clang-format on
 
 static void cmd_help(void) {
@@ -72,6 +74,12 @@ int main(int argc, char **argv) {
     if (strcmp(arg, "decode") == 0) {
         return cmd_decode(argc, argv);
     }
+    if (strcmp(arg, "edit") == 0) {
+        return cmd_edit(argc, argv);
+    }
+    if (strcmp(arg, "trim") == 0) {
+        return cmd_trim(argc, argv);
+    }
     if (strcmp(arg, "help") == 0) {
         cmd_help();
         return 0;